@@ -62,6 +62,7 @@ if (CMAKE_PROJECT_NAME STREQUAL Flock)
     if (NOT ARM)
         # It is not possible to turn SSE off on 64-bit MSVC and it appears it is also not able to do so safely on 64-bit GCC
         cmake_dependent_option (FLOCK_SSE "Enable SSE/SSE2 instruction set (32-bit Web and Intel platforms only, including Android on Intel Atom); default to true on Intel and false on Web platform; the effective SSE level could be higher, see also FLOCK_DEPLOYMENT_TARGET and CMAKE_OSX_DEPLOYMENT_TARGET build options" ${HAVE_SSE2} "NOT FLOCK_64BIT" TRUE)
+        cmake_dependent_option (FLOCK_AVX2 "Enable AVX2/FMA instruction set for the SIMD math code paths (Intel platforms only); the target CPU must support AVX2 and FMA3" FALSE "FLOCK_SSE" FALSE)
     endif ()
     cmake_dependent_option (FLOCK_3DNOW "Enable 3DNow! instruction set (Linux platform only); should only be used for older CPU with (legacy) 3DNow! support" ${HAVE_3DNOW} "NOT WIN32 AND NOT APPLE  AND NOT ARM AND NOT FLOCK_SSE" FALSE)
     cmake_dependent_option (FLOCK_MMX "Enable MMX instruction set (32-bit Linux platform only); the MMX is effectively enabled when 3DNow! or SSE is enabled; should only be used for older CPU with MMX support" ${HAVE_MMX} "NOT WIN32 AND NOT APPLE  AND NOT ARM AND NOT FLOCK_64BIT AND NOT FLOCK_SSE AND NOT FLOCK_3DNOW" FALSE)
@@ -106,6 +107,7 @@ option (FLOCK_PACKAGING "Enable resources packaging support, on Web platform def
 option (FLOCK_PROFILING "Enable profiling support" TRUE)
 option (FLOCK_IK "Enable inverse kinematics support" TRUE)
 option (FLOCK_LOGGING "Enable logging support" TRUE)
+option (FLOCK_TESTING "Enable testing support, building the engine tests and registering them with CTest" FALSE)
 
 if (CMAKE_CROSSCOMPILING)
     set (FLOCK_SCP_TO_TARGET "" CACHE STRING "Use scp to transfer executables to target system (non-Android cross-compiling build only), SSH digital key must be setup first for this to work, typical value has a pattern of usr@tgt:remote-loc")
@@ -269,6 +271,11 @@ else ()
                 set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -msse -msse2")
             endif ()
         endif ()
+        if (FLOCK_AVX2)
+            # Do not let the compiler fuse separate multiplies and adds, so that the scalar and SIMD code paths round the same way
+            set (CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -mavx2 -mfma -ffp-contract=off")
+            set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mavx2 -mfma -ffp-contract=off")
+        endif ()
         if (NOT FLOCK_SSE)
             if (FLOCK_64BIT OR CMAKE_CXX_COMPILER_ID STREQUAL Clang)
                 # Clang enables SSE support for i386 ABI by default, so use the '-mno-sse' compiler flag to nullify that and make it consistent with GCC
@@ -145,6 +145,7 @@ static void RegisterSkeleton(asIScriptEngine* engine)
     engine->RegisterObjectProperty("Bone", "Quaternion initialRotation", offsetof(Bone, initialRotation_));
     engine->RegisterObjectProperty("Bone", "Vector3 initialScale", offsetof(Bone, initialScale_));
     engine->RegisterObjectProperty("Bone", "bool animated", offsetof(Bone, animated_));
+    engine->RegisterObjectProperty("Bone", "uint maxAnimationLod", offsetof(Bone, maxAnimationLod_));
     engine->RegisterObjectProperty("Bone", "float radius", offsetof(Bone, radius_));
     engine->RegisterObjectProperty("Bone", "const BoundingBox boundingBox", offsetof(Bone, boundingBox_));
     engine->RegisterObjectMethod("Bone", "void set_node(Node@+)", asFUNCTION(BoneSetNode), asCALL_CDECL_OBJLAST);
@@ -315,6 +316,7 @@ static void RegisterRenderPath(asIScriptEngine* engine)
     engine->RegisterEnumValue("TextureUnit", "TU_DEPTHBUFFER", TU_DEPTHBUFFER);
     engine->RegisterEnumValue("TextureUnit", "TU_LIGHTBUFFER", TU_LIGHTBUFFER);
     engine->RegisterEnumValue("TextureUnit", "TU_ZONE", TU_ZONE);
+    engine->RegisterEnumValue("TextureUnit", "TU_SKINPALETTE", TU_SKINPALETTE);
 #endif
     engine->RegisterEnumValue("TextureUnit", "MAX_MATERIAL_TEXTURE_UNITS", MAX_MATERIAL_TEXTURE_UNITS);
     engine->RegisterEnumValue("TextureUnit", "MAX_TEXTURE_UNITS", MAX_TEXTURE_UNITS);
@@ -486,6 +488,7 @@ static void RegisterTextures(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Texture2D", "bool SetSize(int, int, uint, TextureUsage usage = TEXTURE_STATIC, int multiSample = 1, bool autoResolve = true)", asMETHOD(Texture2D, SetSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("Texture2D", "bool SetData(Image@+, bool useAlpha = false)", asMETHODPR(Texture2D, SetData, (Image*, bool), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod("Texture2D", "RenderSurface@+ get_renderSurface() const", asMETHOD(Texture2D, GetRenderSurface), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Texture2D", "uint get_streamingLevel() const", asMETHOD(Texture2D, GetStreamingLevel), asCALL_THISCALL);
     engine->RegisterObjectMethod("Texture2D", "Image@+ GetImage() const", asFUNCTION(Texture2DGetImage), asCALL_CDECL_OBJLAST);
 
     RegisterTexture<Texture2DArray>(engine, "Texture2DArray");
@@ -1024,17 +1027,17 @@ static void DestructAnimationKeyFrame(AnimationKeyFrame* ptr)
     ptr->~AnimationKeyFrame();
 }
 
-static AnimationKeyFrame* AnimationTrackGetKeyFrame(unsigned index, AnimationTrack* ptr)
+static AnimationKeyFrame AnimationTrackGetKeyFrame(unsigned index, AnimationTrack* ptr)
 {
     if (index >= ptr->GetNumKeyFrames())
     {
         asIScriptContext* context = asGetActiveContext();
         if (context)
             context->SetException("Index out of bounds");
-        return 0;
+        return AnimationKeyFrame();
     }
     else
-        return ptr->GetKeyFrame(index);
+        return ptr->GetDecodedKeyFrame(index);
 }
 
 static void ConstructAnimationTriggerPoint(AnimationTriggerPoint* ptr)
@@ -1079,6 +1082,9 @@ static void RegisterAnimation(asIScriptEngine* engine)
     engine->RegisterGlobalProperty("const uint8 CHANNEL_POSITION", (void*)&CHANNEL_POSITION);
     engine->RegisterGlobalProperty("const uint8 CHANNEL_ROTATION", (void*)&CHANNEL_ROTATION);
     engine->RegisterGlobalProperty("const uint8 CHANNEL_SCALE", (void*)&CHANNEL_SCALE);
+    engine->RegisterGlobalProperty("const float DEFAULT_POSITION_TOLERANCE", (void*)&DEFAULT_POSITION_TOLERANCE);
+    engine->RegisterGlobalProperty("const float DEFAULT_ROTATION_TOLERANCE", (void*)&DEFAULT_ROTATION_TOLERANCE);
+    engine->RegisterGlobalProperty("const float DEFAULT_SCALE_TOLERANCE", (void*)&DEFAULT_SCALE_TOLERANCE);
 
     engine->RegisterObjectType("AnimationKeyFrame", sizeof(AnimationKeyFrame), asOBJ_VALUE | asOBJ_APP_CLASS_C);
     engine->RegisterObjectBehaviour("AnimationKeyFrame", asBEHAVE_CONSTRUCT, "void f()", asFUNCTION(ConstructAnimationKeyFrame), asCALL_CDECL_OBJLAST);
@@ -1096,9 +1102,12 @@ static void RegisterAnimation(asIScriptEngine* engine)
     engine->RegisterObjectMethod("AnimationTrack", "void InsertKeyFrame(uint, const AnimationKeyFrame&in)", asMETHOD(AnimationTrack, InsertKeyFrame), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimationTrack", "void RemoveKeyFrame(uint)", asMETHOD(AnimationTrack, RemoveKeyFrame), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimationTrack", "void RemoveAllKeyFrames()", asMETHOD(AnimationTrack, RemoveAllKeyFrames), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationTrack", "void Compress(float positionTolerance = DEFAULT_POSITION_TOLERANCE, float rotationTolerance = DEFAULT_ROTATION_TOLERANCE, float scaleTolerance = DEFAULT_SCALE_TOLERANCE)", asMETHOD(AnimationTrack, Compress), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationTrack", "void Decompress()", asMETHOD(AnimationTrack, Decompress), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimationTrack", "void set_keyFrames(uint, const AnimationKeyFrame&in)", asMETHOD(AnimationTrack, SetKeyFrame), asCALL_THISCALL);
-    engine->RegisterObjectMethod("AnimationTrack", "const AnimationKeyFrame& get_keyFrames(uint) const", asMETHOD(AnimationTrack, GetKeyFrame), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationTrack", "AnimationKeyFrame get_keyFrames(uint) const", asFUNCTION(AnimationTrackGetKeyFrame), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("AnimationTrack", "uint get_numKeyFrames() const", asMETHOD(AnimationTrack, GetNumKeyFrames), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimationTrack", "bool get_compressed() const", asMETHOD(AnimationTrack, IsCompressed), asCALL_THISCALL);
     engine->RegisterObjectProperty("AnimationTrack", "uint8 channelMask", offsetof(AnimationTrack, channelMask_));
     engine->RegisterObjectProperty("AnimationTrack", "const String name", offsetof(AnimationTrack, name_));
     engine->RegisterObjectProperty("AnimationTrack", "const StringHash nameHash", offsetof(AnimationTrack, nameHash_));
@@ -1119,6 +1128,9 @@ static void RegisterAnimation(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Animation", "void RemoveTrigger(uint)", asMETHOD(Animation, RemoveTrigger), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void RemoveAllTriggers()", asMETHOD(Animation, RemoveAllTriggers), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "Animation@ Clone(const String&in cloneName = String()) const", asFUNCTION(AnimationClone), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("Animation", "void Compress(float positionTolerance = DEFAULT_POSITION_TOLERANCE, float rotationTolerance = DEFAULT_ROTATION_TOLERANCE, float scaleTolerance = DEFAULT_SCALE_TOLERANCE)", asMETHOD(Animation, Compress), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Animation", "void Decompress()", asMETHOD(Animation, Decompress), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Animation", "bool get_compressed() const", asMETHOD(Animation, IsCompressed), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void set_animationName(const String&in) const", asMETHOD(Animation, SetAnimationName), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "const String &get_animationName() const", asMETHOD(Animation, GetAnimationName), asCALL_THISCALL);
     engine->RegisterObjectMethod("Animation", "void set_length(float)", asMETHOD(Animation, SetLength), asCALL_THISCALL);
@@ -1409,6 +1421,14 @@ static void RegisterAnimatedModel(asIScriptEngine* engine)
     engine->RegisterObjectMethod("AnimatedModel", "float get_animationLodBias() const", asMETHOD(AnimatedModel, GetAnimationLodBias), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "void set_updateInvisible(bool)", asMETHOD(AnimatedModel, SetUpdateInvisible), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "bool get_updateInvisible() const", asMETHOD(AnimatedModel, GetUpdateInvisible), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "void set_animationLodScreenSizes(uint, float)", asMETHOD(AnimatedModel, SetAnimationLodScreenSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "float get_animationLodScreenSizes(uint) const", asMETHOD(AnimatedModel, GetAnimationLodScreenSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "void set_animationLodInterpolation(bool)", asMETHOD(AnimatedModel, SetAnimationLodInterpolation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "bool get_animationLodInterpolation() const", asMETHOD(AnimatedModel, GetAnimationLodInterpolation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "void set_skipShadowOnlySkinning(bool)", asMETHOD(AnimatedModel, SetSkipShadowOnlySkinning), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "bool get_skipShadowOnlySkinning() const", asMETHOD(AnimatedModel, GetSkipShadowOnlySkinning), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "uint get_animationLod() const", asMETHOD(AnimatedModel, GetAnimationLod), asCALL_THISCALL);
+    engine->RegisterObjectMethod("AnimatedModel", "float get_animationScreenSize() const", asMETHOD(AnimatedModel, GetAnimationScreenSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "Skeleton@+ get_skeleton()", asMETHOD(AnimatedModel, GetSkeleton), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "uint get_numAnimationStates() const", asMETHOD(AnimatedModel, GetNumAnimationStates), asCALL_THISCALL);
     engine->RegisterObjectMethod("AnimatedModel", "AnimationState@+ get_animationStates(const String&in) const", asMETHODPR(AnimatedModel, GetAnimationState, (const String&) const, AnimationState*), asCALL_THISCALL);
@@ -2010,6 +2030,14 @@ static void RegisterRenderer(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Renderer", "float get_occluderSizeThreshold() const", asMETHOD(Renderer, GetOccluderSizeThreshold), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "void set_threadedOcclusion(bool)", asMETHOD(Renderer, SetThreadedOcclusion), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "bool get_threadedOcclusion() const", asMETHOD(Renderer, GetThreadedOcclusion), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_retainStaticBatches(bool)", asMETHOD(Renderer, SetRetainStaticBatches), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_retainStaticBatches() const", asMETHOD(Renderer, GetRetainStaticBatches), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_skinningPalette(bool)", asMETHOD(Renderer, SetSkinningPalette), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_skinningPalette() const", asMETHOD(Renderer, GetSkinningPalette), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_textureStreaming(bool)", asMETHOD(Renderer, SetTextureStreaming), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "bool get_textureStreaming() const", asMETHOD(Renderer, GetTextureStreaming), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "void set_textureStreamingMinSize(int)", asMETHOD(Renderer, SetTextureStreamingMinSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "int get_textureStreamingMinSize() const", asMETHOD(Renderer, GetTextureStreamingMinSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "uint get_numPrimitives() const", asMETHOD(Renderer, GetNumPrimitives), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "uint get_numBatches() const", asMETHOD(Renderer, GetNumBatches), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "uint get_numViews() const", asMETHOD(Renderer, GetNumViews), asCALL_THISCALL);
@@ -2017,6 +2045,9 @@ static void RegisterRenderer(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Renderer", "uint get_numLights(bool) const", asMETHOD(Renderer, GetNumLights), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "uint get_numShadowMaps(bool) const", asMETHOD(Renderer, GetNumShadowMaps), asCALL_THISCALL);
     engine->RegisterObjectMethod("Renderer", "uint get_numOccluders(bool) const", asMETHOD(Renderer, GetNumOccluders), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "uint get_numAnimationUpdates() const", asMETHOD(Renderer, GetNumAnimationUpdates), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "uint get_numAnimationLodSkips() const", asMETHOD(Renderer, GetNumAnimationLodSkips), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Renderer", "uint get_numSkinningSkips() const", asMETHOD(Renderer, GetNumSkinningSkips), asCALL_THISCALL);
     engine->RegisterGlobalFunction("Renderer@+ get_renderer()", asFUNCTION(GetRenderer), asCALL_CDECL);
 }
 
@@ -2183,6 +2214,8 @@ static void RegisterOctree(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Octree", "Array<Drawable@>@ GetAllDrawables(uint8 drawableFlags = DRAWABLE_ANY, uint viewMask = DEFAULT_VIEWMASK)", asFUNCTION(OctreeGetAllDrawables), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Octree", "const BoundingBox& get_worldBoundingBox() const", asMETHODPR(Octree, GetWorldBoundingBox, () const, const BoundingBox&), asCALL_THISCALL);
     engine->RegisterObjectMethod("Octree", "uint get_numLevels() const", asMETHOD(Octree, GetNumLevels), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Octree", "void set_looseness(float)", asMETHOD(Octree, SetLooseness), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Octree", "float get_looseness() const", asMETHOD(Octree, GetLooseness), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "Octree@+ get_octree() const", asFUNCTION(SceneGetOctree), asCALL_CDECL_OBJLAST);
     engine->RegisterGlobalFunction("Octree@+ get_octree()", asFUNCTION(GetOctree), asCALL_CDECL);
 }
@@ -71,7 +71,10 @@ struct AttributeInfo
         enumNames_(0),
         variantStructureElementNames_(0),
         mode_(AM_DEFAULT),
-        ptr_(0)
+        ptr_(0),
+        quantizeMin_(0.0f),
+        quantizeMax_(0.0f),
+        quantizePrecision_(0.0f)
     {
     }
 
@@ -84,7 +87,10 @@ struct AttributeInfo
         variantStructureElementNames_(0),
         defaultValue_(defaultValue),
         mode_(mode),
-        ptr_(0)
+        ptr_(0),
+        quantizeMin_(0.0f),
+        quantizeMax_(0.0f),
+        quantizePrecision_(0.0f)
     {
     }
 
@@ -97,7 +103,10 @@ struct AttributeInfo
         variantStructureElementNames_(0),
         defaultValue_(defaultValue),
         mode_(mode),
-        ptr_(0)
+        ptr_(0),
+        quantizeMin_(0.0f),
+        quantizeMax_(0.0f),
+        quantizePrecision_(0.0f)
     {
     }
 
@@ -111,7 +120,10 @@ struct AttributeInfo
         accessor_(accessor),
         defaultValue_(defaultValue),
         mode_(mode),
-        ptr_(0)
+        ptr_(0),
+        quantizeMin_(0.0f),
+        quantizeMax_(0.0f),
+        quantizePrecision_(0.0f)
     {
     }
 
@@ -126,7 +138,10 @@ struct AttributeInfo
         accessor_(accessor),
         defaultValue_(defaultValue),
         mode_(mode),
-        ptr_(0)
+        ptr_(0),
+        quantizeMin_(0.0f),
+        quantizeMax_(0.0f),
+        quantizePrecision_(0.0f)
     {
     }
 
@@ -140,7 +155,10 @@ struct AttributeInfo
         accessor_(accessor),
         defaultValue_(defaultValue),
         mode_(mode),
-        ptr_(0)
+        ptr_(0),
+        quantizeMin_(0.0f),
+        quantizeMax_(0.0f),
+        quantizePrecision_(0.0f)
     {
     }
 
@@ -162,6 +180,12 @@ struct AttributeInfo
     unsigned mode_;
     /// Attribute data pointer if elsewhere than in the Serializable.
     void* ptr_;
+    /// Minimum value for quantized network replication.
+    float quantizeMin_;
+    /// Maximum value for quantized network replication.
+    float quantizeMax_;
+    /// Quantization step for network replication. Zero (default) replicates at full precision.
+    float quantizePrecision_;
 };
 
 }
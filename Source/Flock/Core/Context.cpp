@@ -39,6 +39,9 @@
 namespace FlockSDK
 {
 
+/// Maximum number of network quantization steps in an attribute range. A float can not hold more distinct values in a range.
+static const float MAX_QUANTIZATION_STEPS = 16777216.0f;
+
 #ifndef MINI_URHO
 // Keeps track of how many times SDL was initialised so we know when to call SDL_Quit().
 static int sdlInitCounter = 0;
@@ -217,6 +220,37 @@ void Context::UpdateAttributeDefaultValue(StringHash objectType, const char* nam
         info->defaultValue_ = defaultValue;
 }
 
+void Context::SetAttributeQuantization(StringHash objectType, const char* name, float minValue, float maxValue,
+    float precision)
+{
+    // Also rejects NaN ranges, as the comparison fails
+    if (precision > 0.0f && !((maxValue - minValue) / precision <= MAX_QUANTIZATION_STEPS))
+    {
+        FLOCKSDK_LOGERRORF("Quantization range of attribute %s is too large for precision %g", name, precision);
+        return;
+    }
+
+    // The network attributes are copies, so update both
+    HashMap<StringHash, Vector<AttributeInfo>>* maps[] = { &attributes_, &networkAttributes_ };
+    for (auto i = 0u; i < 2; ++i)
+    {
+        HashMap<StringHash, Vector<AttributeInfo>>::Iterator j = maps[i]->Find(objectType);
+        if (j == maps[i]->End())
+            continue;
+
+        for (Vector<AttributeInfo>::Iterator k = j->second_.Begin(); k != j->second_.End(); ++k)
+        {
+            if (!k->name_.Compare(name, true))
+            {
+                k->quantizeMin_ = minValue;
+                k->quantizeMax_ = Max(maxValue, minValue);
+                k->quantizePrecision_ = Max(precision, 0.0f);
+                break;
+            }
+        }
+    }
+}
+
 VariantMap& Context::GetEventDataMap()
 {
     unsigned nestingLevel = eventSenders_.Size();
@@ -94,6 +94,8 @@ public:
     void RemoveAttribute(StringHash objectType, const char* name);
     /// Update object attribute's default value.
     void UpdateAttributeDefaultValue(StringHash objectType, const char* name, const Variant &defaultValue);
+    /// Set quantization range and precision of a float, vector or quaternion attribute for network replication. Zero precision disables quantization. A range of more than 2^24 steps is rejected.
+    void SetAttributeQuantization(StringHash objectType, const char* name, float minValue, float maxValue, float precision);
     /// Return a preallocated map for event data. Used for optimization to avoid constant re-allocation of event data maps.
     VariantMap& GetEventDataMap();
     /// Initialises the specified SDL systems, if not already. Returns true if successful. This call must be matched with ReleaseSDL() when SDL functions are no longer required, even if this call fails.
@@ -123,6 +125,8 @@ public:
     template <class T, class U> void CopyBaseAttributes();
     /// Template version of updating an object attribute's default value.
     template <class T> void UpdateAttributeDefaultValue(const char* name, const Variant &defaultValue);
+    /// Template version of setting an object attribute's network quantization.
+    template <class T> void SetAttributeQuantization(const char* name, float minValue, float maxValue, float precision);
 
     /// Return subsystem by type.
     Object* GetSubsystem(StringHash type) const;
@@ -264,4 +268,9 @@ template <class T> void Context::UpdateAttributeDefaultValue(const char* name, c
     UpdateAttributeDefaultValue(T::GetTypeStatic(), name, defaultValue);
 }
 
+template <class T> void Context::SetAttributeQuantization(const char* name, float minValue, float maxValue, float precision)
+{
+    SetAttributeQuantization(T::GetTypeStatic(), name, minValue, maxValue, precision);
+}
+
 }
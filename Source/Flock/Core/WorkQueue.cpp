@@ -31,6 +31,18 @@
 namespace FlockSDK
 {
 
+/// Maximum number of jobs that can be allocated by one thread before its job ring buffer wraps around, which is also the upper limit of unfinished jobs per thread. Must be a power of two.
+static const unsigned MAX_JOBS_PER_THREAD = 4096;
+
+/// Target number of ranges per thread when splitting a parallel for. Leaves room for load balancing through stealing without making the ranges too fine.
+static const unsigned PARALLEL_FOR_RANGES_PER_THREAD = 4;
+
+/// Thread index used for threads that are neither the main thread nor worker threads.
+static const unsigned EXTERNAL_THREAD_INDEX = M_MAX_UNSIGNED;
+
+/// Index of the calling thread in the work queue. 0 for the main thread, EXTERNAL_THREAD_INDEX for threads not managed by the work queue.
+static thread_local unsigned currentThreadIndex = EXTERNAL_THREAD_INDEX;
+
 /// Worker thread managed by the work queue.
 class WorkerThread : public Thread, public RefCounted
 {
@@ -47,6 +59,7 @@ public:
     {
         // Init FPU state first
         InitFPU();
+        currentThreadIndex = index_;
         owner_->ProcessItems(index_);
     }
 
@@ -60,6 +73,126 @@ private:
     unsigned index_;
 };
 
+/// Per-thread job storage and work-stealing deque. The owner thread pushes and pops at the tail, other threads steal from the head.
+class JobDeque : public RefCounted
+{
+public:
+    /// Construct.
+    JobDeque() :
+        jobs_(new Job[MAX_JOBS_PER_THREAD]),
+        deque_(new Job*[MAX_JOBS_PER_THREAD]),
+        head_(0),
+        tail_(0),
+        allocated_(0)
+    {
+        for (auto i = 0u; i < MAX_JOBS_PER_THREAD; ++i)
+            jobs_[i].unfinished_.store(0);
+    }
+
+    /// Destruct.
+    ~JobDeque()
+    {
+        delete[] jobs_;
+        delete[] deque_;
+    }
+
+    /// Allocate a job from the ring buffer, skipping slots whose jobs have not finished yet. Return null if all slots are in use. Called only by the owner thread.
+    Job* Allocate()
+    {
+        for (auto i = 0u; i < MAX_JOBS_PER_THREAD; ++i)
+        {
+            Job* job = &jobs_[(allocated_++) & (MAX_JOBS_PER_THREAD - 1)];
+            if (job->unfinished_.load() <= 0)
+                return job;
+        }
+
+        return 0;
+    }
+
+    /// Push a job to the tail. Return false if the deque is full. Called only by the owner thread.
+    bool Push(Job* job)
+    {
+        MutexLock lock(mutex_);
+        if (tail_ - head_ >= MAX_JOBS_PER_THREAD)
+            return false;
+
+        deque_[tail_ & (MAX_JOBS_PER_THREAD - 1)] = job;
+        ++tail_;
+        return true;
+    }
+
+    /// Pop the most recently pushed job from the tail. Called only by the owner thread.
+    Job* Pop()
+    {
+        if (IsEmpty())
+            return 0;
+
+        MutexLock lock(mutex_);
+        if (head_ == tail_)
+            return 0;
+
+        --tail_;
+        return deque_[tail_ & (MAX_JOBS_PER_THREAD - 1)];
+    }
+
+    /// Steal the oldest job from the head. Called by other threads.
+    Job* Steal()
+    {
+        if (IsEmpty())
+            return 0;
+
+        MutexLock lock(mutex_);
+        if (head_ == tail_)
+            return 0;
+
+        Job* job = deque_[head_ & (MAX_JOBS_PER_THREAD - 1)];
+        ++head_;
+        return job;
+    }
+
+    /// Return whether the deque is empty. Not synchronized, used only as a hint to avoid locking.
+    bool IsEmpty() const { return head_ == tail_; }
+
+private:
+    /// Job ring buffer.
+    Job* jobs_;
+    /// Deque of submitted jobs.
+    Job** deque_;
+    /// Deque mutex.
+    Mutex mutex_;
+    /// Head (steal) position.
+    volatile unsigned head_;
+    /// Tail (push/pop) position.
+    volatile unsigned tail_;
+    /// Number of jobs allocated so far.
+    unsigned allocated_;
+};
+
+/// Execute a parallel for range job. Split off the upper half of the range as a child job until the range is small enough, so that idle threads can steal the halves.
+static void ParallelForWork(Job* job, unsigned threadIndex)
+{
+    ParallelForData* parallelFor = static_cast<ParallelForData*>(job->aux_);
+    size_t start = reinterpret_cast<size_t>(job->start_);
+    size_t end = reinterpret_cast<size_t>(job->end_);
+
+    while (end - start > parallelFor->grainSize_)
+    {
+        size_t middle = start + (end - start) / 2;
+        parallelFor->queue_->Fork(job, ParallelForWork, reinterpret_cast<void*>(middle), reinterpret_cast<void*>(end), parallelFor);
+        end = middle;
+    }
+
+    parallelFor->function_((unsigned)start, (unsigned)end, threadIndex, parallelFor->data_);
+}
+
+/// Execute a work item scheduled as a job.
+static void ExecuteWorkItem(Job* job, unsigned threadIndex)
+{
+    WorkItem* item = static_cast<WorkItem*>(job->aux_);
+    item->workFunction_(item, threadIndex);
+    item->completed_ = true;
+}
+
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
     shutDown_(false),
@@ -70,6 +203,11 @@ WorkQueue::WorkQueue(Context* context) :
     lastSize_(0),
     maxNonThreadedWorkMs_(5)
 {
+    // The work queue is created in the main thread, which always has a job deque, even without worker threads
+    currentThreadIndex = 0;
+    jobDeques_.Push(SharedPtr<JobDeque>(new JobDeque()));
+    externalJobs_ = new JobDeque();
+
     SubscribeToEvent(E_BEGINFRAME, FLOCKSDK_HANDLER(WorkQueue, HandleBeginFrame));
 }
 
@@ -93,6 +231,10 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     // Start threads in paused mode
     Pause();
 
+    // Create all deques before starting any thread, as the threads will immediately start stealing
+    for (auto i = 0u; i < numThreads; ++i)
+        jobDeques_.Push(SharedPtr<JobDeque>(new JobDeque()));
+
     for (auto i = 0u; i < numThreads; ++i)
     {
         SharedPtr<WorkerThread> thread(new WorkerThread(this, i + 1));
@@ -134,36 +276,43 @@ void WorkQueue::AddWorkItem(SharedPtr<WorkItem> item)
     workItems_.Push(item);
     item->completed_ = false;
 
-    // Make sure worker threads' list is safe to modify
-    if (threads_.Size() && !paused_)
-        queueMutex_.Acquire();
+    // Maximum priority items are the per-frame work of the engine subsystems. Schedule them as jobs so that the
+    // worker threads can steal them without contending for the shared queue
+    if (item->priority_ == M_MAX_UNSIGNED)
+    {
+        Job* job = CreateJob(ExecuteWorkItem);
+        job->aux_ = item.Get();
+        RunJob(job);
+        return;
+    }
 
-    // Find position for new item
-    if (queue_.Empty())
-        queue_.Push(item);
-    else
     {
-        bool inserted = false;
+        MutexLock lock(queueMutex_);
 
-        for (List<WorkItem*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
+        // Find position for new item
+        if (queue_.Empty())
+            queue_.Push(item);
+        else
         {
-            if ((*i)->priority_ <= item->priority_)
+            bool inserted = false;
+
+            for (List<WorkItem*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
             {
-                queue_.Insert(i, item);
-                inserted = true;
-                break;
+                if ((*i)->priority_ <= item->priority_)
+                {
+                    queue_.Insert(i, item);
+                    inserted = true;
+                    break;
+                }
             }
-        }
 
-        if (!inserted)
-            queue_.Push(item);
+            if (!inserted)
+                queue_.Push(item);
+        }
     }
 
     if (threads_.Size())
-    {
-        queueMutex_.Release();
-        paused_ = false;
-    }
+        Resume();
 }
 
 bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
@@ -220,7 +369,7 @@ void WorkQueue::Pause()
     {
         pausing_ = true;
 
-        queueMutex_.Acquire();
+        pauseMutex_.Acquire();
         paused_ = true;
 
         pausing_ = false;
@@ -231,60 +380,187 @@ void WorkQueue::Resume()
 {
     if (paused_)
     {
-        queueMutex_.Release();
         paused_ = false;
+        pauseMutex_.Release();
     }
 }
 
-
-void WorkQueue::Complete(unsigned priority)
+Job* WorkQueue::CreateJob(JobFunction function, Job* parent)
 {
-    completing_ = true;
+    unsigned threadIndex = currentThreadIndex;
+    Job* job;
 
-    if (threads_.Size())
+    if (threadIndex == EXTERNAL_THREAD_INDEX)
     {
-        Resume();
-
-        // Take work items also in the main thread until queue empty or no high-priority items anymore
-        while (!queue_.Empty())
+        // Threads not managed by the work queue share one ring buffer
+        for (;;)
         {
-            queueMutex_.Acquire();
-            if (!queue_.Empty() && queue_.Front()->priority_ >= priority)
             {
-                WorkItem* item = queue_.Front();
-                queue_.PopFront();
-                queueMutex_.Release();
-                item->workFunction_(item, 0);
-                item->completed_ = true;
+                MutexLock lock(externalJobsMutex_);
+                job = externalJobs_->Allocate();
             }
-            else
-            {
-                queueMutex_.Release();
+            if (job)
                 break;
-            }
+            Time::Sleep(0);
         }
-
-        // Wait for threaded work to complete
-        while (!IsCompleted(priority))
+    }
+    else
+    {
+        // If all jobs of the ring buffer are still unfinished, help executing them until a slot frees up
+        while (!(job = jobDeques_[threadIndex]->Allocate()))
         {
+            Job* pending = GetJob(threadIndex);
+            if (pending)
+                ExecuteJob(pending, threadIndex);
+            else
+                Time::Sleep(0);
         }
+    }
 
-        // If no work at all remaining, pause worker threads by leaving the mutex locked
-        if (queue_.Empty())
-            Pause();
+    job->function_ = function;
+    job->start_ = 0;
+    job->end_ = 0;
+    job->aux_ = 0;
+    job->parent_ = parent;
+    job->unfinished_.store(1);
+
+    if (parent)
+        parent->unfinished_.fetch_add(1);
+
+    return job;
+}
+
+void WorkQueue::RunJob(Job* job)
+{
+    unsigned threadIndex = currentThreadIndex;
+
+    // Threads not managed by the work queue do not own a deque, so their jobs are executed immediately. They use the
+    // thread index of the main thread, which is safe as the job and its children all run in the calling thread
+    if (threadIndex == EXTERNAL_THREAD_INDEX)
+    {
+        ExecuteJob(job, 0);
+        return;
     }
-    else
+
+    // If the deque is full, execute the job immediately instead
+    if (!jobDeques_[threadIndex]->Push(job))
+    {
+        ExecuteJob(job, threadIndex);
+        return;
+    }
+
+    // Only the main thread may pause and resume the worker threads
+    if (!threadIndex && threads_.Size())
+        Resume();
+}
+
+void WorkQueue::WaitForJob(Job* job)
+{
+    unsigned threadIndex = currentThreadIndex;
+
+    // Jobs of threads not managed by the work queue have already been executed by RunJob()
+    if (threadIndex == EXTERNAL_THREAD_INDEX)
     {
-        // No worker threads: ensure all high-priority items are completed in the main thread
-        while (!queue_.Empty() && queue_.Front()->priority_ >= priority)
+        assert(IsJobFinished(job));
+        return;
+    }
+
+    if (!threadIndex && threads_.Size())
+        Resume();
+
+    // Help with other jobs while waiting, so that a waiting job can not deadlock on its own children
+    while (!IsJobFinished(job))
+    {
+        Job* next = GetJob(threadIndex);
+        if (next)
+            ExecuteJob(next, threadIndex);
+    }
+
+    if (!threadIndex && threads_.Size() && !completing_ && IsIdle())
+        Pause();
+}
+
+Job* WorkQueue::Fork(Job* parent, JobFunction function, void* start, void* end, void* aux)
+{
+    Job* job = CreateJob(function, parent);
+    job->start_ = start;
+    job->end_ = end;
+    job->aux_ = aux;
+    RunJob(job);
+    return job;
+}
+
+void WorkQueue::Join(Job* parent)
+{
+    RunJob(parent);
+    WaitForJob(parent);
+}
+
+void WorkQueue::ParallelFor(unsigned count, RangeFunction function, void* data, unsigned minGrainSize)
+{
+    unsigned grainSize = PrepareParallelFor(count, function, data, minGrainSize);
+    if (!grainSize)
+        return;
+
+    ParallelForData parallelFor;
+    parallelFor.queue_ = this;
+    parallelFor.function_ = function;
+    parallelFor.data_ = data;
+    parallelFor.grainSize_ = grainSize;
+
+    Job* job = CreateJob(ParallelForWork);
+    job->start_ = 0;
+    job->end_ = reinterpret_cast<void*>(static_cast<size_t>(count));
+    job->aux_ = &parallelFor;
+    Join(job);
+}
+
+void WorkQueue::ParallelFor(Job* parent, ParallelForData& parallelFor, unsigned count, RangeFunction function, void* data,
+    unsigned minGrainSize)
+{
+    unsigned grainSize = PrepareParallelFor(count, function, data, minGrainSize);
+    if (!grainSize)
+        return;
+
+    parallelFor.queue_ = this;
+    parallelFor.function_ = function;
+    parallelFor.data_ = data;
+    parallelFor.grainSize_ = grainSize;
+
+    Fork(parent, ParallelForWork, 0, reinterpret_cast<void*>(static_cast<size_t>(count)), &parallelFor);
+}
+
+void WorkQueue::Complete(unsigned priority)
+{
+    completing_ = true;
+
+    if (threads_.Size())
+        Resume();
+
+    // Take jobs and work items also in the main thread until all high-priority work is done
+    while (!IsCompleted(priority))
+    {
+        Job* job = GetJob(0);
+        if (job)
+        {
+            ExecuteJob(job, 0);
+            continue;
+        }
+
+        WorkItem* item = GetQueuedItem(priority);
+        if (item)
         {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
             item->workFunction_(item, 0);
             item->completed_ = true;
         }
+        else if (threads_.Empty())
+            break;
     }
 
+    // If no work at all remaining, pause worker threads by leaving the mutex locked
+    if (threads_.Size() && IsIdle())
+        Pause();
+
     PurgeCompleted(priority);
     completing_ = false;
 }
@@ -302,37 +578,117 @@ bool WorkQueue::IsCompleted(unsigned priority) const
 
 void WorkQueue::ProcessItems(unsigned threadIndex)
 {
-    bool wasActive = false;
-
     for (;;)
     {
         if (shutDown_)
             return;
 
-        if (pausing_ && !wasActive)
-            Time::Sleep(0);
-        else
+        Job* job = GetJob(threadIndex);
+        if (job)
         {
-            queueMutex_.Acquire();
-            if (!queue_.Empty())
-            {
-                wasActive = true;
-
-                WorkItem* item = queue_.Front();
-                queue_.PopFront();
-                queueMutex_.Release();
-                item->workFunction_(item, threadIndex);
-                item->completed_ = true;
-            }
-            else
-            {
-                wasActive = false;
+            ExecuteJob(job, threadIndex);
+            continue;
+        }
 
-                queueMutex_.Release();
-                Time::Sleep(0);
-            }
+        WorkItem* item = GetQueuedItem(0);
+        if (item)
+        {
+            item->workFunction_(item, threadIndex);
+            item->completed_ = true;
         }
+        else if (paused_ || pausing_)
+        {
+            // Block until the main thread resumes the workers
+            pauseMutex_.Acquire();
+            pauseMutex_.Release();
+        }
+        else
+            Time::Sleep(0);
+    }
+}
+
+Job* WorkQueue::GetJob(unsigned threadIndex)
+{
+    Job* job = jobDeques_[threadIndex]->Pop();
+    if (job)
+        return job;
+
+    // Own deque is empty, try to steal from the other threads, starting from the next one
+    unsigned numDeques = jobDeques_.Size();
+    for (auto i = 1u; i < numDeques; ++i)
+    {
+        job = jobDeques_[(threadIndex + i) % numDeques]->Steal();
+        if (job)
+            return job;
+    }
+
+    return 0;
+}
+
+WorkItem* WorkQueue::GetQueuedItem(unsigned priority)
+{
+    if (queue_.Empty())
+        return 0;
+
+    MutexLock lock(queueMutex_);
+    if (queue_.Empty() || queue_.Front()->priority_ < priority)
+        return 0;
+
+    WorkItem* item = queue_.Front();
+    queue_.PopFront();
+    return item;
+}
+
+void WorkQueue::ExecuteJob(Job* job, unsigned threadIndex)
+{
+    if (job->function_)
+        job->function_(job, threadIndex);
+
+    FinishJob(job);
+}
+
+unsigned WorkQueue::PrepareParallelFor(unsigned count, RangeFunction function, void* data, unsigned minGrainSize)
+{
+    if (!count)
+        return 0;
+
+    // Aim for a few ranges per thread, but never go below the minimum grain size
+    unsigned numRanges = (threads_.Size() + 1) * PARALLEL_FOR_RANGES_PER_THREAD;
+    unsigned grainSize = Max(Max(count / numRanges, minGrainSize), 1U);
+
+    // Run small ranges directly in the calling thread, as splitting would cost more than it saves. Threads not managed
+    // by the work queue also run the whole range themselves
+    unsigned threadIndex = currentThreadIndex;
+    if (threads_.Empty() || count <= grainSize || threadIndex == EXTERNAL_THREAD_INDEX)
+    {
+        function(0, count, threadIndex == EXTERNAL_THREAD_INDEX ? 0 : threadIndex, data);
+        return 0;
     }
+
+    return grainSize;
+}
+
+void WorkQueue::FinishJob(Job* job)
+{
+    // Read the parent before decrementing, as a finished job's slot may be reused by its owner thread at any time
+    while (job)
+    {
+        Job* parent = job->parent_;
+        if (job->unfinished_.fetch_sub(1) != 1)
+            break;
+        job = parent;
+    }
+}
+
+bool WorkQueue::IsIdle() const
+{
+    for (auto i = 0u; i < jobDeques_.Size(); ++i)
+    {
+        if (!jobDeques_[i]->IsEmpty())
+            return false;
+    }
+
+    return queue_.Empty();
 }
 
 void WorkQueue::PurgeCompleted(unsigned priority)
@@ -396,13 +752,16 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
 
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
-    // If no worker threads, complete low-priority work here
-    if (threads_.Empty() && !queue_.Empty())
+    // If no worker threads, complete leftover jobs and low-priority work here
+    if (threads_.Empty() && !IsIdle())
     {
         FLOCKSDK_PROFILE(CompleteWorkNonthreaded);
 
         HiresTimer timer;
 
+        while (Job* job = GetJob(0))
+            ExecuteJob(job, 0);
+
         while (!queue_.Empty() && timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000)
         {
             WorkItem* item = queue_.Front();
@@ -26,6 +26,8 @@
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
+#include <atomic>
+
 namespace FlockSDK
 {
 
@@ -35,7 +37,64 @@ FLOCKSDK_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
     FLOCKSDK_PARAM(P_ITEM, Item);                        // WorkItem ptr
 }
 
+class JobDeque;
 class WorkerThread;
+class WorkQueue;
+struct Job;
+
+/// Job function. Called with the job and thread index (0 = main thread) as parameters.
+typedef void (* JobFunction)(Job*, unsigned);
+
+/// Lightweight job for the work-stealing scheduler. Jobs are allocated from a per-thread ring buffer by WorkQueue::CreateJob() and must not be kept around after they have finished.
+struct Job
+{
+    /// Work function. May be null for an empty job that only serves as a join point for its children.
+    JobFunction function_;
+    /// Data start pointer.
+    void* start_;
+    /// Data end pointer.
+    void* end_;
+    /// Auxiliary data pointer.
+    void* aux_;
+    /// Parent job, or null. The parent is not finished until all its children have finished.
+    Job* parent_;
+    /// Number of unfinished jobs: this job itself plus all of its unfinished children.
+    std::atomic<int> unfinished_;
+};
+
+/// Parallel range function. Called with the element range [start, end), the thread index (0 = main thread) and user data.
+typedef void (* RangeFunction)(unsigned, unsigned, unsigned, void*);
+
+/// Parallel for bookkeeping, shared by all the range jobs of one WorkQueue::ParallelFor() call. When forking under a caller-supplied parent job, it must stay alive until the parent has been joined.
+struct ParallelForData
+{
+    /// Work queue.
+    WorkQueue* queue_;
+    /// Range function.
+    RangeFunction function_;
+    /// User data.
+    void* data_;
+    /// Range size below which ranges are no longer split.
+    unsigned grainSize_;
+};
+
+/// Parallel reduce bookkeeping. Routes each range to the accumulator of the thread executing it.
+template <class T> struct ParallelReduceData
+{
+    /// Reduce function. Called with the element range [start, end), the calling thread's accumulator and user data.
+    void (* function_)(unsigned, unsigned, T&, void*);
+    /// User data.
+    void* data_;
+    /// Per-thread accumulators.
+    T* accumulators_;
+};
+
+/// Execute a parallel reduce range into the accumulator of the calling thread.
+template <class T> void ParallelReduceRange(unsigned start, unsigned end, unsigned threadIndex, void* data)
+{
+    ParallelReduceData<T>* reduce = static_cast<ParallelReduceData<T>*>(data);
+    reduce->function_(start, end, reduce->accumulators_[threadIndex], reduce->data_);
+}
 
 /// Work queue item.
 struct WorkItem : public RefCounted
@@ -60,7 +119,7 @@ public:
     void* end_;
     /// Auxiliary data pointer.
     void* aux_;
-    /// Priority. Higher value = will be completed first.
+    /// Priority. Higher value = will be completed first. Items with the maximum priority are scheduled as jobs on the work-stealing deques, others go through a shared prioritized queue.
     unsigned priority_;
     /// Whether to send event on completion.
     bool sendEvent_;
@@ -71,7 +130,7 @@ private:
     bool pooled_;
 };
 
-/// Work queue subsystem for multithreading.
+/// Work queue subsystem for multithreading. Each thread owns a job deque; idle threads steal jobs from the other threads' deques.
 class FLOCKSDK_API WorkQueue : public Object
 {
     FLOCKSDK_OBJECT(WorkQueue, Object);
@@ -90,7 +149,7 @@ public:
     SharedPtr<WorkItem> GetFreeItem();
     /// Add a work item and resume worker threads.
     void AddWorkItem(SharedPtr<WorkItem> item);
-    /// Remove a work item before it has started executing. Return true if successfully removed.
+    /// Remove a work item before it has started executing. Return true if successfully removed. Maximum priority items are handed to the job deques immediately and can not be removed.
     bool RemoveWorkItem(SharedPtr<WorkItem> item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
     unsigned RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items);
@@ -101,6 +160,32 @@ public:
     /// Finish all queued work which has at least the specified priority. Main thread will also execute priority work. Pause worker threads if no more work remains.
     void Complete(unsigned priority);
 
+    /// Create a job, optionally as a child of a parent job. The job is not executed until it is passed to RunJob().
+    Job* CreateJob(JobFunction function, Job* parent = 0);
+    /// Submit a job to the calling thread's deque. Other threads may steal it. Jobs submitted from threads not managed by the work queue are executed immediately.
+    void RunJob(Job* job);
+    /// Wait until a job and all its children have finished, executing other jobs while waiting.
+    void WaitForJob(Job* job);
+    /// Fork: create a child job of the parent, fill its data and submit it immediately. Return the child.
+    Job* Fork(Job* parent, JobFunction function, void* start = 0, void* end = 0, void* aux = 0);
+    /// Join: submit the parent job and wait until it and all its forked children have finished.
+    void Join(Job* parent);
+    /// Execute a function over the element range [0, count) in parallel and wait for it to finish. The range is split adaptively based on the number of threads, but never into ranges smaller than the minimum grain size.
+    void ParallelFor(unsigned count, RangeFunction function, void* data, unsigned minGrainSize = 1);
+    /// Execute a function over the element range [0, count) in parallel without waiting. The range jobs are forked as children of the parent job, so the caller can do other work before joining the parent. Small ranges are executed immediately in the calling thread instead.
+    void ParallelFor(Job* parent, ParallelForData& parallelFor, unsigned count, RangeFunction function, void* data, unsigned minGrainSize = 1);
+    /// Execute a reduction over the element range [0, count) in parallel and wait for it to finish. The accumulators vector is resized to one entry per thread and each range is accumulated into the entry of the thread executing it. The caller is responsible for resetting the accumulators beforehand and combining them afterward.
+    template <class T> void ParallelReduce(unsigned count, void (* function)(unsigned, unsigned, T&, void*), void* data, Vector<T>& accumulators, unsigned minGrainSize = 1)
+    {
+        accumulators.Resize(GetNumThreads() + 1);
+
+        ParallelReduceData<T> reduce;
+        reduce.function_ = function;
+        reduce.data_ = data;
+        reduce.accumulators_ = &accumulators[0];
+        ParallelFor(count, ParallelReduceRange<T>, &reduce, minGrainSize);
+    }
+
     /// Set the pool telerance before it starts deleting pool items.
     void SetTolerance(int tolerance) { tolerance_ = tolerance; }
 
@@ -110,6 +195,8 @@ public:
     /// Return number of worker threads.
     unsigned GetNumThreads() const { return threads_.Size(); }
 
+    /// Return whether a job and all its children have finished.
+    bool IsJobFinished(const Job* job) const { return job->unfinished_.load() <= 0; }
     /// Return whether all work with at least the specified priority is finished.
     bool IsCompleted(unsigned priority) const;
     /// Return whether the queue is currently completing work in the main thread.
@@ -122,8 +209,20 @@ public:
     int GetNonThreadedWorkMs() const { return maxNonThreadedWorkMs_; }
 
 private:
-    /// Process work items until shut down. Called by the worker threads.
+    /// Process jobs and work items until shut down. Called by the worker threads.
     void ProcessItems(unsigned threadIndex);
+    /// Pop a job from the thread's own deque, or steal one from another thread. Return null if no jobs are available.
+    Job* GetJob(unsigned threadIndex);
+    /// Take the highest priority item from the shared queue if it has at least the specified priority. Return null if none.
+    WorkItem* GetQueuedItem(unsigned priority);
+    /// Execute a job and mark it finished.
+    void ExecuteJob(Job* job, unsigned threadIndex);
+    /// Return the parallel for grain size for a range. Execute the whole range in the calling thread and return zero if it should not be split.
+    unsigned PrepareParallelFor(unsigned count, RangeFunction function, void* data, unsigned minGrainSize);
+    /// Decrement the unfinished count of a job, and propagate to its parent when it reaches zero.
+    void FinishJob(Job* job);
+    /// Return whether all job deques and the shared queue are empty.
+    bool IsIdle() const;
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(unsigned priority);
     /// Purge the pool to reduce allocation where its unneeded.
@@ -139,16 +238,24 @@ private:
     List<SharedPtr<WorkItem> > poolItems_;
     /// Work item collection. Accessed only by the main thread.
     List<SharedPtr<WorkItem> > workItems_;
-    /// Work item prioritized queue for worker threads. Pointers are guaranteed to be valid (point to workItems.)
+    /// Per-thread job deques. Index 0 is the main thread.
+    Vector<SharedPtr<JobDeque> > jobDeques_;
+    /// Job storage shared by the threads not managed by the work queue. Their jobs are executed immediately in the calling thread.
+    SharedPtr<JobDeque> externalJobs_;
+    /// Mutex for allocating jobs from the shared job storage.
+    Mutex externalJobsMutex_;
+    /// Work item prioritized queue for items below maximum priority. Pointers are guaranteed to be valid (point to workItems.)
     List<WorkItem*> queue_;
-    /// Worker queue mutex.
+    /// Prioritized queue mutex.
     Mutex queueMutex_;
+    /// Pause mutex. Held by the main thread while the worker threads are paused.
+    Mutex pauseMutex_;
     /// Shutting down flag.
     volatile bool shutDown_;
-    /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
+    /// Pausing flag. Indicates the worker threads should not contend for the pause mutex.
     volatile bool pausing_;
-    /// Paused flag. Indicates the queue mutex being locked to prevent worker threads using up CPU time.
-    bool paused_;
+    /// Paused flag. Indicates the pause mutex being locked to prevent idle worker threads using up CPU time.
+    volatile bool paused_;
     /// Completing work in the main thread flag.
     bool completing_;
     /// Tolerance for the shared pool before it begins to deallocate.
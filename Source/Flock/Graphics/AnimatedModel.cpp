@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationState.h"
@@ -36,13 +37,16 @@
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Octree.h"
+#include "../Graphics/Renderer.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Scene/Scene.h"
 
-
+#ifdef FLOCKSDK_SSE
+#include <emmintrin.h>
+#endif
 
 namespace FlockSDK
 {
@@ -63,24 +67,59 @@ const char* animationStatesStructureElementNames[] =
 
 static const unsigned MAX_ANIMATION_STATES = 256;
 
+/// Return the projected size of a bounding box as a fraction of the viewport height.
+static float GetProjectedScreenSize(Camera* camera, float distance, const BoundingBox& box)
+{
+    float halfViewSize = camera->GetHalfViewSize();
+    if (!camera->IsOrthographic())
+        halfViewSize *= distance;
+    return box.HalfSize().Length() / Max(halfViewSize, M_EPSILON);
+}
+
+/// Add a weighted morph delta to a 3-component vertex element.
+inline void ApplyMorphDelta(float* dest, const float* src, float weight)
+{
+#ifdef FLOCKSDK_SSE
+    // Load and store only 3 floats, as the element may be followed by other vertex data or the end of the buffer
+    __m128 destVec = _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)dest), _mm_load_ss(dest + 2));
+    __m128 srcVec = _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)src), _mm_load_ss(src + 2));
+    destVec = _mm_add_ps(destVec, _mm_mul_ps(srcVec, _mm_set1_ps(weight)));
+    _mm_storel_pi((__m64*)dest, destVec);
+    _mm_store_ss(dest + 2, _mm_movehl_ps(destVec, destVec));
+#else
+    dest[0] += src[0] * weight;
+    dest[1] += src[1] * weight;
+    dest[2] += src[2] * weight;
+#endif
+}
+
 AnimatedModel::AnimatedModel(Context* context) :
     StaticModel(context),
     animationLodFrameNumber_(0),
     morphElementMask_(0),
+    skinPaletteFrameNumber_(0),
     animationLodBias_(1.0f),
     animationLodTimer_(-1.0f),
     animationLodDistance_(0.0f),
+    animationScreenSize_(0.0f),
+    animationLod_(0),
+    animationLodInterpolation_(false),
+    skipShadowOnlySkinning_(false),
     updateInvisible_(false),
     animationDirty_(false),
     animationOrderDirty_(false),
     morphsDirty_(false),
+    morphsUploadPending_(false),
     skinningDirty_(true),
+    skinningValid_(false),
     boneBoundingBoxDirty_(true),
     isMaster_(true),
     loading_(false),
     assignBonesPending_(false),
     forceAnimationUpdate_(false)
 {
+    for (auto i = 0u; i < MAX_ANIMATION_LODS; ++i)
+        animationLodScreenSizes_[i] = 0.0f;
 }
 
 AnimatedModel::~AnimatedModel()
@@ -119,6 +158,14 @@ void AnimatedModel::RegisterObject(Context* context)
                                                             animationStatesStructureElementNames, AM_FILE);
     FLOCKSDK_ACCESSOR_ATTRIBUTE("Morphs", GetMorphsAttr, SetMorphsAttr, PODVector<unsigned char>, Variant::emptyBuffer,
         AM_DEFAULT | AM_NOEDIT);
+    FLOCKSDK_MIXED_ACCESSOR_ATTRIBUTE("Animation LOD Screen Sizes", GetAnimationLodScreenSizesAttr, SetAnimationLodScreenSizesAttr,
+        Vector3, Vector3::ZERO, AM_DEFAULT);
+    FLOCKSDK_ACCESSOR_ATTRIBUTE("Animation LOD Interpolation", GetAnimationLodInterpolation, SetAnimationLodInterpolation, bool, false,
+        AM_DEFAULT);
+    FLOCKSDK_ACCESSOR_ATTRIBUTE("Skip Shadow-Only Skinning", GetSkipShadowOnlySkinning, SetSkipShadowOnlySkinning, bool, false,
+        AM_DEFAULT);
+    FLOCKSDK_MIXED_ACCESSOR_ATTRIBUTE("Bone Max Animation LOD", GetBonesMaxAnimationLodAttr, SetBonesMaxAnimationLodAttr, VariantVector,
+        Variant::emptyVariantVector, AM_FILE | AM_NOEDIT);
 }
 
 bool AnimatedModel::Load(Deserializer& source, bool setInstanceDefault)
@@ -244,6 +291,7 @@ void AnimatedModel::Update(const FrameInfo& frame)
             return;
         float scale = GetWorldBoundingBox().Size().DotProduct(DOT_SCALE);
         animationLodDistance_ = frame.camera_->GetLodDistance(distance, scale, lodBias_);
+        SetAnimationScreenSize(GetProjectedScreenSize(frame.camera_, distance, GetWorldBoundingBox()));
     }
 
     if (animationDirty_ || animationOrderDirty_)
@@ -254,6 +302,12 @@ void AnimatedModel::Update(const FrameInfo& frame)
 
 void AnimatedModel::UpdateBatches(const FrameInfo& frame)
 {
+    // Switch the batches between per-draw skinning matrices and the shared skinning palette if the setting changed
+    Renderer* renderer = GetSubsystem<Renderer>();
+    bool skinPalette = renderer && renderer->GetSkinningPalette() && skinMatrices_.Size();
+    if (skinPalette != !skinPaletteTransforms_.Empty())
+        SetSkinningBatches(skinPalette);
+
     const Matrix3x4& worldTransform = node_->GetWorldTransform();
     const BoundingBox& worldBoundingBox = GetWorldBoundingBox();
     distance_ = frame.camera_->GetDistance(worldBoundingBox.Center());
@@ -273,15 +327,20 @@ void AnimatedModel::UpdateBatches(const FrameInfo& frame)
     BoundingBox transformedBoundingBox = boundingBox_.Transformed(worldTransform);
     float scale = transformedBoundingBox.Size().DotProduct(DOT_SCALE);
     float newLodDistance = frame.camera_->GetLodDistance(distance_, scale, lodBias_);
+    float screenSize = GetProjectedScreenSize(frame.camera_, distance_, transformedBoundingBox);
 
-    // If model is rendered from several views, use the minimum LOD distance for animation LOD
+    // If model is rendered from several views, use the minimum LOD distance and the largest screen size for animation LOD
     if (frame.frameNumber_ != animationLodFrameNumber_)
     {
         animationLodDistance_ = newLodDistance;
         animationLodFrameNumber_ = frame.frameNumber_;
+        SetAnimationScreenSize(screenSize);
     }
     else
+    {
         animationLodDistance_ = Min(animationLodDistance_, newLodDistance);
+        SetAnimationScreenSize(Max(animationScreenSize_, screenSize));
+    }
 
     if (newLodDistance != lodDistance_)
     {
@@ -303,13 +362,77 @@ void AnimatedModel::UpdateGeometry(const FrameInfo& frame)
         UpdateMorphs();
 
     if (skinningDirty_)
-        UpdateSkinning();
+    {
+        // If the model is outside the view and only rendered as a shadow caster, the previous skinning may be reused
+        if (skipShadowOnlySkinning_ && skinningValid_ && viewCameras_.Empty())
+        {
+            Renderer* renderer = GetSubsystem<Renderer>();
+            if (renderer)
+                renderer->AddAnimationStats(0, 0, 1);
+        }
+        else
+            UpdateSkinning();
+    }
+
+    // If the update happened on the main thread, upload the morphs and skinning matrices right away
+    if (Thread::IsMainThread())
+        UploadGeometry(frame);
+}
+
+void AnimatedModel::UploadGeometry(const FrameInfo& frame)
+{
+    if (morphsUploadPending_)
+    {
+        for (auto i = 0u; i < morphVertexBuffers_.Size(); ++i)
+        {
+            VertexBuffer* buffer = morphVertexBuffers_[i];
+            if (buffer)
+            {
+                unsigned morphStart = model_->GetMorphRangeStart(i);
+                unsigned morphCount = model_->GetMorphRangeCount(i);
+                if (morphCount)
+                    buffer->SetDataRange(buffer->GetShadowData() + morphStart * buffer->GetVertexSize(), morphStart, morphCount);
+            }
+        }
+
+        morphsUploadPending_ = false;
+    }
+
+    // Add the skinning matrices to the palette once per frame, even if the model is visible in several views
+    if (!skinPaletteTransforms_.Empty() && skinPaletteFrameNumber_ != frame.frameNumber_)
+    {
+        Renderer* renderer = GetSubsystem<Renderer>();
+        if (!renderer)
+            return;
+
+        unsigned globalOffset = M_MAX_UNSIGNED;
+        for (auto i = 0u; i < skinPaletteTransforms_.Size(); ++i)
+        {
+            unsigned offset;
+            // Geometries with bone mappings use their own subset of the skinning matrices
+            if (geometrySkinMatrices_.Size() && geometrySkinMatrices_[i].Size())
+                offset = renderer->AddSkinMatrices(&geometrySkinMatrices_[i][0], geometrySkinMatrices_[i].Size());
+            else
+            {
+                if (globalOffset == M_MAX_UNSIGNED)
+                    globalOffset = renderer->AddSkinMatrices(&skinMatrices_[0], skinMatrices_.Size());
+                offset = globalOffset;
+            }
+
+            skinPaletteTransforms_[i].m00_ = (float)offset;
+        }
+
+        skinPaletteFrameNumber_ = frame.frameNumber_;
+    }
 }
 
 UpdateGeometryType AnimatedModel::GetUpdateGeometryType()
 {
-    if (morphsDirty_ || forceAnimationUpdate_)
+    if (forceAnimationUpdate_)
         return UPDATE_MAIN_THREAD;
+    // When using the skinning palette, the skinning matrices need to be added to the palette on each frame
+    else if (morphsDirty_ || !skinPaletteTransforms_.Empty())
+        return UPDATE_WORKER_THREAD_UPLOAD;
     else if (skinningDirty_)
         return UPDATE_WORKER_THREAD;
     else
@@ -392,34 +515,12 @@ void AnimatedModel::SetModel(Model* model, bool createBones)
 
         // Reserve space for skinning matrices
         skinMatrices_.Resize(skeleton_.GetNumBones());
+        skinningValid_ = false;
         SetGeometryBoneMappings();
 
         // Enable skinning in batches
-        for (auto i = 0u; i < batches_.Size(); ++i)
-        {
-            if (skinMatrices_.Size())
-            {
-                batches_[i].geometryType_ = GEOM_SKINNED;
-                // Check if model has per-geometry bone mappings
-                if (geometrySkinMatrices_.Size() && geometrySkinMatrices_[i].Size())
-                {
-                    batches_[i].worldTransform_ = &geometrySkinMatrices_[i][0];
-                    batches_[i].numWorldTransforms_ = geometrySkinMatrices_[i].Size();
-                }
-                // If not, use the global skin matrices
-                else
-                {
-                    batches_[i].worldTransform_ = &skinMatrices_[0];
-                    batches_[i].numWorldTransforms_ = skinMatrices_.Size();
-                }
-            }
-            else
-            {
-                batches_[i].geometryType_ = GEOM_STATIC;
-                batches_[i].worldTransform_ = &node_->GetWorldTransform();
-                batches_[i].numWorldTransforms_ = 1;
-            }
-        }
+        Renderer* renderer = GetSubsystem<Renderer>();
+        SetSkinningBatches(renderer && renderer->GetSkinningPalette());
     }
     else
     {
@@ -538,6 +639,37 @@ void AnimatedModel::SetAnimationLodBias(float bias)
     MarkNetworkUpdate();
 }
 
+void AnimatedModel::SetAnimationLodScreenSize(unsigned lod, float size)
+{
+    if (!lod || lod >= MAX_ANIMATION_LODS)
+    {
+        FLOCKSDK_LOGERROR("Illegal animation LOD level " + String(lod));
+        return;
+    }
+
+    animationLodScreenSizes_[lod] = Max(size, 0.0f);
+    SetAnimationScreenSize(animationScreenSize_);
+    MarkNetworkUpdate();
+}
+
+void AnimatedModel::SetAnimationLodInterpolation(bool enable)
+{
+    animationLodInterpolation_ = enable;
+    if (!enable)
+    {
+        prevPosePositions_.Clear();
+        prevPoseRotations_.Clear();
+        prevPoseScales_.Clear();
+    }
+    MarkNetworkUpdate();
+}
+
+void AnimatedModel::SetSkipShadowOnlySkinning(bool enable)
+{
+    skipShadowOnlySkinning_ = enable;
+    MarkNetworkUpdate();
+}
+
 void AnimatedModel::SetUpdateInvisible(bool enable)
 {
     updateInvisible_ = enable;
@@ -623,6 +755,11 @@ void AnimatedModel::ResetMorphWeights()
     MarkNetworkUpdate();
 }
 
+float AnimatedModel::GetAnimationLodScreenSize(unsigned lod) const
+{
+    return lod < MAX_ANIMATION_LODS ? animationLodScreenSizes_[lod] : 0.0f;
+}
+
 float AnimatedModel::GetMorphWeight(unsigned index) const
 {
     return index < morphs_.Size() ? morphs_[index].weight_ : 0.0f;
@@ -899,6 +1036,36 @@ const PODVector<unsigned char>& AnimatedModel::GetMorphsAttr() const
     return attrBuffer_.GetBuffer();
 }
 
+void AnimatedModel::SetBonesMaxAnimationLodAttr(const VariantVector &value)
+{
+    Vector<Bone>& bones = skeleton_.GetModifiableBones();
+    for (auto i = 0u; i < bones.Size() && i < value.Size(); ++i)
+        bones[i].maxAnimationLod_ = value[i].GetUInt();
+}
+
+void AnimatedModel::SetAnimationLodScreenSizesAttr(const Vector3& value)
+{
+    animationLodScreenSizes_[1] = Max(value.x_, 0.0f);
+    animationLodScreenSizes_[2] = Max(value.y_, 0.0f);
+    animationLodScreenSizes_[3] = Max(value.z_, 0.0f);
+    SetAnimationScreenSize(animationScreenSize_);
+}
+
+VariantVector AnimatedModel::GetBonesMaxAnimationLodAttr() const
+{
+    VariantVector ret;
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    ret.Reserve(bones.Size());
+    for (Vector<Bone>::ConstIterator i = bones.Begin(); i != bones.End(); ++i)
+        ret.Push(i->maxAnimationLod_);
+    return ret;
+}
+
+Vector3 AnimatedModel::GetAnimationLodScreenSizesAttr() const
+{
+    return Vector3(animationLodScreenSizes_[1], animationLodScreenSizes_[2], animationLodScreenSizes_[3]);
+}
+
 void AnimatedModel::UpdateBoneBoundingBox()
 {
     if (skeleton_.GetNumBones())
@@ -1216,6 +1383,54 @@ void AnimatedModel::CopyMorphVertices(void* destVertexData, void* srcVertexData,
     }
 }
 
+void AnimatedModel::SetSkinningBatches(bool skinPalette)
+{
+    skinPaletteTransforms_.Clear();
+    skinPaletteFrameNumber_ = 0;
+    if (skinPalette && skinMatrices_.Size())
+    {
+        skinPaletteTransforms_.Resize(batches_.Size());
+        for (auto i = 0u; i < skinPaletteTransforms_.Size(); ++i)
+            skinPaletteTransforms_[i] = Matrix3x4::ZERO;
+    }
+
+    for (auto i = 0u; i < batches_.Size(); ++i)
+    {
+        if (skinMatrices_.Size())
+        {
+            // With the skinning palette, the batch transform only carries the palette offset. This allows instancing
+            if (!skinPaletteTransforms_.Empty())
+            {
+                batches_[i].geometryType_ = GEOM_SKINPALETTE;
+                batches_[i].worldTransform_ = &skinPaletteTransforms_[i];
+                batches_[i].numWorldTransforms_ = 1;
+            }
+            else
+            {
+                batches_[i].geometryType_ = GEOM_SKINNED;
+                // Check if model has per-geometry bone mappings
+                if (geometrySkinMatrices_.Size() && geometrySkinMatrices_[i].Size())
+                {
+                    batches_[i].worldTransform_ = &geometrySkinMatrices_[i][0];
+                    batches_[i].numWorldTransforms_ = geometrySkinMatrices_[i].Size();
+                }
+                // If not, use the global skin matrices
+                else
+                {
+                    batches_[i].worldTransform_ = &skinMatrices_[0];
+                    batches_[i].numWorldTransforms_ = skinMatrices_.Size();
+                }
+            }
+        }
+        else
+        {
+            batches_[i].geometryType_ = GEOM_STATIC;
+            batches_[i].worldTransform_ = &node_->GetWorldTransform();
+            batches_[i].numWorldTransforms_ = 1;
+        }
+    }
+}
+
 void AnimatedModel::SetGeometryBoneMappings()
 {
     geometrySkinMatrices_.Clear();
@@ -1250,6 +1465,8 @@ void AnimatedModel::SetGeometryBoneMappings()
 
 void AnimatedModel::UpdateAnimation(const FrameInfo& frame)
 {
+    Renderer* renderer = GetSubsystem<Renderer>();
+
     // If using animation LOD, accumulate time and see if it is time to update
     if (animationLodBias_ > 0.0f && animationLodDistance_ > 0.0f)
     {
@@ -1260,13 +1477,78 @@ void AnimatedModel::UpdateAnimation(const FrameInfo& frame)
             if (animationLodTimer_ >= animationLodDistance_)
                 animationLodTimer_ = fmodf(animationLodTimer_, animationLodDistance_);
             else
+            {
+                // Between updates, optionally interpolate from the previous sampled pose to the current one
+                if (animationLodInterpolation_ && isMaster_ && prevPosePositions_.Size() == posePositions_.Size())
+                    ApplyPose(animationLodTimer_ / animationLodDistance_);
+
+                if (renderer)
+                    renderer->AddAnimationStats(0, 1, 0);
                 return;
+            }
         }
         else
             animationLodTimer_ = 0.0f;
     }
 
     ApplyAnimation();
+
+    if (renderer)
+        renderer->AddAnimationStats(1, 0, 0);
+}
+
+void AnimatedModel::SetAnimationScreenSize(float screenSize)
+{
+    animationScreenSize_ = screenSize;
+
+    // Use the highest LOD level whose screen size threshold the model is below
+    unsigned lod = 0;
+    for (auto i = 1u; i < MAX_ANIMATION_LODS; ++i)
+    {
+        if (animationLodScreenSizes_[i] > 0.0f && screenSize < animationLodScreenSizes_[i])
+            lod = i;
+    }
+
+    // Changing the level changes the set of animated bones, so the pose must be resampled
+    if (lod != animationLod_)
+    {
+        animationLod_ = lod;
+        if (isMaster_)
+            animationDirty_ = true;
+    }
+}
+
+void AnimatedModel::ApplyPose(float t)
+{
+    const Vector<Bone>& bones = skeleton_.GetBones();
+
+    // Transforms are applied silently, as the bone nodes are marked dirty all at once below
+    if (t >= 1.0f || prevPosePositions_.Size() != bones.Size())
+    {
+        for (auto i = 0u; i < bones.Size(); ++i)
+        {
+            const Bone& bone = bones[i];
+            if (bone.animated_ && bone.node_)
+                bone.node_->SetTransformSilent(posePositions_[i], poseRotations_[i], poseScales_[i]);
+        }
+    }
+    else
+    {
+        for (auto i = 0u; i < bones.Size(); ++i)
+        {
+            const Bone& bone = bones[i];
+            if (bone.animated_ && bone.node_)
+            {
+                bone.node_->SetTransformSilent(prevPosePositions_[i].Lerp(posePositions_[i], t),
+                    prevPoseRotations_[i].Slerp(poseRotations_[i], t), prevPoseScales_[i].Lerp(poseScales_[i], t));
+            }
+        }
+    }
+
+    node_->MarkDirty();
+
+    // Calculate new bone bounding box
+    UpdateBoneBoundingBox();
 }
 
 void AnimatedModel::ApplyAnimation()
@@ -1282,15 +1564,43 @@ void AnimatedModel::ApplyAnimation()
     // (first AnimatedModel in a node)
     if (isMaster_)
     {
-        skeleton_.ResetSilent();
+        // Blend the animations into the pose buffers starting from the initial pose, then write each animated bone node once.
+        // When interpolating between animation LOD updates, keep the previous sampled pose
+        const Vector<Bone>& bones = skeleton_.GetBones();
+        unsigned numBones = bones.Size();
+        bool interpolate = animationLodInterpolation_ && animationLodBias_ > 0.0f && animationLodDistance_ > 0.0f &&
+            animationLodTimer_ > 0.0f && posePositions_.Size() == numBones;
+        if (animationLodInterpolation_)
+        {
+            prevPosePositions_.Swap(posePositions_);
+            prevPoseRotations_.Swap(poseRotations_);
+            prevPoseScales_.Swap(poseScales_);
+        }
+
+        posePositions_.Resize(numBones);
+        poseRotations_.Resize(numBones);
+        poseScales_.Resize(numBones);
+
+        for (auto i = 0u; i < numBones; ++i)
+        {
+            const Bone& bone = bones[i];
+            posePositions_[i] = bone.initialPosition_;
+            poseRotations_[i] = bone.initialRotation_;
+            poseScales_[i] = bone.initialScale_;
+        }
+
         for (Vector<SharedPtr<AnimationState>>::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
-            (*i)->Apply();
+            (*i)->ApplyToPose(posePositions_.Buffer(), poseRotations_.Buffer(), poseScales_.Buffer());
 
-        // Skeleton reset and animations apply the node transforms "silently" to avoid repeated marking dirty. Mark dirty now
-        node_->MarkDirty();
+        // If the previous pose is stale, for example after a forced update, interpolate from the current pose instead
+        if (animationLodInterpolation_ && !interpolate)
+        {
+            prevPosePositions_ = posePositions_;
+            prevPoseRotations_ = poseRotations_;
+            prevPoseScales_ = poseScales_;
+        }
 
-        // Calculate new bone bounding box
-        UpdateBoneBoundingBox();
+        ApplyPose(interpolate ? animationLodTimer_ / animationLodDistance_ : 1.0f);
     }
 
     animationDirty_ = false;
@@ -1333,6 +1643,7 @@ void AnimatedModel::UpdateSkinning()
     }
 
     skinningDirty_ = false;
+    skinningValid_ = true;
 }
 
 void AnimatedModel::UpdateMorphs()
@@ -1343,7 +1654,8 @@ void AnimatedModel::UpdateMorphs()
 
     if (morphs_.Size())
     {
-        // Reset the morph data range from all morphable vertex buffers, then apply morphs
+        // Reset the morph data range from all morphable vertex buffers, then apply morphs. Only the shadow data is written here,
+        // as the GPU upload in UploadGeometry() has to happen on the main thread
         for (auto i = 0u; i < morphVertexBuffers_.Size(); ++i)
         {
             VertexBuffer* buffer = morphVertexBuffers_[i];
@@ -1353,9 +1665,10 @@ void AnimatedModel::UpdateMorphs()
                 unsigned morphStart = model_->GetMorphRangeStart(i);
                 unsigned morphCount = model_->GetMorphRangeCount(i);
 
-                void* dest = buffer->Lock(morphStart, morphCount);
-                if (dest)
+                if (morphCount)
                 {
+                    void* dest = buffer->GetShadowData() + morphStart * buffer->GetVertexSize();
+
                     // Reset morph range by copying data from the original vertex buffer
                     CopyMorphVertices(dest, originalBuffer->GetShadowData() + morphStart * originalBuffer->GetVertexSize(),
                         morphCount, buffer, originalBuffer);
@@ -1369,11 +1682,11 @@ void AnimatedModel::UpdateMorphs()
                                 ApplyMorph(buffer, dest, morphStart, k->second_, morphs_[j].weight_);
                         }
                     }
-
-                    buffer->Unlock();
                 }
             }
         }
+
+        morphsUploadPending_ = true;
     }
 
     morphsDirty_ = false;
@@ -1398,29 +1711,17 @@ void AnimatedModel::ApplyMorph(VertexBuffer* buffer, void* destVertexData, unsig
 
         if (elementMask & MASK_POSITION)
         {
-            float* dest = (float*)(destData + vertexIndex * vertexSize);
-            float* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
+            ApplyMorphDelta((float*)(destData + vertexIndex * vertexSize), (const float*)srcData, weight);
             srcData += 3 * sizeof(float);
         }
         if (elementMask & MASK_NORMAL)
         {
-            float* dest = (float*)(destData + vertexIndex * vertexSize + normalOffset);
-            float* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
+            ApplyMorphDelta((float*)(destData + vertexIndex * vertexSize + normalOffset), (const float*)srcData, weight);
             srcData += 3 * sizeof(float);
         }
         if (elementMask & MASK_TANGENT)
         {
-            float* dest = (float*)(destData + vertexIndex * vertexSize + tangentOffset);
-            float* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
+            ApplyMorphDelta((float*)(destData + vertexIndex * vertexSize + tangentOffset), (const float*)srcData, weight);
             srcData += 3 * sizeof(float);
         }
     }
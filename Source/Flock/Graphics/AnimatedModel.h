@@ -32,6 +32,9 @@ namespace FlockSDK
 class Animation;
 class AnimationState;
 
+/// Maximum number of animation LOD levels, including the full detail level 0.
+static const unsigned MAX_ANIMATION_LODS = 4;
+
 /// Animated model component.
 class FLOCKSDK_API AnimatedModel : public StaticModel
 {
@@ -63,6 +66,8 @@ public:
     virtual void UpdateBatches(const FrameInfo& frame);
     /// Prepare geometry for rendering. Called from a worker thread if possible (no GPU update.)
     virtual void UpdateGeometry(const FrameInfo& frame);
+    /// Upload vertex morphs applied in a worker thread to the GPU and add the skinning matrices to the skinning palette. Called from the main thread.
+    virtual void UploadGeometry(const FrameInfo& frame);
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     virtual UpdateGeometryType GetUpdateGeometryType();
     /// Visualize the component as debug geometry.
@@ -86,6 +91,12 @@ public:
     void RemoveAllAnimationStates();
     /// Set animation LOD bias.
     void SetAnimationLodBias(float bias);
+    /// Set projected screen size (fraction of viewport height) below which an animation LOD level is used. Levels 1 to MAX_ANIMATION_LODS - 1 can be set. Zero disables the level.
+    void SetAnimationLodScreenSize(unsigned lod, float size);
+    /// Set whether to interpolate the bone transforms on frames where the animation update is skipped due to animation LOD.
+    void SetAnimationLodInterpolation(bool enable);
+    /// Set whether to skip skinning on frames where the model is only rendered as a shadow caster outside the view.
+    void SetSkipShadowOnlySkinning(bool enable);
     /// Set whether to update animation and the bounding box when not visible. Recommended to enable for physically controlled models like ragdolls.
     void SetUpdateInvisible(bool enable);
     /// Set vertex morph weight by index.
@@ -120,6 +131,21 @@ public:
     /// Return animation LOD bias.
     float GetAnimationLodBias() const { return animationLodBias_; }
 
+    /// Return projected screen size below which an animation LOD level is used.
+    float GetAnimationLodScreenSize(unsigned lod) const;
+
+    /// Return whether bone transforms are interpolated between animation LOD updates.
+    bool GetAnimationLodInterpolation() const { return animationLodInterpolation_; }
+
+    /// Return whether skinning is skipped when only rendered as a shadow caster.
+    bool GetSkipShadowOnlySkinning() const { return skipShadowOnlySkinning_; }
+
+    /// Return current animation LOD level.
+    unsigned GetAnimationLod() const { return animationLod_; }
+
+    /// Return largest projected screen size from all views last frame.
+    float GetAnimationScreenSize() const { return animationScreenSize_; }
+
     /// Return whether to update animation when not visible.
     bool GetUpdateInvisible() const { return updateInvisible_; }
 
@@ -150,6 +176,10 @@ public:
     void SetAnimationStatesAttr(const VariantVector &value);
     /// Set morphs attribute.
     void SetMorphsAttr(const PODVector<unsigned char>& value);
+    /// Set bone max animation LOD levels attribute.
+    void SetBonesMaxAnimationLodAttr(const VariantVector &value);
+    /// Set animation LOD screen sizes attribute.
+    void SetAnimationLodScreenSizesAttr(const Vector3& value);
     /// Return model attribute.
     ResourceRef GetModelAttr() const;
     /// Return bones' animation enabled attribute.
@@ -158,6 +188,10 @@ public:
     VariantVector GetAnimationStatesAttr() const;
     /// Return morphs attribute.
     const PODVector<unsigned char>& GetMorphsAttr() const;
+    /// Return bone max animation LOD levels attribute.
+    VariantVector GetBonesMaxAnimationLodAttr() const;
+    /// Return animation LOD screen sizes attribute.
+    Vector3 GetAnimationLodScreenSizesAttr() const;
 
     /// Return per-geometry bone mappings.
     const Vector<PODVector<unsigned> >& GetGeometryBoneMappings() const { return geometryBoneMappings_; }
@@ -191,6 +225,8 @@ private:
     void MarkMorphsDirty();
     /// Set skeleton.
     void SetSkeleton(const Skeleton& skeleton, bool createBones);
+    /// Set the batches to use either per-draw skinning matrices or the shared skinning palette.
+    void SetSkinningBatches(bool skinPalette);
     /// Set mapping of subgeometry bone indices.
     void SetGeometryBoneMappings();
     /// Clone geometries for vertex morphing.
@@ -199,9 +235,13 @@ private:
     void CopyMorphVertices(void* dest, void* src, unsigned vertexCount, VertexBuffer* clone, VertexBuffer* original);
     /// Recalculate animations. Called from Update().
     void UpdateAnimation(const FrameInfo& frame);
+    /// Select the animation LOD level from the projected screen size.
+    void SetAnimationScreenSize(float screenSize);
+    /// Write the pose interpolated from the previous to the current sampled pose to the bone nodes.
+    void ApplyPose(float t);
     /// Recalculate skinning.
     void UpdateSkinning();
-    /// Reapply all vertex morphs.
+    /// Reapply all vertex morphs to the morph vertex buffers' shadow data. May be called from a worker thread.
     void UpdateMorphs();
     /// Apply a vertex morph.
     void ApplyMorph
@@ -219,12 +259,26 @@ private:
     Vector<SharedPtr<AnimationState> > animationStates_;
     /// Skinning matrices.
     PODVector<Matrix3x4> skinMatrices_;
+    /// Pose bone positions, blended from all animation states before being written to the bone nodes.
+    PODVector<Vector3> posePositions_;
+    /// Pose bone rotations.
+    PODVector<Quaternion> poseRotations_;
+    /// Pose bone scales.
+    PODVector<Vector3> poseScales_;
+    /// Previous sampled pose bone positions, used for animation LOD interpolation.
+    PODVector<Vector3> prevPosePositions_;
+    /// Previous sampled pose bone rotations.
+    PODVector<Quaternion> prevPoseRotations_;
+    /// Previous sampled pose bone scales.
+    PODVector<Vector3> prevPoseScales_;
     /// Mapping of subgeometry bone indices, used if more bones than skinning shader can manage.
     Vector<PODVector<unsigned> > geometryBoneMappings_;
     /// Subgeometry skinning matrices, used if more bones than skinning shader can manage.
     Vector<PODVector<Matrix3x4> > geometrySkinMatrices_;
     /// Subgeometry skinning matrix pointers, if more bones than skinning shader can manage.
     Vector<PODVector<Matrix3x4*> > geometrySkinMatrixPtrs_;
+    /// Batch transforms holding the skinning palette offset in the first element, used with the skinning palette.
+    PODVector<Matrix3x4> skinPaletteTransforms_;
     /// Bounding box calculated from bones.
     BoundingBox boneBoundingBox_;
     /// Attribute buffer.
@@ -233,12 +287,24 @@ private:
     unsigned animationLodFrameNumber_;
     /// Morph vertex element mask.
     unsigned morphElementMask_;
+    /// The frame number the skinning matrices were last added to the skinning palette on.
+    unsigned skinPaletteFrameNumber_;
     /// Animation LOD bias.
     float animationLodBias_;
     /// Animation LOD timer.
     float animationLodTimer_;
     /// Animation LOD distance, the minimum of all LOD view distances last frame.
     float animationLodDistance_;
+    /// Projected screen size, the maximum of all views last frame.
+    float animationScreenSize_;
+    /// Projected screen sizes below which the animation LOD levels are used.
+    float animationLodScreenSizes_[MAX_ANIMATION_LODS];
+    /// Current animation LOD level.
+    unsigned animationLod_;
+    /// Interpolate bone transforms between animation LOD updates flag.
+    bool animationLodInterpolation_;
+    /// Skip skinning when only rendered as a shadow caster flag.
+    bool skipShadowOnlySkinning_;
     /// Update animation when invisible flag.
     bool updateInvisible_;
     /// Animation dirty flag.
@@ -247,8 +313,12 @@ private:
     bool animationOrderDirty_;
     /// Vertex morphs dirty flag.
     bool morphsDirty_;
+    /// Vertex morphs applied to shadow data but not yet uploaded flag.
+    bool morphsUploadPending_;
     /// Skinning dirty flag.
     bool skinningDirty_;
+    /// Skinning matrices calculated at least once flag.
+    bool skinningValid_;
     /// Bone bounding box dirty flag.
     bool boneBoundingBoxDirty_;
     /// Master model flag.
@@ -30,6 +30,7 @@
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/Serializer.h"
+#include "../Math/BoundingBox.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
@@ -39,8 +40,110 @@
 namespace FlockSDK
 {
 
+/// Maximum quantized position or scale value.
+static const float MAX_QUANTIZED_VALUE = 65535.0f;
+/// Maximum quantized rotation component value. The high bit is used to store the index of the omitted component.
+static const float MAX_QUANTIZED_ROTATION = 32767.0f;
+/// Range of the smallest three rotation components is [-1/sqrt(2), 1/sqrt(2)].
+static const float ROTATION_COMPONENT_MAX = 0.70710678f;
+
+static void QuantizeVector3(const Vector3& value, const Vector3& min, const Vector3& step, unsigned short* dest)
+{
+    dest[0] = (unsigned short)(step.x_ > 0.0f ? Clamp(RoundToInt((value.x_ - min.x_) / step.x_), 0, 65535) : 0);
+    dest[1] = (unsigned short)(step.y_ > 0.0f ? Clamp(RoundToInt((value.y_ - min.y_) / step.y_), 0, 65535) : 0);
+    dest[2] = (unsigned short)(step.z_ > 0.0f ? Clamp(RoundToInt((value.z_ - min.z_) / step.z_), 0, 65535) : 0);
+}
+
+static Vector3 DequantizeVector3(const unsigned short* src, const Vector3& min, const Vector3& step)
+{
+    return Vector3(min.x_ + src[0] * step.x_, min.y_ + src[1] * step.y_, min.z_ + src[2] * step.z_);
+}
+
+static void QuantizeRotation(const Quaternion& rotation, unsigned short* dest)
+{
+    Quaternion normalized = rotation.Normalized();
+    float components[4] = { normalized.w_, normalized.x_, normalized.y_, normalized.z_ };
+
+    // Omit the largest component, which can be reconstructed from the others. As q and -q are the same rotation, flip the sign
+    // so that the omitted component is positive
+    unsigned largest = 0;
+    for (auto i = 1u; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largest]))
+            largest = i;
+    }
+    float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+    unsigned j = 0;
+    for (auto i = 0u; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        float value = (components[i] * sign + ROTATION_COMPONENT_MAX) / (2.0f * ROTATION_COMPONENT_MAX);
+        dest[j++] = (unsigned short)Clamp(RoundToInt(value * MAX_QUANTIZED_ROTATION), 0, 32767);
+    }
+
+    dest[0] |= (largest & 1) << 15;
+    dest[1] |= (largest & 2) << 14;
+}
+
+static Quaternion DequantizeRotation(const unsigned short* src)
+{
+    unsigned largest = (src[0] >> 15) | ((src[1] >> 14) & 2);
+    float components[4];
+    float sumSquares = 0.0f;
+
+    unsigned j = 0;
+    for (auto i = 0u; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        float value = (src[j++] & 0x7fff) * (2.0f * ROTATION_COMPONENT_MAX / MAX_QUANTIZED_ROTATION) - ROTATION_COMPONENT_MAX;
+        components[i] = value;
+        sumSquares += value * value;
+    }
+    components[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+
+    return Quaternion(components[0], components[1], components[2], components[3]);
+}
+
+static bool CanInterpolateKeyFrames(const Vector<AnimationKeyFrame>& keyFrames, unsigned first, unsigned last, unsigned char channelMask,
+    float positionTolerance, float rotationTolerance, float scaleTolerance)
+{
+    const AnimationKeyFrame& start = keyFrames[first];
+    const AnimationKeyFrame& end = keyFrames[last];
+    float timeInterval = end.time_ - start.time_;
+    if (timeInterval <= 0.0f)
+        return false;
+
+    // Compare each keyframe in between to the interpolated value, interpolating the same way as AnimationState does
+    for (auto i = first + 1; i < last; ++i)
+    {
+        const AnimationKeyFrame& keyFrame = keyFrames[i];
+        float t = (keyFrame.time_ - start.time_) / timeInterval;
+
+        if ((channelMask & CHANNEL_POSITION) && (start.position_.Lerp(end.position_, t) - keyFrame.position_).Length() >
+            positionTolerance)
+            return false;
+        if (channelMask & CHANNEL_ROTATION)
+        {
+            // Use the vector part of the difference rotation to measure the angle, as it stays accurate for small angles
+            Quaternion delta = start.rotation_.Slerp(end.rotation_, t).Inverse() * keyFrame.rotation_;
+            if (2.0f * Asin(Vector3(delta.x_, delta.y_, delta.z_).Length()) > rotationTolerance)
+                return false;
+        }
+        if ((channelMask & CHANNEL_SCALE) && (start.scale_.Lerp(end.scale_, t) - keyFrame.scale_).Length() > scaleTolerance)
+            return false;
+    }
+
+    return true;
+}
+
 void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
+    if (!CheckEditable())
+        return;
+
     if (index < keyFrames_.Size())
     {
         keyFrames_[index] = keyFrame;
@@ -52,6 +155,9 @@ void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFra
 
 void AnimationTrack::AddKeyFrame(const AnimationKeyFrame& keyFrame)
 {
+    if (!CheckEditable())
+        return;
+
     bool needSort = keyFrames_.Size() ? keyFrames_.Back().time_ > keyFrame.time_ : false;
     keyFrames_.Push(keyFrame);
     if (needSort)
@@ -60,18 +166,116 @@ void AnimationTrack::AddKeyFrame(const AnimationKeyFrame& keyFrame)
 
 void AnimationTrack::InsertKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
+    if (!CheckEditable())
+        return;
+
     keyFrames_.Insert(index, keyFrame);
     FlockSDK::Sort(keyFrames_.Begin(), keyFrames_.End(), [] (AnimationKeyFrame& lhs, AnimationKeyFrame& rhs) -> bool { return lhs.time_ < rhs.time_; });
 }
 
 void AnimationTrack::RemoveKeyFrame(unsigned index)
 {
+    if (!CheckEditable())
+        return;
+
     keyFrames_.Erase(index);
 }
 
 void AnimationTrack::RemoveAllKeyFrames()
 {
     keyFrames_.Clear();
+    compressedTimes_.Clear();
+    compressedPositions_.Clear();
+    compressedRotations_.Clear();
+    compressedScales_.Clear();
+}
+
+void AnimationTrack::Compress(float positionTolerance, float rotationTolerance, float scaleTolerance)
+{
+    if (IsCompressed() || keyFrames_.Empty())
+        return;
+
+    // Reduce keyframes by extending each interpolated span as long as the keyframes inside it stay within the tolerances.
+    // The first and last keyframes are always kept, as looping interpolates from the last to the first
+    PODVector<unsigned> keptKeyFrames;
+    unsigned lastIndex = keyFrames_.Size() - 1;
+    unsigned start = 0;
+    keptKeyFrames.Push(0);
+
+    while (start < lastIndex)
+    {
+        unsigned end = start + 1;
+        while (end < lastIndex &&
+               CanInterpolateKeyFrames(keyFrames_, start, end + 1, channelMask_, positionTolerance, rotationTolerance, scaleTolerance))
+            ++end;
+        keptKeyFrames.Push(end);
+        start = end;
+    }
+
+    // Calculate the quantization bounds
+    BoundingBox positionBounds;
+    BoundingBox scaleBounds;
+    for (auto i = 0u; i < keptKeyFrames.Size(); ++i)
+    {
+        const AnimationKeyFrame& keyFrame = keyFrames_[keptKeyFrames[i]];
+        positionBounds.Merge(keyFrame.position_);
+        scaleBounds.Merge(keyFrame.scale_);
+    }
+    positionMin_ = positionBounds.min_;
+    positionStep_ = (positionBounds.max_ - positionBounds.min_) / MAX_QUANTIZED_VALUE;
+    scaleMin_ = scaleBounds.min_;
+    scaleStep_ = (scaleBounds.max_ - scaleBounds.min_) / MAX_QUANTIZED_VALUE;
+
+    unsigned numKeyFrames = keptKeyFrames.Size();
+    compressedTimes_.Resize(numKeyFrames);
+    compressedPositions_.Resize((channelMask_ & CHANNEL_POSITION) ? numKeyFrames * 3 : 0);
+    compressedRotations_.Resize((channelMask_ & CHANNEL_ROTATION) ? numKeyFrames * 3 : 0);
+    compressedScales_.Resize((channelMask_ & CHANNEL_SCALE) ? numKeyFrames * 3 : 0);
+
+    for (auto i = 0u; i < numKeyFrames; ++i)
+    {
+        const AnimationKeyFrame& keyFrame = keyFrames_[keptKeyFrames[i]];
+        compressedTimes_[i] = keyFrame.time_;
+        if (compressedPositions_.Size())
+            QuantizeVector3(keyFrame.position_, positionMin_, positionStep_, &compressedPositions_[i * 3]);
+        if (compressedRotations_.Size())
+            QuantizeRotation(keyFrame.rotation_, &compressedRotations_[i * 3]);
+        if (compressedScales_.Size())
+            QuantizeVector3(keyFrame.scale_, scaleMin_, scaleStep_, &compressedScales_[i * 3]);
+    }
+
+    keyFrames_.Clear();
+    keyFrames_.Compact();
+}
+
+void AnimationTrack::Decompress()
+{
+    if (!IsCompressed())
+        return;
+
+    keyFrames_.Resize(compressedTimes_.Size());
+    for (auto i = 0u; i < keyFrames_.Size(); ++i)
+        DecodeKeyFrame(i, keyFrames_[i]);
+
+    compressedTimes_.Clear();
+    compressedTimes_.Compact();
+    compressedPositions_.Clear();
+    compressedPositions_.Compact();
+    compressedRotations_.Clear();
+    compressedRotations_.Compact();
+    compressedScales_.Clear();
+    compressedScales_.Compact();
+}
+
+void AnimationTrack::DecodeKeyFrame(unsigned index, AnimationKeyFrame& dest) const
+{
+    dest.time_ = compressedTimes_[index];
+    if (compressedPositions_.Size())
+        dest.position_ = DequantizeVector3(&compressedPositions_[index * 3], positionMin_, positionStep_);
+    if (compressedRotations_.Size())
+        dest.rotation_ = DequantizeRotation(&compressedRotations_[index * 3]);
+    if (compressedScales_.Size())
+        dest.scale_ = DequantizeVector3(&compressedScales_[index * 3], scaleMin_, scaleStep_);
 }
 
 AnimationKeyFrame* AnimationTrack::GetKeyFrame(unsigned index)
@@ -79,20 +283,46 @@ AnimationKeyFrame* AnimationTrack::GetKeyFrame(unsigned index)
     return index < keyFrames_.Size() ? &keyFrames_[index] : (AnimationKeyFrame*)0;
 }
 
+AnimationKeyFrame AnimationTrack::GetDecodedKeyFrame(unsigned index) const
+{
+    AnimationKeyFrame keyFrame;
+    if (index >= GetNumKeyFrames())
+        return keyFrame;
+
+    if (IsCompressed())
+        DecodeKeyFrame(index, keyFrame);
+    else
+        keyFrame = keyFrames_[index];
+
+    return keyFrame;
+}
+
+bool AnimationTrack::CheckEditable() const
+{
+    if (IsCompressed())
+    {
+        FLOCKSDK_LOGERROR("Can not edit keyframes of compressed animation track " + name_ + ", decompress it first");
+        return false;
+    }
+
+    return true;
+}
+
 void AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
 {
     if (time < 0.0f)
         time = 0.0f;
 
-    if (index >= keyFrames_.Size())
-        index = keyFrames_.Size() - 1;
+    unsigned numKeyFrames = GetNumKeyFrames();
+    if (index >= numKeyFrames)
+        index = numKeyFrames - 1;
 
     // Check for being too far ahead
-    while (index && time < keyFrames_[index].time_)
+    while (index && time < GetKeyFrameTime(index))
         --index;
 
     // Check for being too far behind
-    while (index < keyFrames_.Size() - 1 && time >= keyFrames_[index + 1].time_)
+    while (index < numKeyFrames - 1 && time >= GetKeyFrameTime(index + 1))
         ++index;
 }
 
@@ -115,12 +345,14 @@ bool Animation::BeginLoad(Deserializer& source)
 {
     unsigned memoryUse = sizeof(Animation);
 
-    // Check ID
-    if (source.ReadFileID() != "UANI")
+    // Check ID. Version 2 files may contain compressed tracks
+    String fileID = source.ReadFileID();
+    if (fileID != "UANI" && fileID != "UAN2")
     {
         FLOCKSDK_LOGERROR(source.GetName() + " is not a valid animation file");
         return false;
     }
+    bool hasCompressedTracks = fileID == "UAN2";
 
     // Read name and length
     animationName_ = source.ReadString();
@@ -137,21 +369,55 @@ bool Animation::BeginLoad(Deserializer& source)
         AnimationTrack* newTrack = CreateTrack(source.ReadString());
         newTrack->channelMask_ = source.ReadUByte();
 
-        unsigned keyFrames = source.ReadUInt();
-        newTrack->keyFrames_.Resize(keyFrames);
-        memoryUse += keyFrames * sizeof(AnimationKeyFrame);
-
-        // Read keyframes of the track
-        for (auto j = 0u; j < keyFrames; ++j)
+        if (hasCompressedTracks && source.ReadBool())
         {
-            AnimationKeyFrame& newKeyFrame = newTrack->keyFrames_[j];
-            newKeyFrame.time_ = source.ReadFloat();
+            // Read quantized keyframe data of a compressed track
+            unsigned keyFrames = source.ReadUInt();
+            newTrack->compressedTimes_.Resize(keyFrames);
+            source.Read(newTrack->compressedTimes_.Buffer(), keyFrames * sizeof(float));
+            memoryUse += keyFrames * sizeof(float);
+
             if (newTrack->channelMask_ & CHANNEL_POSITION)
-                newKeyFrame.position_ = source.ReadVector3();
+            {
+                newTrack->positionMin_ = source.ReadVector3();
+                newTrack->positionStep_ = source.ReadVector3();
+                newTrack->compressedPositions_.Resize(keyFrames * 3);
+                source.Read(newTrack->compressedPositions_.Buffer(), keyFrames * 3 * sizeof(unsigned short));
+                memoryUse += keyFrames * 3 * sizeof(unsigned short);
+            }
             if (newTrack->channelMask_ & CHANNEL_ROTATION)
-                newKeyFrame.rotation_ = source.ReadQuaternion();
+            {
+                newTrack->compressedRotations_.Resize(keyFrames * 3);
+                source.Read(newTrack->compressedRotations_.Buffer(), keyFrames * 3 * sizeof(unsigned short));
+                memoryUse += keyFrames * 3 * sizeof(unsigned short);
+            }
             if (newTrack->channelMask_ & CHANNEL_SCALE)
-                newKeyFrame.scale_ = source.ReadVector3();
+            {
+                newTrack->scaleMin_ = source.ReadVector3();
+                newTrack->scaleStep_ = source.ReadVector3();
+                newTrack->compressedScales_.Resize(keyFrames * 3);
+                source.Read(newTrack->compressedScales_.Buffer(), keyFrames * 3 * sizeof(unsigned short));
+                memoryUse += keyFrames * 3 * sizeof(unsigned short);
+            }
+        }
+        else
+        {
+            unsigned keyFrames = source.ReadUInt();
+            newTrack->keyFrames_.Resize(keyFrames);
+            memoryUse += keyFrames * sizeof(AnimationKeyFrame);
+
+            // Read keyframes of the track
+            for (auto j = 0u; j < keyFrames; ++j)
+            {
+                AnimationKeyFrame& newKeyFrame = newTrack->keyFrames_[j];
+                newKeyFrame.time_ = source.ReadFloat();
+                if (newTrack->channelMask_ & CHANNEL_POSITION)
+                    newKeyFrame.position_ = source.ReadVector3();
+                if (newTrack->channelMask_ & CHANNEL_ROTATION)
+                    newKeyFrame.rotation_ = source.ReadQuaternion();
+                if (newTrack->channelMask_ & CHANNEL_SCALE)
+                    newKeyFrame.scale_ = source.ReadVector3();
+            }
         }
     }
 
@@ -213,8 +479,9 @@ bool Animation::BeginLoad(Deserializer& source)
 
 bool Animation::Save(Serializer& dest) const
 {
-    // Write ID, name and length
-    dest.WriteFileID("UANI");
+    // Write ID, name and length. The version 2 format is only used when there are compressed tracks
+    bool hasCompressedTracks = IsCompressed();
+    dest.WriteFileID(hasCompressedTracks ? "UAN2" : "UANI");
     dest.WriteString(animationName_);
     dest.WriteFloat(length_);
 
@@ -225,19 +492,46 @@ bool Animation::Save(Serializer& dest) const
         const AnimationTrack& track = i->second_;
         dest.WriteString(track.name_);
         dest.WriteUByte(track.channelMask_);
-        dest.WriteUInt(track.keyFrames_.Size());
+        if (hasCompressedTracks)
+            dest.WriteBool(track.IsCompressed());
 
-        // Write keyframes of the track
-        for (auto j = 0u; j < track.keyFrames_.Size(); ++j)
+        if (track.IsCompressed())
         {
-            const AnimationKeyFrame& keyFrame = track.keyFrames_[j];
-            dest.WriteFloat(keyFrame.time_);
+            // Write quantized keyframe data of a compressed track
+            unsigned keyFrames = track.compressedTimes_.Size();
+            dest.WriteUInt(keyFrames);
+            dest.Write(track.compressedTimes_.Buffer(), keyFrames * sizeof(float));
             if (track.channelMask_ & CHANNEL_POSITION)
-                dest.WriteVector3(keyFrame.position_);
+            {
+                dest.WriteVector3(track.positionMin_);
+                dest.WriteVector3(track.positionStep_);
+                dest.Write(track.compressedPositions_.Buffer(), keyFrames * 3 * sizeof(unsigned short));
+            }
             if (track.channelMask_ & CHANNEL_ROTATION)
-                dest.WriteQuaternion(keyFrame.rotation_);
+                dest.Write(track.compressedRotations_.Buffer(), keyFrames * 3 * sizeof(unsigned short));
             if (track.channelMask_ & CHANNEL_SCALE)
-                dest.WriteVector3(keyFrame.scale_);
+            {
+                dest.WriteVector3(track.scaleMin_);
+                dest.WriteVector3(track.scaleStep_);
+                dest.Write(track.compressedScales_.Buffer(), keyFrames * 3 * sizeof(unsigned short));
+            }
+        }
+        else
+        {
+            dest.WriteUInt(track.keyFrames_.Size());
+
+            // Write keyframes of the track
+            for (auto j = 0u; j < track.keyFrames_.Size(); ++j)
+            {
+                const AnimationKeyFrame& keyFrame = track.keyFrames_[j];
+                dest.WriteFloat(keyFrame.time_);
+                if (track.channelMask_ & CHANNEL_POSITION)
+                    dest.WriteVector3(keyFrame.position_);
+                if (track.channelMask_ & CHANNEL_ROTATION)
+                    dest.WriteQuaternion(keyFrame.rotation_);
+                if (track.channelMask_ & CHANNEL_SCALE)
+                    dest.WriteVector3(keyFrame.scale_);
+            }
         }
     }
 
@@ -366,6 +660,29 @@ SharedPtr<Animation> Animation::Clone(const String &cloneName) const
     ret->SetMemoryUse(GetMemoryUse());
     
     return ret;
+}
+
+void Animation::Compress(float positionTolerance, float rotationTolerance, float scaleTolerance)
+{
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+        i->second_.Compress(positionTolerance, rotationTolerance, scaleTolerance);
+}
+
+void Animation::Decompress()
+{
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+        i->second_.Decompress();
+}
+
+bool Animation::IsCompressed() const
+{
+    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        if (i->second_.IsCompressed())
+            return true;
+    }
+
+    return false;
 } 
 
 AnimationTrack* Animation::GetTrack(unsigned index) 
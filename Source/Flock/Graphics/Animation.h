@@ -50,6 +50,13 @@ struct AnimationKeyFrame
     Vector3 scale_;
 };
 
+/// Default maximum position error in keyframe reduction when compressing animation tracks.
+static const float DEFAULT_POSITION_TOLERANCE = 0.001f;
+/// Default maximum rotation error in degrees in keyframe reduction when compressing animation tracks.
+static const float DEFAULT_ROTATION_TOLERANCE = 0.1f;
+/// Default maximum scale error in keyframe reduction when compressing animation tracks.
+static const float DEFAULT_SCALE_TOLERANCE = 0.001f;
+
 /// Skeletal animation track, stores keyframes of a single bone.
 struct FLOCKSDK_API AnimationTrack
 {
@@ -59,7 +66,7 @@ struct FLOCKSDK_API AnimationTrack
     {
     }
 
-    /// Assign keyframe at index.
+    /// Assign keyframe at index. Keyframes can be edited only when the track is not compressed.
     void SetKeyFrame(unsigned index, const AnimationKeyFrame& command);
     /// Add a keyframe at the end.
     void AddKeyFrame(const AnimationKeyFrame& keyFrame);
@@ -69,13 +76,26 @@ struct FLOCKSDK_API AnimationTrack
     void RemoveKeyFrame(unsigned index);
     /// Remove all keyframes.
     void RemoveAllKeyFrames();
+    /// Compress the track. Keyframes that can be interpolated from their neighbours within the error tolerances are removed, and the rest are quantized: positions and scales to 16-bit fixed point within the track's bounds, and rotations to the smallest three components at 15 bits each.
+    void Compress(float positionTolerance = DEFAULT_POSITION_TOLERANCE, float rotationTolerance = DEFAULT_ROTATION_TOLERANCE,
+        float scaleTolerance = DEFAULT_SCALE_TOLERANCE);
+    /// Decompress the track back to full precision keyframes. Modifies the track, so it must not be called while the animation is sampled in worker threads.
+    void Decompress();
 
-    /// Return keyframe at index, or null if not found.
+    /// Return keyframe at index for editing, or null if not found or the track is compressed.
     AnimationKeyFrame* GetKeyFrame(unsigned index);
+    /// Return a copy of the keyframe at index, decoded if the track is compressed. Does not modify the track.
+    AnimationKeyFrame GetDecodedKeyFrame(unsigned index) const;
     /// Return number of keyframes.
-    unsigned GetNumKeyFrames() const { return keyFrames_.Size(); }
+    unsigned GetNumKeyFrames() const { return IsCompressed() ? compressedTimes_.Size() : keyFrames_.Size(); }
     /// Return keyframe index based on time and previous index.
     void GetKeyFrameIndex(float time, unsigned& index) const;
+    /// Return keyframe time at index.
+    float GetKeyFrameTime(unsigned index) const { return IsCompressed() ? compressedTimes_[index] : keyFrames_[index].time_; }
+    /// Return whether the track is compressed.
+    bool IsCompressed() const { return !compressedTimes_.Empty(); }
+    /// Decode a keyframe of a compressed track. Only the channels included in the track are written.
+    void DecodeKeyFrame(unsigned index, AnimationKeyFrame& dest) const;
 
     /// Bone or scene node name.
     String name_;
@@ -83,8 +103,28 @@ struct FLOCKSDK_API AnimationTrack
     StringHash nameHash_;
     /// Bitmask of included data (position, rotation, scale.)
     unsigned char channelMask_;
-    /// Keyframes.
+    /// Keyframes. Empty if the track is compressed.
     Vector<AnimationKeyFrame> keyFrames_;
+    /// Keyframe times of a compressed track. Empty if the track is not compressed.
+    PODVector<float> compressedTimes_;
+    /// Quantized positions of a compressed track, 3 values per keyframe.
+    PODVector<unsigned short> compressedPositions_;
+    /// Quantized rotations of a compressed track in smallest three encoding, 3 values per keyframe.
+    PODVector<unsigned short> compressedRotations_;
+    /// Quantized scales of a compressed track, 3 values per keyframe.
+    PODVector<unsigned short> compressedScales_;
+    /// Minimum position of a compressed track.
+    Vector3 positionMin_;
+    /// Position quantization step of a compressed track.
+    Vector3 positionStep_;
+    /// Minimum scale of a compressed track.
+    Vector3 scaleMin_;
+    /// Scale quantization step of a compressed track.
+    Vector3 scaleStep_;
+
+private:
+    /// Return whether keyframes can be edited, and log an error if the track is compressed.
+    bool CheckEditable() const;
 };
 
 /// %Animation trigger point.
@@ -148,6 +188,11 @@ public:
     void SetNumTriggers(unsigned num);
     /// Clone the animation.
     SharedPtr<Animation> Clone(const String &cloneName = String::EMPTY) const;
+    /// Compress all tracks with keyframe reduction using the given error tolerances and quantization. Compressed animations are saved in the version 2 format.
+    void Compress(float positionTolerance = DEFAULT_POSITION_TOLERANCE, float rotationTolerance = DEFAULT_ROTATION_TOLERANCE,
+        float scaleTolerance = DEFAULT_SCALE_TOLERANCE);
+    /// Decompress all tracks back to full precision keyframes. Must be called from the main thread while the animation is not being played, as AnimationState samples tracks in worker threads.
+    void Decompress();
 
     /// Return animation name.
     const String &GetAnimationName() const { return animationName_; }
@@ -181,6 +226,9 @@ public:
     /// Return a trigger point by index.
     AnimationTriggerPoint* GetTrigger(unsigned index);
 
+    /// Return whether any track is compressed.
+    bool IsCompressed() const;
+
 private:
     /// Animation name.
     String animationName_;
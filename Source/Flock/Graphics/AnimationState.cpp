@@ -36,6 +36,7 @@ namespace FlockSDK
 AnimationStateTrack::AnimationStateTrack() :
     track_(0),
     bone_(0),
+    boneIndex_(0),
     weight_(1.0f),
     keyFrame_(0)
 {
@@ -153,6 +154,7 @@ void AnimationState::SetStartBone(Bone* startBone)
         if (trackBone && trackBone->node_)
         {
             stateTrack.bone_ = trackBone;
+            stateTrack.boneIndex_ = (unsigned)(trackBone - &skeleton.GetModifiableBones()[0]);
             stateTrack.node_ = trackBone->node_;
             stateTracks_.Push(stateTrack);
         }
@@ -478,21 +480,94 @@ void AnimationState::ApplyToNodes()
         ApplyTrack(*i, 1.0f, false);
 }
 
+void AnimationState::ApplyToPose(Vector3* positions, Quaternion* rotations, Vector3* scales)
+{
+    if (!model_ || !animation_ || !IsEnabled())
+        return;
+
+    for (Vector<AnimationStateTrack>::Iterator i = stateTracks_.Begin(); i != stateTracks_.End(); ++i)
+    {
+        AnimationStateTrack& stateTrack = *i;
+        float finalWeight = weight_ * stateTrack.weight_;
+
+        // Do not apply if zero effective weight or the bone has animation disabled
+        if (Equals(finalWeight, 0.0f) || !stateTrack.bone_->animated_)
+            continue;
+        // Skip bones that are dropped at the model's current animation LOD level
+        if (stateTrack.bone_->maxAnimationLod_ < model_->GetAnimationLod())
+            continue;
+
+        Vector3 newPosition;
+        Quaternion newRotation;
+        Vector3 newScale;
+        if (!SampleTrack(stateTrack, newPosition, newRotation, newScale))
+            continue;
+
+        unsigned boneIndex = stateTrack.boneIndex_;
+        unsigned char channelMask = stateTrack.track_->channelMask_;
+        BlendTrack(stateTrack, finalWeight, positions[boneIndex], rotations[boneIndex], scales[boneIndex], newPosition, newRotation,
+            newScale);
+
+        if (channelMask & CHANNEL_POSITION)
+            positions[boneIndex] = newPosition;
+        if (channelMask & CHANNEL_ROTATION)
+            rotations[boneIndex] = newRotation;
+        if (channelMask & CHANNEL_SCALE)
+            scales[boneIndex] = newScale;
+    }
+}
+
 void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent)
 {
-    const AnimationTrack* track = stateTrack.track_;
     Node* node = stateTrack.node_;
+    if (!node)
+        return;
 
-    if (track->keyFrames_.Empty() || !node)
+    Vector3 newPosition;
+    Quaternion newRotation;
+    Vector3 newScale;
+    if (!SampleTrack(stateTrack, newPosition, newRotation, newScale))
         return;
 
+    unsigned char channelMask = stateTrack.track_->channelMask_;
+    BlendTrack(stateTrack, weight, node->GetPosition(), node->GetRotation(), node->GetScale(), newPosition, newRotation, newScale);
+
+    if (silent)
+    {
+        if (channelMask & CHANNEL_POSITION)
+            node->SetPositionSilent(newPosition);
+        if (channelMask & CHANNEL_ROTATION)
+            node->SetRotationSilent(newRotation);
+        if (channelMask & CHANNEL_SCALE)
+            node->SetScaleSilent(newScale);
+    }
+    else
+    {
+        if (channelMask & CHANNEL_POSITION)
+            node->SetPosition(newPosition);
+        if (channelMask & CHANNEL_ROTATION)
+            node->SetRotation(newRotation);
+        if (channelMask & CHANNEL_SCALE)
+            node->SetScale(newScale);
+    }
+}
+
+bool AnimationState::SampleTrack(AnimationStateTrack& stateTrack, Vector3& newPosition, Quaternion& newRotation, Vector3& newScale)
+{
+    const AnimationTrack* track = stateTrack.track_;
+
+    unsigned numKeyFrames = track->GetNumKeyFrames();
+    if (!numKeyFrames)
+        return false;
+
+    // The keyframe index is kept per track, so that sequential playback only needs to step the index forward
     unsigned& frame = stateTrack.keyFrame_;
     track->GetKeyFrameIndex(time_, frame);
 
     // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
     unsigned nextFrame = frame + 1;
     bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.Size())
+    if (nextFrame >= numKeyFrames)
     {
         if (!looped_)
         {
@@ -503,16 +578,21 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
             nextFrame = 0;
     }
 
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
-    unsigned char channelMask = track->channelMask_;
+    // Decode the keyframes of a compressed track
+    bool compressed = track->IsCompressed();
+    AnimationKeyFrame decodedKeyFrame;
+    AnimationKeyFrame decodedNextKeyFrame;
+    if (compressed)
+        track->DecodeKeyFrame(frame, decodedKeyFrame);
 
-    Vector3 newPosition;
-    Quaternion newRotation;
-    Vector3 newScale;
+    const AnimationKeyFrame* keyFrame = compressed ? &decodedKeyFrame : &track->keyFrames_[frame];
+    unsigned char channelMask = track->channelMask_;
 
     if (interpolate)
     {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
+        if (compressed)
+            track->DecodeKeyFrame(nextFrame, decodedNextKeyFrame);
+        const AnimationKeyFrame* nextKeyFrame = compressed ? &decodedNextKeyFrame : &track->keyFrames_[nextFrame];
         float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
         if (timeInterval < 0.0f)
             timeInterval += animation_->GetLength();
@@ -534,25 +614,33 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
         if (channelMask & CHANNEL_SCALE)
             newScale = keyFrame->scale_;
     }
-    
+
+    return true;
+}
+
+void AnimationState::BlendTrack(const AnimationStateTrack& stateTrack, float weight, const Vector3& position,
+    const Quaternion& rotation, const Vector3& scale, Vector3& newPosition, Quaternion& newRotation, Vector3& newScale) const
+{
+    unsigned char channelMask = stateTrack.track_->channelMask_;
+
     if (blendingMode_ == ABM_ADDITIVE) // not ABM_LERP
     {
         if (channelMask & CHANNEL_POSITION)
         {
             Vector3 delta = newPosition - stateTrack.bone_->initialPosition_;
-            newPosition = node->GetPosition() + delta * weight;
+            newPosition = position + delta * weight;
         }
         if (channelMask & CHANNEL_ROTATION)
         {
             Quaternion delta = newRotation * stateTrack.bone_->initialRotation_.Inverse();
-            newRotation = (delta * node->GetRotation()).Normalized();
+            newRotation = (delta * rotation).Normalized();
             if (!Equals(weight, 1.0f))
-                newRotation = node->GetRotation().Slerp(newRotation, weight);
+                newRotation = rotation.Slerp(newRotation, weight);
         }
         if (channelMask & CHANNEL_SCALE)
         {
             Vector3 delta = newScale - stateTrack.bone_->initialScale_;
-            newScale = node->GetScale() + delta * weight;
+            newScale = scale + delta * weight;
         }
     }
     else
@@ -560,32 +648,13 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
         if (!Equals(weight, 1.0f)) // not full weight
         {
             if (channelMask & CHANNEL_POSITION)
-                newPosition = node->GetPosition().Lerp(newPosition, weight);
+                newPosition = position.Lerp(newPosition, weight);
             if (channelMask & CHANNEL_ROTATION)
-                newRotation = node->GetRotation().Slerp(newRotation, weight);
+                newRotation = rotation.Slerp(newRotation, weight);
             if (channelMask & CHANNEL_SCALE)
-                newScale = node->GetScale().Lerp(newScale, weight);
+                newScale = scale.Lerp(newScale, weight);
         }
     }
-    
-    if (silent)
-    {
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPositionSilent(newPosition);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotationSilent(newRotation);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScaleSilent(newScale);
-    }
-    else
-    {
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPosition(newPosition);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotation(newRotation);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScale(newScale);
-    }
 }
 
 }
@@ -57,6 +57,8 @@ struct AnimationStateTrack
     const AnimationTrack* track_;
     /// Bone pointer.
     Bone* bone_;
+    /// Bone index in the skeleton (model mode.)
+    unsigned boneIndex_;
     /// Scene node pointer.
     WeakPtr<Node> node_;
     /// Blending weight.
@@ -144,6 +146,8 @@ public:
 
     /// Apply the animation at the current time position.
     void Apply();
+    /// Sample the animation at the current time position and blend it into a skeleton pose, indexed by bone. Model mode only. May be called from a worker thread.
+    void ApplyToPose(Vector3* positions, Quaternion* rotations, Vector3* scales);
 
 private:
     /// Apply animation to a skeleton. Transform changes are applied silently, so the model needs to dirty its root model afterward.
@@ -152,6 +156,11 @@ private:
     void ApplyToNodes();
     /// Apply track.
     void ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent);
+    /// Sample track at the current time position. Return false if the track has no keyframes.
+    bool SampleTrack(AnimationStateTrack& stateTrack, Vector3& newPosition, Quaternion& newRotation, Vector3& newScale);
+    /// Blend a sampled track transform with the current transform according to the blending mode and weight.
+    void BlendTrack(const AnimationStateTrack& stateTrack, float weight, const Vector3& position, const Quaternion& rotation,
+        const Vector3& scale, Vector3& newPosition, Quaternion& newRotation, Vector3& newScale) const;
 
     /// Animated model (model mode.)
     WeakPtr<AnimatedModel> model_;
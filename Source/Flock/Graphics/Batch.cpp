@@ -40,6 +40,33 @@
 namespace FlockSDK
 {
 
+/// Minimum number of batches to sort with a radix sort instead of a comparison sort. Below this the fixed cost of the digit passes outweighs the gain, see the Benchmark tool.
+static const unsigned RADIX_SORT_MIN_BATCHES = 2048;
+/// Number of 8-bit radix sort digits: 8 for the state sort key, 4 for the distance and 1 for the render order.
+static const unsigned NUM_SORT_DIGITS = 13;
+/// Radix sort digit order, least significant first, for distance-first sorting.
+static const unsigned distanceFirstDigits[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+/// Radix sort digit order, least significant first, for state-first sorting.
+static const unsigned stateFirstDigits[] = { 8, 9, 10, 11, 0, 1, 2, 3, 4, 5, 6, 7, 12 };
+
+inline unsigned FloatToSortableUInt(float value)
+{
+    unsigned bits;
+    memcpy(&bits, &value, sizeof bits);
+    // Flip all bits of negative values and only the sign bit of positive values, so that unsigned order equals float order
+    return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+}
+
+inline unsigned GetSortDigit(const BatchSortKey& key, unsigned digit)
+{
+    if (digit < 8)
+        return (unsigned)(key.sortKey_ >> (digit * 8)) & 0xff;
+    else if (digit < 12)
+        return (key.distance_ >> ((digit - 8) * 8)) & 0xff;
+    else
+        return key.renderOrder_;
+}
+
 void CalculateShadowMatrix(Matrix4& dest, LightBatchQueue* queue, unsigned split, Renderer* renderer)
 {
     Camera* shadowCamera = queue->shadowSplits_[split].shadowCamera_;
@@ -198,6 +225,9 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
             graphics->SetShaderParameter(VSP_SKINMATRICES, reinterpret_cast<const float*>(worldTransform_),
                 12 * numWorldTransforms_);
         }
+        // With the skinning palette, the world transform holds the palette offset of the bone matrices
+        else if (geometryType_ == GEOM_SKINPALETTE)
+            graphics->SetShaderParameter(VSP_SKINPALETTEOFFSET, worldTransform_->m00_);
         else
             graphics->SetShaderParameter(VSP_MODEL, *worldTransform_);
 
@@ -211,6 +241,10 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
         }
     }
 
+    // Set the skinning palette texture, which is shared by all skinned models of the frame
+    if (geometryType_ == GEOM_SKINPALETTE || geometryType_ == GEOM_SKINPALETTE_INSTANCED)
+        graphics->SetTexture(TU_SKINPALETTE, renderer->GetSkinPaletteTexture());
+
     // Set zone-related shader parameters
     BlendMode blend = graphics->GetBlendMode();
     // If the pass is additive, override fog color to black so that shaders do not need a separate additive path
@@ -568,7 +602,7 @@ void Batch::Draw(View* view, Camera* camera, bool allowDepthWrite) const
 void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
 {
     // Do not use up buffer space if not going to draw as instanced
-    if (geometryType_ != GEOM_INSTANCED)
+    if (geometryType_ != GEOM_INSTANCED && geometryType_ != GEOM_SKINPALETTE_INSTANCED)
         return;
 
     startIndex_ = freeIndex;
@@ -597,8 +631,11 @@ void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
     {
         // Draw as individual objects if instancing not supported or could not fill the instancing buffer
         VertexBuffer* instanceBuffer = renderer->GetInstancingBuffer();
-        if (!instanceBuffer || geometryType_ != GEOM_INSTANCED || startIndex_ == M_MAX_UNSIGNED)
+        bool instanced = geometryType_ == GEOM_INSTANCED || geometryType_ == GEOM_SKINPALETTE_INSTANCED;
+        if (!instanceBuffer || !instanced || startIndex_ == M_MAX_UNSIGNED)
         {
+            bool skinPalette = geometryType_ == GEOM_SKINPALETTE || geometryType_ == GEOM_SKINPALETTE_INSTANCED;
+
             Batch::Prepare(view, camera, false, allowDepthWrite);
 
             graphics->SetIndexBuffer(geometry_->GetIndexBuffer());
@@ -607,7 +644,12 @@ void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
             for (auto i = 0u; i < instances_.Size(); ++i)
             {
                 if (graphics->NeedParameterUpdate(SP_OBJECT, instances_[i].worldTransform_))
-                    graphics->SetShaderParameter(VSP_MODEL, *instances_[i].worldTransform_);
+                {
+                    if (skinPalette)
+                        graphics->SetShaderParameter(VSP_SKINPALETTEOFFSET, instances_[i].worldTransform_->m00_);
+                    else
+                        graphics->SetShaderParameter(VSP_MODEL, *instances_[i].worldTransform_);
+                }
 
                 graphics->Draw(geometry_->GetPrimitiveType(), geometry_->GetIndexStart(), geometry_->GetIndexCount(),
                     geometry_->GetVertexStart(), geometry_->GetVertexCount());
@@ -655,14 +697,7 @@ void BatchQueue::SortBackToFront()
     for (auto i = 0u; i < batches_.Size(); ++i)
         sortedBatches_[i] = &batches_[i];
 
-    Sort(sortedBatches_.Begin(), sortedBatches_.End(), [] (Batch* lhs, Batch* rhs) -> bool {
-        if (lhs->renderOrder_ != rhs->renderOrder_)
-            return lhs->renderOrder_ < rhs->renderOrder_;
-        else if (lhs->distance_ != rhs->distance_)
-            return lhs->distance_ > rhs->distance_;
-        else
-            return lhs->sortKey_ < rhs->sortKey_;
-    });
+    SortBatches(sortedBatches_, false, true);
 
     sortedBatchGroups_.Resize(batchGroups_.Size());
     
@@ -711,14 +746,7 @@ void BatchQueue::SortFrontToBack()
 
 void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
 {
-    Sort(batches.Begin(), batches.End(), [] (Batch* lhs, Batch* rhs) -> bool {
-        if (lhs->renderOrder_ != rhs->renderOrder_)
-            return lhs->renderOrder_ < rhs->renderOrder_;
-        else if (lhs->distance_ != rhs->distance_)
-            return lhs->distance_ < rhs->distance_;
-        else
-            return lhs->sortKey_ < rhs->sortKey_;
-    });
+    SortBatches(batches, false, false);
 
     unsigned freeShaderID = 0;
     unsigned short freeMaterialID = 0;
@@ -766,14 +794,103 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
     geometryRemapping_.Clear();
 
     // Finally sort again with the rewritten ID's
-    Sort(batches.Begin(), batches.End(), [] (Batch* lhs, Batch* rhs) -> bool {
-        if (lhs->renderOrder_ != rhs->renderOrder_)
-            return lhs->renderOrder_ < rhs->renderOrder_;
-        else if (lhs->sortKey_ != rhs->sortKey_)
-            return lhs->sortKey_ < rhs->sortKey_;
+    SortBatches(batches, true, false);
+}
+
+void BatchQueue::SortBatches(PODVector<Batch*>& batches, bool stateFirst, bool backToFront)
+{
+    unsigned numBatches = batches.Size();
+
+    if (numBatches < RADIX_SORT_MIN_BATCHES)
+    {
+        if (stateFirst)
+        {
+            Sort(batches.Begin(), batches.End(), [] (Batch* lhs, Batch* rhs) -> bool {
+                if (lhs->renderOrder_ != rhs->renderOrder_)
+                    return lhs->renderOrder_ < rhs->renderOrder_;
+                else if (lhs->sortKey_ != rhs->sortKey_)
+                    return lhs->sortKey_ < rhs->sortKey_;
+                else
+                    return lhs->distance_ < rhs->distance_;
+            });
+        }
+        else if (backToFront)
+        {
+            Sort(batches.Begin(), batches.End(), [] (Batch* lhs, Batch* rhs) -> bool {
+                if (lhs->renderOrder_ != rhs->renderOrder_)
+                    return lhs->renderOrder_ < rhs->renderOrder_;
+                else if (lhs->distance_ != rhs->distance_)
+                    return lhs->distance_ > rhs->distance_;
+                else
+                    return lhs->sortKey_ < rhs->sortKey_;
+            });
+        }
         else
-            return lhs->distance_ < rhs->distance_;
-    });
+        {
+            Sort(batches.Begin(), batches.End(), [] (Batch* lhs, Batch* rhs) -> bool {
+                if (lhs->renderOrder_ != rhs->renderOrder_)
+                    return lhs->renderOrder_ < rhs->renderOrder_;
+                else if (lhs->distance_ != rhs->distance_)
+                    return lhs->distance_ < rhs->distance_;
+                else
+                    return lhs->sortKey_ < rhs->sortKey_;
+            });
+        }
+        return;
+    }
+
+    sortKeys_.Resize(numBatches);
+    tempSortKeys_.Resize(numBatches);
+
+    // Gather the keys and the histograms of all digits in one pass
+    unsigned histograms[NUM_SORT_DIGITS][256];
+    memset(histograms, 0, sizeof histograms);
+
+    for (auto i = 0u; i < numBatches; ++i)
+    {
+        Batch* batch = batches[i];
+        BatchSortKey& key = sortKeys_[i];
+        key.sortKey_ = batch->sortKey_;
+        key.distance_ = FloatToSortableUInt(batch->distance_);
+        if (backToFront)
+            key.distance_ = ~key.distance_;
+        key.renderOrder_ = batch->renderOrder_;
+        key.batch_ = batch;
+
+        for (auto j = 0u; j < NUM_SORT_DIGITS; ++j)
+            ++histograms[j][GetSortDigit(key, j)];
+    }
+
+    // Least significant digit first; each pass is stable, so the more significant digits take precedence
+    const unsigned* digits = stateFirst ? stateFirstDigits : distanceFirstDigits;
+    BatchSortKey* src = sortKeys_.Buffer();
+    BatchSortKey* dest = tempSortKeys_.Buffer();
+
+    for (auto i = 0u; i < NUM_SORT_DIGITS; ++i)
+    {
+        unsigned digit = digits[i];
+        unsigned* histogram = histograms[digit];
+
+        // Skip the pass if all keys have the same value for this digit
+        if (histogram[GetSortDigit(src[0], digit)] == numBatches)
+            continue;
+
+        unsigned offset = 0;
+        for (auto j = 0u; j < 256; ++j)
+        {
+            unsigned count = histogram[j];
+            histogram[j] = offset;
+            offset += count;
+        }
+
+        for (auto j = 0u; j < numBatches; ++j)
+            dest[histogram[GetSortDigit(src[j], digit)]++] = src[j];
+
+        Swap(src, dest);
+    }
+
+    for (auto i = 0u; i < numBatches; ++i)
+        batches[i] = src[i].batch_;
 }
 
 void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
@@ -831,7 +948,7 @@ unsigned BatchQueue::GetNumInstances() const
 
     for (HashMap<BatchGroupKey, BatchGroup>::ConstIterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
     {
-        if (i->second_.geometryType_ == GEOM_INSTANCED)
+        if (i->second_.geometryType_ == GEOM_INSTANCED || i->second_.geometryType_ == GEOM_SKINPALETTE_INSTANCED)
             total += i->second_.instances_.Size();
     }
 
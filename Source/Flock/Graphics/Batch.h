@@ -197,6 +197,7 @@ struct BatchGroupKey
         pass_(batch.pass_),
         material_(batch.material_),
         geometry_(batch.geometry_),
+        geometryType_(batch.geometryType_),
         renderOrder_(batch.renderOrder_)
     {
     }
@@ -211,6 +212,8 @@ struct BatchGroupKey
     Material* material_;
     /// Geometry.
     Geometry* geometry_;
+    /// Instanced geometry type. Keeps static and skinned instances of the same geometry apart.
+    GeometryType geometryType_;
     /// 8-bit render order modifier from material.
     unsigned char renderOrder_;
 
@@ -218,20 +221,33 @@ struct BatchGroupKey
     bool operator ==(const BatchGroupKey& rhs) const
     {
         return zone_ == rhs.zone_ && lightQueue_ == rhs.lightQueue_ && pass_ == rhs.pass_ && material_ == rhs.material_ &&
-               geometry_ == rhs.geometry_ && renderOrder_ == rhs.renderOrder_;
+               geometry_ == rhs.geometry_ && geometryType_ == rhs.geometryType_ && renderOrder_ == rhs.renderOrder_;
     }
 
     /// Test for inequality with another batch group key.
     bool operator !=(const BatchGroupKey& rhs) const
     {
         return zone_ != rhs.zone_ || lightQueue_ != rhs.lightQueue_ || pass_ != rhs.pass_ || material_ != rhs.material_ ||
-               geometry_ != rhs.geometry_ || renderOrder_ != rhs.renderOrder_;
+               geometry_ != rhs.geometry_ || geometryType_ != rhs.geometryType_ || renderOrder_ != rhs.renderOrder_;
     }
 
     /// Return hash value.
     unsigned ToHash() const;
 };
 
+/// Batch sorting record for radix sorting.
+struct BatchSortKey
+{
+    /// State sorting key.
+    unsigned long long sortKey_;
+    /// Distance converted to an order-preserving unsigned integer.
+    unsigned distance_;
+    /// Render order.
+    unsigned renderOrder_;
+    /// Batch.
+    Batch* batch_;
+};
+
 /// Queue that contains both instanced and non-instanced draw calls.
 struct BatchQueue
 {
@@ -244,6 +260,8 @@ public:
     void SortFrontToBack();
     /// Sort batches front to back while also maintaining state sorting.
     void SortFrontToBack2Pass(PODVector<Batch*>& batches);
+    /// Sort batches by render order, then by distance and state, or by state and distance if stateFirst is set. Uses a radix sort for large queues.
+    void SortBatches(PODVector<Batch*>& batches, bool stateFirst, bool backToFront);
     /// Pre-set instance data of all groups. The vertex buffer must be big enough to hold all data.
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
     /// Draw.
@@ -269,6 +287,10 @@ public:
     PODVector<Batch*> sortedBatches_;
     /// Sorted instanced draw calls.
     PODVector<BatchGroup*> sortedBatchGroups_;
+    /// Radix sort records.
+    PODVector<BatchSortKey> sortKeys_;
+    /// Radix sort scratch records.
+    PODVector<BatchSortKey> tempSortKeys_;
     /// Maximum sorted instances.
     unsigned maxSortedInstances_;
     /// Whether the pass command contains extra shader defines.
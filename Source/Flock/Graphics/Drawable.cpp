@@ -41,6 +41,9 @@ namespace FlockSDK
 
 const char* GEOMETRY_CATEGORY = "Geometry";
 
+/// Number of frames after which the batches retained for a view that has not seen the drawable may be reused for another view.
+static const unsigned RETAINED_BATCHES_MAX_AGE = 64;
+
 SourceBatch::SourceBatch() :
     distance_(0.0f),
     geometry_(0),
@@ -100,6 +103,7 @@ Drawable::Drawable(Context* context, unsigned char drawableFlags) :
     maxZ_(0.0f),
     lodBias_(1.0f),
     basePassFlags_(0),
+    batchesVersion_(0),
     maxLights_(0),
     firstLight_(0)
 {
@@ -108,13 +112,16 @@ Drawable::Drawable(Context* context, unsigned char drawableFlags) :
 Drawable::~Drawable()
 {
     RemoveFromOctree();
+
+    for (PODVector<RetainedBatches*>::Iterator i = retainedBatches_.Begin(); i != retainedBatches_.End(); ++i)
+        delete *i;
 }
 
 void Drawable::RegisterObject(Context* context)
 {
     FLOCKSDK_ATTRIBUTE("Max Lights", int, maxLights_, 0, AM_DEFAULT);
     FLOCKSDK_ATTRIBUTE("View Mask", int, viewMask_, DEFAULT_VIEWMASK, AM_DEFAULT);
-    FLOCKSDK_ATTRIBUTE("Light Mask", int, lightMask_, DEFAULT_LIGHTMASK, AM_DEFAULT);
+    FLOCKSDK_ACCESSOR_ATTRIBUTE("Light Mask", GetLightMask, SetLightMask, unsigned, DEFAULT_LIGHTMASK, AM_DEFAULT);
     FLOCKSDK_ATTRIBUTE("Shadow Mask", int, shadowMask_, DEFAULT_SHADOWMASK, AM_DEFAULT);
     FLOCKSDK_ACCESSOR_ATTRIBUTE("Zone Mask", GetZoneMask, SetZoneMask, unsigned, DEFAULT_ZONEMASK, AM_DEFAULT);
 }
@@ -210,6 +217,9 @@ void Drawable::SetViewMask(unsigned mask)
 
 void Drawable::SetLightMask(unsigned mask)
 {
+    if (mask != lightMask_)
+        MarkBatchesChanged();
+
     lightMask_ = mask;
     MarkNetworkUpdate();
 }
@@ -296,6 +306,9 @@ bool Drawable::IsInView(const FrameInfo& frame, bool anyCamera) const
 
 void Drawable::SetZone(Zone* zone, bool temporary)
 {
+    if (zone != zone_)
+        MarkBatchesChanged();
+
     zone_ = zone;
 
     // If the zone assignment was temporary (inconclusive) set the dirty flag so that it will be re-evaluated on the next frame
@@ -333,6 +346,36 @@ void Drawable::MarkInView(unsigned frameNumber)
     }
 }
 
+RetainedBatches* Drawable::GetRetainedBatches(unsigned viewID, unsigned frameNumber)
+{
+    RetainedBatches* oldest = 0;
+
+    for (PODVector<RetainedBatches*>::ConstIterator i = retainedBatches_.Begin(); i != retainedBatches_.End(); ++i)
+    {
+        RetainedBatches* retained = *i;
+        if (retained->viewID_ == viewID)
+        {
+            retained->frameNumber_ = frameNumber;
+            return retained;
+        }
+        if (!oldest || retained->frameNumber_ < oldest->frameNumber_)
+            oldest = retained;
+    }
+
+    // Reuse the batches of a view that has not seen the drawable for a while, so that views which no longer exist
+    // do not leave their batches behind
+    if (oldest && frameNumber - oldest->frameNumber_ > RETAINED_BATCHES_MAX_AGE)
+        *oldest = RetainedBatches(viewID);
+    else
+    {
+        oldest = new RetainedBatches(viewID);
+        retainedBatches_.Push(oldest);
+    }
+
+    oldest->frameNumber_ = frameNumber;
+    return oldest;
+}
+
 void Drawable::LimitLights()
 {
     // Maximum lights value 0 means unlimited
@@ -48,7 +48,9 @@ class Light;
 class Material;
 class OcclusionBuffer;
 class Octant;
+class Pass;
 class RayOctreeQuery;
+class Technique;
 class Zone;
 struct RayQueryResult;
 struct WorkItem;
@@ -58,7 +60,8 @@ enum UpdateGeometryType
 {
     UPDATE_NONE = 0,
     UPDATE_MAIN_THREAD,
-    UPDATE_WORKER_THREAD
+    UPDATE_WORKER_THREAD,
+    UPDATE_WORKER_THREAD_UPLOAD
 };
 
 /// Rendering frame update parameters.
@@ -103,6 +106,75 @@ struct FLOCKSDK_API SourceBatch
     GeometryType geometryType_;
 };
 
+/// Scene pass batch retained by a view between frames.
+struct RetainedBatch
+{
+    /// Technique.
+    Technique* tech_;
+    /// Scene pass.
+    Pass* pass_;
+    /// Index of the drawable's source batch.
+    unsigned sourceIndex_;
+    /// Index of the view's batch queue.
+    unsigned queueIndex_;
+    /// Allow instancing flag.
+    bool allowInstancing_;
+};
+
+/// Material state of a source batch that retained scene pass batches were collected from.
+struct RetainedSourceBatch
+{
+    /// Material.
+    Material* material_;
+    /// Techniques version of the material.
+    unsigned materialVersion_;
+    /// Technique chosen for the material.
+    Technique* tech_;
+    /// Passes version of the technique.
+    unsigned techVersion_;
+};
+
+/// Scene pass batches of a drawable retained by a view between frames.
+struct RetainedBatches
+{
+    /// Construct for a view.
+    RetainedBatches(unsigned viewID) :
+        viewID_(viewID),
+        viewVersion_(0),
+        drawableVersion_(0),
+        zone_(0),
+        zoneVersion_(0),
+        lightMask_(0),
+        basePassFlags_(0),
+        frameNumber_(0),
+        valid_(false)
+    {
+    }
+
+    /// View ID.
+    unsigned viewID_;
+    /// Version of the view's scene passes.
+    unsigned viewVersion_;
+    /// Batches version of the drawable.
+    unsigned drawableVersion_;
+    /// Zone.
+    Zone* zone_;
+    /// Batches version of the zone.
+    unsigned zoneVersion_;
+    /// Light mask including the zone.
+    unsigned lightMask_;
+    /// Base pass flags.
+    unsigned basePassFlags_;
+    /// Frame number on which the batches were last used.
+    unsigned frameNumber_;
+    /// Collected batches valid flag.
+    bool valid_;
+    /// Material state of the source batches.
+    PODVector<RetainedSourceBatch> sourceBatches_;
+    /// Collected scene pass batches.
+    PODVector<RetainedBatch> batches_;
+};
+
 /// Base class for visible components.
 class FLOCKSDK_API Drawable : public Component
 {
@@ -130,9 +202,13 @@ public:
     virtual void UpdateBatches(const FrameInfo& frame);
     /// Prepare geometry for rendering.
     virtual void UpdateGeometry(const FrameInfo& frame) { }
+    /// Upload geometry prepared in a worker thread to the GPU. Called from the main thread for drawables that reported UPDATE_WORKER_THREAD_UPLOAD.
+    virtual void UploadGeometry(const FrameInfo& frame) { }
 
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     virtual UpdateGeometryType GetUpdateGeometryType() { return UPDATE_NONE; }
+    /// Return whether the scene pass batches only depend on the materials, zone and light mask, so that views may retain them between frames.
+    virtual bool HasStaticBatches() const { return false; }
 
     /// Return the geometry for a specific LOD level.
     virtual Geometry* GetLodGeometry(unsigned batchIndex, unsigned level);
@@ -243,6 +319,10 @@ public:
 
     /// Set base pass flag for a batch.
     void SetBasePass(unsigned batchIndex) { basePassFlags_ |= (1 << batchIndex); }
+    /// Mark the zone or light mask changed, so that views collect the retained scene pass batches again.
+    void MarkBatchesChanged() { ++batchesVersion_; }
+    /// Return the scene pass batches retained for a view, creating them if necessary. Called by View from the worker thread that collects the drawable's batches.
+    RetainedBatches* GetRetainedBatches(unsigned viewID, unsigned frameNumber);
 
     /// Return octree octant.
     Octant* GetOctant() const { return octant_; }
@@ -268,6 +348,12 @@ public:
     /// Return whether has a base pass.
     bool HasBasePass(unsigned batchIndex) const { return (basePassFlags_ & (1 << batchIndex)) != 0; }
 
+    /// Return base pass flags of all batches.
+    unsigned GetBasePassFlags() const { return basePassFlags_; }
+
+    /// Return the batches version, which changes with the zone and light mask.
+    unsigned GetBatchesVersion() const { return batchesVersion_; }
+
     /// Return per-pixel lights.
     const PODVector<Light*>& GetLights() const { return lights_; }
 
@@ -374,6 +460,8 @@ protected:
     float lodBias_;
     /// Base pass flags, bit per batch.
     unsigned basePassFlags_;
+    /// Batches version.
+    unsigned batchesVersion_;
     /// Maximum per-pixel lights.
     unsigned maxLights_;
     /// List of cameras from which is seen on the current frame.
@@ -384,6 +472,8 @@ protected:
     PODVector<Light*> lights_;
     /// Per-vertex lights affecting this drawable.
     PODVector<Light*> vertexLights_;
+    /// Scene pass batches retained by views.
+    PODVector<RetainedBatches*> retainedBatches_;
 };
 
 inline bool CompareDrawables(Drawable* lhs, Drawable* rhs)
@@ -57,6 +57,7 @@ extern FLOCKSDK_API const StringHash VSP_VOFFSET("VOffset");
 extern FLOCKSDK_API const StringHash VSP_ZONE("Zone");
 extern FLOCKSDK_API const StringHash VSP_LIGHTMATRICES("LightMatrices");
 extern FLOCKSDK_API const StringHash VSP_SKINMATRICES("SkinMatrices");
+extern FLOCKSDK_API const StringHash VSP_SKINPALETTEOFFSET("SkinPaletteOffset");
 extern FLOCKSDK_API const StringHash VSP_VERTEXLIGHTS("VertexLights");
 extern FLOCKSDK_API const StringHash PSP_AMBIENTCOLOR("AmbientColor");
 extern FLOCKSDK_API const StringHash PSP_CAMERAPOS("CameraPosPS");
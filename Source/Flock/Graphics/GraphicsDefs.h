@@ -54,9 +54,11 @@ enum GeometryType
     GEOM_DIRBILLBOARD = 4,
     GEOM_TRAIL_FACE_CAMERA = 5,
     GEOM_TRAIL_BONE = 6,
-    MAX_GEOMETRYTYPES = 7,
+    GEOM_SKINPALETTE = 7,
+    GEOM_SKINPALETTE_INSTANCED = 8,
+    MAX_GEOMETRYTYPES = 9,
     // This is not a real geometry type for VS, but used to mark objects that do not desire to be instanced
-    GEOM_STATIC_NOINSTANCING = 7,
+    GEOM_STATIC_NOINSTANCING = 9,
 };
 
 /// Blending mode.
@@ -331,8 +333,9 @@ enum TextureUnit
     TU_DEPTHBUFFER = 13,
     TU_LIGHTBUFFER = 14,
     TU_ZONE = 15,
+    TU_SKINPALETTE = 16,
     MAX_MATERIAL_TEXTURE_UNITS = 8,
-    MAX_TEXTURE_UNITS = 16
+    MAX_TEXTURE_UNITS = 17
 #else
     TU_LIGHTRAMP = 5,
     TU_LIGHTSHAPE = 6,
@@ -390,6 +393,7 @@ extern FLOCKSDK_API const StringHash VSP_VOFFSET;
 extern FLOCKSDK_API const StringHash VSP_ZONE;
 extern FLOCKSDK_API const StringHash VSP_LIGHTMATRICES;
 extern FLOCKSDK_API const StringHash VSP_SKINMATRICES;
+extern FLOCKSDK_API const StringHash VSP_SKINPALETTEOFFSET;
 extern FLOCKSDK_API const StringHash VSP_VERTEXLIGHTS;
 extern FLOCKSDK_API const StringHash PSP_AMBIENTCOLOR;
 extern FLOCKSDK_API const StringHash PSP_CAMERAPOS;
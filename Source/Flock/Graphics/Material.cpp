@@ -69,6 +69,7 @@ static const char* textureUnitNames[] =
     "depth",
     "light",
     "zone",
+    "skinpalette",
     0
 #else
     "lightramp",
@@ -200,6 +201,7 @@ void ShaderParameterAnimationInfo::ApplyValue(const Variant &newValue)
 Material::Material(Context* context) :
     Resource(context),
     auxViewFrameNumber_(0),
+    techniquesVersion_(0),
     shaderParameterHash_(0),
     alphaToCoverage_(false),
     lineAntiAlias_(false),
@@ -932,6 +934,7 @@ void Material::SetNumTechniques(unsigned num)
         return;
 
     techniques_.Resize(num);
+    ++techniquesVersion_;
     RefreshMemoryUse();
 }
 
@@ -941,6 +944,7 @@ void Material::SetTechnique(unsigned index, Technique* tech, unsigned qualityLev
         return;
 
     techniques_[index] = TechniqueEntry(tech, qualityLevel, lodDistance);
+    ++techniquesVersion_;
     ApplyShaderDefines(index);
 }
 
@@ -1188,6 +1192,7 @@ void Material::SortTechniques()
         else
             return lhs.qualityLevel_ > rhs.qualityLevel_;
     });
+    ++techniquesVersion_;
 }
 
 void Material::MarkForAuxView(unsigned frameNumber)
@@ -1396,6 +1401,7 @@ void Material::ApplyShaderDefines(unsigned index)
         techniques_[index].technique_ = techniques_[index].original_;
     else
         techniques_[index].technique_ = techniques_[index].original_->CloneWithDefines(vertexShaderDefines_, pixelShaderDefines_);
+    ++techniquesVersion_;
 }
 
 }
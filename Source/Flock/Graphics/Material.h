@@ -190,6 +190,9 @@ public:
     /// Return all techniques.
     const Vector<TechniqueEntry>& GetTechniques() const { return techniques_; }
 
+    /// Return the techniques version, which changes when the techniques are set, sorted or cloned with shader defines.
+    unsigned GetTechniquesVersion() const { return techniquesVersion_; }
+
     /// Return technique entry by index.
     const TechniqueEntry& GetTechniqueEntry(unsigned index) const;
     /// Return technique by index.
@@ -305,6 +308,8 @@ private:
     unsigned char renderOrder_;
     /// Last auxiliary view rendered frame number.
     unsigned auxViewFrameNumber_;
+    /// Techniques version.
+    unsigned techniquesVersion_;
     /// Shader parameter hash value.
     unsigned shaderParameterHash_;
     /// Alpha-to-coverage flag.
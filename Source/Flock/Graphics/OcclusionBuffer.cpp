@@ -40,11 +40,11 @@ static const unsigned CLIPMASK_Y_NEG = 0x8;
 static const unsigned CLIPMASK_Z_POS = 0x10;
 static const unsigned CLIPMASK_Z_NEG = 0x20;
 
-void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
+void DrawOcclusionBatchWork(unsigned start, unsigned end, unsigned threadIndex, void* data)
 {
-    OcclusionBuffer* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
-    OcclusionBatch& batch = *reinterpret_cast<OcclusionBatch*>(item->start_);
-    buffer->DrawBatch(batch, threadIndex);
+    OcclusionBuffer* buffer = reinterpret_cast<OcclusionBuffer*>(data);
+    for (unsigned i = start; i < end; ++i)
+        buffer->DrawBatch(buffer->batches_[i], threadIndex);
 }
 
 OcclusionBuffer::OcclusionBuffer(Context* context) :
@@ -217,19 +217,7 @@ void OcclusionBuffer::DrawTriangles()
     else if (buffers_.Size() > 1)
     {
         // Threaded
-        WorkQueue* queue = GetSubsystem<WorkQueue>();
-
-        for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = DrawOcclusionBatchWork;
-            item->aux_ = this;
-            item->start_ = &(*i);
-            queue->AddWorkItem(item);
-        }
-
-        queue->Complete(M_MAX_UNSIGNED);
+        GetSubsystem<WorkQueue>()->ParallelFor(batches_.Size(), DrawOcclusionBatchWork, this);
 
         MergeBuffers();
         depthHierarchyDirty_ = true;
@@ -90,6 +90,8 @@ class FLOCKSDK_API OcclusionBuffer : public Object
 {
     FLOCKSDK_OBJECT(OcclusionBuffer, Object);
 
+    friend void DrawOcclusionBatchWork(unsigned start, unsigned end, unsigned threadIndex, void* data);
+
 public:
     /// Construct.
     OcclusionBuffer(Context* context);
@@ -39,30 +39,38 @@ namespace FlockSDK
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
+static const float DEFAULT_OCTREE_LOOSENESS = 2.0f;
+static const float MIN_OCTREE_LOOSENESS = 1.25f;
+static const float MAX_OCTREE_LOOSENESS = 4.0f;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
-void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
+/// Minimum number of drawables to update per parallel range.
+static const unsigned UPDATE_DRAWABLES_GRAIN_SIZE = 16;
+
+void UpdateDrawablesWork(unsigned start, unsigned end, unsigned threadIndex, void* data)
 {
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    Drawable** start = reinterpret_cast<Drawable**>(item->start_);
-    Drawable** end = reinterpret_cast<Drawable**>(item->end_);
+    Octree* octree = reinterpret_cast<Octree*>(data);
+    const FrameInfo& frame = *octree->updateFrame_;
+    Drawable** drawables = &octree->drawableUpdates_[0];
 
-    while (start != end)
+    for (unsigned i = start; i < end; ++i)
     {
-        Drawable* drawable = *start;
+        Drawable* drawable = drawables[i];
         if (drawable)
             drawable->Update(frame);
-        ++start;
     }
 }
 
 Octant::Octant(const BoundingBox& box, unsigned level, Octant* parent, Octree* root, unsigned index) :
+    looseness_(parent ? parent->looseness_ : DEFAULT_OCTREE_LOOSENESS),
     level_(level),
     numDrawables_(0),
     parent_(parent),
     root_(root),
-    index_(index)
+    index_(index),
+    packedBoxStride_(0),
+    packedBoxesDirty_(false)
 {
     Initialize(box);
 
@@ -83,6 +91,9 @@ Octant::~Octant()
         }
         drawables_.Clear();
         numDrawables_ = 0;
+
+        if (packedBoxesDirty_)
+            root_->dirtyOctants_.Remove(this);
     }
 
     for (auto i = 0u; i < NUM_OCTANTS; ++i)
@@ -162,19 +173,19 @@ bool Octant::CheckDrawableFit(const BoundingBox& box) const
 {
     Vector3 boxSize = box.Size();
 
-    // If max split level, size always OK, otherwise check that box is at least half size of octant
-    if (level_ >= root_->GetNumLevels() || boxSize.x_ >= halfSize_.x_ || boxSize.y_ >= halfSize_.y_ ||
-        boxSize.z_ >= halfSize_.z_)
+    // If max split level, size always OK, otherwise check that box is not larger than a child octant's loose extent
+    if (level_ >= root_->GetNumLevels() || boxSize.x_ >= looseExtent_.x_ || boxSize.y_ >= looseExtent_.y_ ||
+        boxSize.z_ >= looseExtent_.z_)
         return true;
     // Also check if the box can not fit a child octant's culling box, in that case size OK (must insert here)
     else
     {
-        if (box.min_.x_ <= worldBoundingBox_.min_.x_ - 0.5f * halfSize_.x_ ||
-            box.max_.x_ >= worldBoundingBox_.max_.x_ + 0.5f * halfSize_.x_ ||
-            box.min_.y_ <= worldBoundingBox_.min_.y_ - 0.5f * halfSize_.y_ ||
-            box.max_.y_ >= worldBoundingBox_.max_.y_ + 0.5f * halfSize_.y_ ||
-            box.min_.z_ <= worldBoundingBox_.min_.z_ - 0.5f * halfSize_.z_ ||
-            box.max_.z_ >= worldBoundingBox_.max_.z_ + 0.5f * halfSize_.z_)
+        if (box.min_.x_ <= worldBoundingBox_.min_.x_ - 0.5f * looseExtent_.x_ ||
+            box.max_.x_ >= worldBoundingBox_.max_.x_ + 0.5f * looseExtent_.x_ ||
+            box.min_.y_ <= worldBoundingBox_.min_.y_ - 0.5f * looseExtent_.y_ ||
+            box.max_.y_ >= worldBoundingBox_.max_.y_ + 0.5f * looseExtent_.y_ ||
+            box.min_.z_ <= worldBoundingBox_.min_.z_ - 0.5f * looseExtent_.z_ ||
+            box.max_.z_ >= worldBoundingBox_.max_.z_ + 0.5f * looseExtent_.z_)
             return true;
     }
 
@@ -182,6 +193,49 @@ bool Octant::CheckDrawableFit(const BoundingBox& box) const
     return false;
 }
 
+void Octant::MarkPackedBoxesDirty()
+{
+    if (!packedBoxesDirty_)
+    {
+        packedBoxesDirty_ = true;
+        if (root_)
+            root_->dirtyOctants_.Push(this);
+    }
+}
+
+void Octant::UpdatePackedBoxes()
+{
+    unsigned numDrawables = drawables_.Size();
+    packedBoxStride_ = (numDrawables + 7) & ~7u;
+    packedBoxes_.Resize(packedBoxStride_ * 6);
+
+    float* centerX = packedBoxes_.Buffer();
+    float* centerY = centerX + packedBoxStride_;
+    float* centerZ = centerY + packedBoxStride_;
+    float* halfSizeX = centerZ + packedBoxStride_;
+    float* halfSizeY = halfSizeX + packedBoxStride_;
+    float* halfSizeZ = halfSizeY + packedBoxStride_;
+
+    for (auto i = 0u; i < numDrawables; ++i)
+    {
+        const BoundingBox& box = drawables_[i]->GetWorldBoundingBox();
+        Vector3 center = box.Center();
+        Vector3 halfSize = center - box.min_;
+        centerX[i] = center.x_;
+        centerY[i] = center.y_;
+        centerZ[i] = center.z_;
+        halfSizeX[i] = halfSize.x_;
+        halfSizeY[i] = halfSize.y_;
+        halfSizeZ[i] = halfSize.z_;
+    }
+
+    // Zero the padding so that the SIMD tests never read uninitialized values
+    for (auto i = numDrawables; i < packedBoxStride_; ++i)
+        centerX[i] = centerY[i] = centerZ[i] = halfSizeX[i] = halfSizeY[i] = halfSizeZ[i] = 0.0f;
+
+    packedBoxesDirty_ = false;
+}
+
 void Octant::ResetRoot()
 {
     root_ = 0;
@@ -216,7 +270,8 @@ void Octant::Initialize(const BoundingBox& box)
     worldBoundingBox_ = box;
     center_ = box.Center();
     halfSize_ = 0.5f * box.Size();
-    cullingBox_ = BoundingBox(worldBoundingBox_.min_ - halfSize_, worldBoundingBox_.max_ + halfSize_);
+    looseExtent_ = (looseness_ - 1.0f) * halfSize_;
+    cullingBox_ = BoundingBox(worldBoundingBox_.min_ - looseExtent_, worldBoundingBox_.max_ + looseExtent_);
 }
 
 void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
@@ -237,7 +292,11 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     {
         Drawable** start = const_cast<Drawable**>(&drawables_[0]);
         Drawable** end = start + drawables_.Size();
-        query.TestDrawables(start, end, inside);
+        // Packed bounding boxes are only valid between the octree update and the next drawable change
+        if (!inside && !packedBoxesDirty_)
+            query.TestPackedDrawables(start, end, packedBoxes_.Buffer(), packedBoxStride_, inside);
+        else
+            query.TestDrawables(start, end, inside);
     }
 
     for (auto i = 0u; i < NUM_OCTANTS; ++i)
@@ -304,6 +363,7 @@ void Octant::GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*
 Octree::Octree(Context* context) :
     Component(context),
     Octant(BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), 0, 0, this),
+    updateFrame_(0),
     numLevels_(DEFAULT_OCTREE_LEVELS)
 {
     // If the engine is running headless, subscribe to RenderUpdate events for manually updating the octree
@@ -316,6 +376,7 @@ Octree::~Octree()
 {
     // Reset root pointer from all child octants now so that they do not move their drawables to root
     drawableUpdates_.Clear();
+    dirtyOctants_.Clear();
     ResetRoot();
 }
 
@@ -329,12 +390,14 @@ void Octree::RegisterObject(Context* context)
     FLOCKSDK_ATTRIBUTE("Bounding Box Min", Vector3, worldBoundingBox_.min_, defaultBoundsMin, AM_DEFAULT);
     FLOCKSDK_ATTRIBUTE("Bounding Box Max", Vector3, worldBoundingBox_.max_, defaultBoundsMax, AM_DEFAULT);
     FLOCKSDK_ATTRIBUTE("Number of Levels", int, numLevels_, DEFAULT_OCTREE_LEVELS, AM_DEFAULT);
+    FLOCKSDK_ATTRIBUTE("Looseness", float, looseness_, DEFAULT_OCTREE_LOOSENESS, AM_DEFAULT);
 }
 
 void Octree::OnSetAttribute(const AttributeInfo& attr, const Variant &src)
 {
     // If any of the (size) attributes change, resize the octree
     Serializable::OnSetAttribute(attr, src);
+    looseness_ = Clamp(looseness_, MIN_OCTREE_LOOSENESS, MAX_OCTREE_LOOSENESS);
     SetSize(worldBoundingBox_, numLevels_);
 }
 
@@ -361,6 +424,12 @@ void Octree::SetSize(const BoundingBox& box, unsigned numLevels)
     numLevels_ = Max(numLevels, 1U);
 }
 
+void Octree::SetLooseness(float looseness)
+{
+    looseness_ = Clamp(looseness, MIN_OCTREE_LOOSENESS, MAX_OCTREE_LOOSENESS);
+    SetSize(worldBoundingBox_, numLevels_);
+}
+
 void Octree::Update(const FrameInfo& frame)
 {
     if (!Thread::IsMainThread())
@@ -380,30 +449,10 @@ void Octree::Update(const FrameInfo& frame)
         WorkQueue* queue = GetSubsystem<WorkQueue>();
         scene->BeginThreadedUpdate();
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.Size() / numWorkItems), 1);
-
-        PODVector<Drawable*>::Iterator start = drawableUpdates_.Begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
-
-            PODVector<Drawable*>::Iterator end = drawableUpdates_.End();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
+        updateFrame_ = &frame;
+        queue->ParallelFor(drawableUpdates_.Size(), UpdateDrawablesWork, this, UPDATE_DRAWABLES_GRAIN_SIZE);
+        updateFrame_ = 0;
 
-        queue->Complete(M_MAX_UNSIGNED);
         scene->EndThreadedUpdate();
     }
 
@@ -453,6 +502,8 @@ void Octree::Update(const FrameInfo& frame)
             // Skip if no octant or does not belong to this octree anymore
             if (!octant || octant->GetRoot() != this)
                 continue;
+            // The bounding box may have changed, so the octant's packed boxes need a rebuild even if no reinsertion happens
+            octant->MarkPackedBoxesDirty();
             // Skip if still fits the current octant
             if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
                 continue;
@@ -472,6 +523,17 @@ void Octree::Update(const FrameInfo& frame)
     }
 
     drawableUpdates_.Clear();
+
+    // Rebuild packed bounding boxes for batched frustum culling of octants whose drawables changed
+    if (!dirtyOctants_.Empty())
+    {
+        FLOCKSDK_PROFILE(UpdatePackedBoxes);
+
+        for (PODVector<Octant*>::Iterator i = dirtyOctants_.Begin(); i != dirtyOctants_.End(); ++i)
+            (*i)->UpdatePackedBoxes();
+
+        dirtyOctants_.Clear();
+    }
 }
 
 void Octree::AddManualDrawable(Drawable* drawable)
@@ -556,8 +618,15 @@ void Octree::QueueUpdate(Drawable* drawable)
         threadedDrawableUpdates_.Push(drawable);
     }
     else
+    {
         drawableUpdates_.Push(drawable);
 
+        // The queued drawable's bounding box is stale until the next update, so cull its octant unpacked until then
+        Octant* octant = drawable->GetOctant();
+        if (octant)
+            octant->MarkPackedBoxesDirty();
+    }
+
     drawable->updateQueued_ = true;
 }
 
@@ -59,6 +59,7 @@ public:
         drawable->SetOctant(this);
         drawables_.Push(drawable);
         IncDrawableCount();
+        MarkPackedBoxesDirty();
     }
 
     /// Remove a drawable object from this octant.
@@ -68,6 +69,7 @@ public:
         {
             if (resetOctant)
                 drawable->SetOctant(0);
+            MarkPackedBoxesDirty();
             DecDrawableCount();
         }
     }
@@ -75,6 +77,9 @@ public:
     /// Return world-space bounding box.
     const BoundingBox& GetWorldBoundingBox() const { return worldBoundingBox_; }
 
+    /// Return looseness factor, the size of the culling box relative to the world-space bounding box.
+    float GetLooseness() const { return looseness_; }
+
     /// Return bounding box used for fitting drawable objects.
     const BoundingBox& GetCullingBox() const { return cullingBox_; }
 
@@ -93,6 +98,13 @@ public:
     /// Return true if there are no drawable objects in this octant and child octants.
     bool IsEmpty() { return numDrawables_ == 0; }
 
+    /// Mark the packed drawable bounding boxes as requiring a rebuild. They will be rebuilt at the end of the next octree update.
+    void MarkPackedBoxesDirty();
+    /// Rebuild the packed drawable bounding boxes. Called internally.
+    void UpdatePackedBoxes();
+    /// Return whether the packed drawable bounding boxes are out of date.
+    bool IsPackedBoxesDirty() const { return packedBoxesDirty_; }
+
     /// Reset root pointer recursively. Called when the whole octree is being destroyed.
     void ResetRoot();
     /// Draw bounds to the debug graphics recursively.
@@ -144,6 +156,10 @@ protected:
     Vector3 center_;
     /// World bounding box half size.
     Vector3 halfSize_;
+    /// Culling box extension beyond the world bounding box on each side.
+    Vector3 looseExtent_;
+    /// Looseness factor, inherited from the parent octant.
+    float looseness_;
     /// Subdivision level.
     unsigned level_;
     /// Number of drawable objects in this octant and child octants.
@@ -154,12 +170,20 @@ protected:
     Octree* root_;
     /// Octant index relative to its siblings or ROOT_INDEX for root octant
     unsigned index_;
+    /// Drawable world bounding box centers and half sizes as six structure-of-arrays rows for batched culling.
+    PODVector<float> packedBoxes_;
+    /// Row stride of the packed bounding boxes, rounded up to a multiple of 8.
+    unsigned packedBoxStride_;
+    /// Packed bounding boxes out of date flag.
+    bool packedBoxesDirty_;
 };
 
 /// %Octree component. Should be added only to the root scene node
 class FLOCKSDK_API Octree : public Component, public Octant
 {
+    friend class Octant;
     friend void RaycastDrawablesWork(const WorkItem* item, unsigned threadIndex);
+    friend void UpdateDrawablesWork(unsigned start, unsigned end, unsigned threadIndex, void* data);
 
     FLOCKSDK_OBJECT(Octree, Component);
 
@@ -178,6 +202,8 @@ public:
 
     /// Set size and maximum subdivision levels. If octree is not empty, drawable objects will be temporarily moved to the root.
     void SetSize(const BoundingBox& box, unsigned numLevels);
+    /// Set looseness factor (1.25 - 4, default 2.) Higher values let moving drawables stay in their octant longer at the cost of larger culling boxes. If octree is not empty, drawable objects will be temporarily moved to the root.
+    void SetLooseness(float looseness);
     /// Update and reinsert drawable objects.
     void Update(const FrameInfo& frame);
     /// Add a drawable manually.
@@ -210,6 +236,10 @@ private:
     PODVector<Drawable*> drawableUpdates_;
     /// Drawable objects that were inserted during threaded update phase.
     PODVector<Drawable*> threadedDrawableUpdates_;
+    /// Octants whose packed bounding boxes need to be rebuilt.
+    PODVector<Octant*> dirtyOctants_;
+    /// Frame info for the threaded update phase.
+    const FrameInfo* updateFrame_;
     /// Mutex for octree reinsertions.
     Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
@@ -117,6 +117,33 @@ void FrustumOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool in
     }
 }
 
+void FrustumOctreeQuery::TestPackedDrawables(Drawable** start, Drawable** end, const float* boxData, unsigned stride, bool inside)
+{
+    if (inside)
+    {
+        TestDrawables(start, end, inside);
+        return;
+    }
+
+    // Cull 32 drawables at a time, then let TestDrawables (possibly overridden) apply the flag filtering to the survivors
+    Drawable* visible[32];
+    unsigned numDrawables = (unsigned)(end - start);
+
+    for (auto i = 0u; i < numDrawables; i += 32)
+    {
+        unsigned mask = frustum_.GetInsideMask(boxData + i, stride, Min(numDrawables - i, 32U));
+        unsigned numVisible = 0;
+
+        for (auto j = i; mask; ++j, mask >>= 1)
+        {
+            if (mask & 1)
+                visible[numVisible++] = start[j];
+        }
+
+        if (numVisible)
+            TestDrawables(visible, visible + numVisible, true);
+    }
+}
 
 Intersection AllContentOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
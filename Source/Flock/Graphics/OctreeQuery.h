@@ -55,6 +55,11 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Intersection test for drawables whose world bounding boxes are also given packed by the octant. By default ignores the packed data.
+    virtual void TestPackedDrawables(Drawable** start, Drawable** end, const float* boxData, unsigned stride, bool inside)
+    {
+        TestDrawables(start, end, inside);
+    }
 
     /// Result vector reference.
     PODVector<Drawable*>& result_;
@@ -149,6 +154,8 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside);
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside);
+    /// Batched frustum test for drawables with packed bounding boxes. Drawables that pass are handed to TestDrawables as fully inside.
+    virtual void TestPackedDrawables(Drawable** start, Drawable** end, const float* boxData, unsigned stride, bool inside);
 
     /// Frustum.
     Frustum frustum_;
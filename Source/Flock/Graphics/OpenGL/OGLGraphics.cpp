@@ -3000,6 +3000,7 @@ void Graphics::SetTextureUnitMappings()
     textureUnits_["LightBuffer"] = TU_LIGHTBUFFER;
     textureUnits_["ZoneCubeMap"] = TU_ZONE;
     textureUnits_["ZoneVolumeMap"] = TU_ZONE;
+    textureUnits_["SkinPalette"] = TU_SKINPALETTE;
 }
 
 unsigned Graphics::CreateFramebuffer()
@@ -180,6 +180,15 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
     if (renderer)
         quality = renderer->GetTextureQuality();
 
+    // When streaming, the non-resident high mip levels are skipped the same way as on a lower quality setting
+    unsigned mipsToSkip = mipsToSkip_[quality];
+    if (streaming_)
+    {
+        mipsToSkip = Max(mipsToSkip, streamingLevel_);
+        sourceWidth_ = image->GetWidth();
+        sourceHeight_ = image->GetHeight();
+    }
+
     if (!image->IsCompressed())
     {
         // Convert unsuitable formats to RGBA
@@ -198,7 +207,8 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
         unsigned format = 0;
 
         // Discard unnecessary mip levels
-        for (auto i = 0u; i < mipsToSkip_[quality]; ++i)
+        mipsToSkip = Min(mipsToSkip, CheckMaxLevels(levelWidth, levelHeight, 0) - 1);
+        for (auto i = 0u; i < mipsToSkip; ++i)
         {
             mipImage = image->GetNextLevel(); image = mipImage;
             levelData = image->GetData();
@@ -264,7 +274,6 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
             needDecompress = true;
         }
 
-        unsigned mipsToSkip = mipsToSkip_[quality];
         if (mipsToSkip >= levels)
             mipsToSkip = levels - 1;
         while (mipsToSkip && (width / (1 << mipsToSkip) < 4 || height / (1 << mipsToSkip) < 4))
@@ -294,6 +303,9 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
         }
     }
 
+    if (streaming_)
+        streamingLevel_ = mipsToSkip;
+
     SetMemoryUse(memoryUse);
     return true;
 }
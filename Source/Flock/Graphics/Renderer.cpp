@@ -24,6 +24,7 @@
 
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Geometry.h"
@@ -43,7 +44,9 @@
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../Graphics/Zone.h"
+#include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../Resource/Image.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
 #include "../Scene/Scene.h"
@@ -177,7 +180,9 @@ static const char* geometryVSVariations[] =
     "BILLBOARD ",
     "DIRBILLBOARD ",
     "TRAILFACECAM ",
-    "TRAILBONE "
+    "TRAILBONE ",
+    "SKINNED SKINPALETTE ",
+    "SKINNED SKINPALETTE INSTANCED "
 };
 
 static const char* lightVSVariations[] =
@@ -259,6 +264,44 @@ inline PODVector<VertexElement> CreateInstancingBufferElements(unsigned numExtra
     return elements;
 }
 
+/// Maximum number of streaming texture loads in progress.
+static const unsigned MAX_TEXTURE_STREAM_REQUESTS = 4;
+/// Frames after which a texture not requested by views only needs its lowest streaming levels.
+static const unsigned TEXTURE_STREAMING_IDLE_FRAMES = 60;
+
+/// Streaming texture load in progress.
+struct TextureStreamRequest : public RefCounted
+{
+    /// Texture to update.
+    WeakPtr<Texture2D> texture_;
+    /// Resource cache for opening the image.
+    ResourceCache* cache_;
+    /// Image file name.
+    String name_;
+    /// Mip level of the image to start from.
+    unsigned level_;
+    /// Loaded image.
+    SharedPtr<Image> image_;
+    /// Work item.
+    SharedPtr<WorkItem> item_;
+};
+
+static void LoadStreamingTextureWork(const WorkItem* item, unsigned threadIndex)
+{
+    TextureStreamRequest* request = static_cast<TextureStreamRequest*>(item->aux_);
+    SharedPtr<File> file = request->cache_->GetFile(request->name_, false);
+    if (!file)
+        return;
+
+    SharedPtr<Image> image(new Image(request->cache_->GetContext()));
+    if (!image->Load(*file))
+        return;
+
+    // Calculate the mip levels here so that the main thread only uploads them
+    image->PrecalculateLevels();
+    request->image_ = image;
+}
+
 Renderer::Renderer(Context* context) :
     Object(context),
     defaultZone_(new Zone(context)),
@@ -267,6 +310,7 @@ Renderer::Renderer(Context* context) :
     textureAnisotropy_(4),
     textureFilterMode_(FILTER_TRILINEAR),
     textureQuality_(QUALITY_HIGH),
+    textureStreamingMinSize_(64),
     materialQuality_(QUALITY_HIGH),
     shadowMapSize_(1024),
     shadowQuality_(SHADOWQUALITY_PCF_16BIT),
@@ -281,6 +325,10 @@ Renderer::Renderer(Context* context) :
     occluderSizeThreshold_(0.025f),
     numOcclusionBuffers_(0),
     numShadowCameras_(0),
+    numAnimationUpdates_(0),
+    numAnimationLodSkips_(0),
+    numSkinningSkips_(0),
+    skinPaletteRows_(0),
     shadersChangedFrameNumber_(M_MAX_UNSIGNED),
     hdrRendering_(false),
     specularLighting_(true),
@@ -289,6 +337,9 @@ Renderer::Renderer(Context* context) :
     dynamicInstancing_(true),
     numExtraInstancingBufferElements_(0),
     threadedOcclusion_(false),
+    retainStaticBatches_(false),
+    skinningPalette_(false),
+    textureStreaming_(false),
     shadersDirty_(true),
     initialized_(false),
     resetViews_(false)
@@ -301,6 +352,17 @@ Renderer::Renderer(Context* context) :
 
 Renderer::~Renderer()
 {
+    // Wait for streaming texture loads that have already started
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    for (auto i = 0u; i < textureStreamRequests_.Size(); ++i)
+    {
+        WorkItem* item = textureStreamRequests_[i]->item_;
+        if (queue && !queue->RemoveWorkItem(textureStreamRequests_[i]->item_))
+        {
+            while (!item->completed_)
+                Time::Sleep(1);
+        }
+    }
 }
 
 void Renderer::SetNumViewports(unsigned num)
@@ -534,6 +596,39 @@ void Renderer::SetThreadedOcclusion(bool enable)
     }
 }
 
+void Renderer::SetRetainStaticBatches(bool enable)
+{
+    retainStaticBatches_ = enable;
+}
+
+void Renderer::SetTextureStreaming(bool enable)
+{
+    textureStreaming_ = enable;
+}
+
+void Renderer::SetTextureStreamingMinSize(int size)
+{
+    textureStreamingMinSize_ = Max(size, 1);
+}
+
+void Renderer::SetSkinningPalette(bool enable)
+{
+    // The palette is read with texel fetches in the vertex shader
+    if (enable && !Graphics::GetGL3Support())
+    {
+        FLOCKSDK_LOGWARNING("Skinning palette requires OpenGL 3 support");
+        enable = false;
+    }
+
+    skinningPalette_ = enable;
+    if (!enable)
+    {
+        skinPalette_.Clear();
+        skinPaletteTexture_.Reset();
+        skinPaletteRows_ = 0;
+    }
+}
+
 void Renderer::ReloadShaders()
 {
     shadersDirty_ = true;
@@ -672,6 +767,11 @@ void Renderer::Update(float timeStep)
     frame_.camera_ = 0;
     numShadowCameras_ = 0;
     numOcclusionBuffers_ = 0;
+    numAnimationUpdates_ = 0;
+    numAnimationLodSkips_ = 0;
+    numSkinningSkips_ = 0;
+    skinPalette_.Clear();
+    skinPaletteRows_ = 0;
     updatedOctrees_.Clear();
 
     // Reload shaders now if needed
@@ -697,6 +797,9 @@ void Renderer::Update(float timeStep)
 
     queuedViewports_.Clear();
     resetViews_ = false;
+
+    // All views have now requested the mip levels of the streaming textures they use
+    UpdateTextureStreaming();
 }
 
 void Renderer::Render()
@@ -799,6 +902,25 @@ void Renderer::DrawDebugGeometry(bool depthTest)
     }
 }
 
+unsigned Renderer::AddSkinMatrices(const Matrix3x4* matrices, unsigned numMatrices)
+{
+    unsigned offset = skinPalette_.Size();
+    skinPalette_.Resize(offset + numMatrices);
+    for (auto i = 0u; i < numMatrices; ++i)
+        skinPalette_[offset + i] = matrices[i];
+    return offset;
+}
+
+void Renderer::AddAnimationStats(unsigned updates, unsigned lodSkips, unsigned skinningSkips)
+{
+    if (updates)
+        numAnimationUpdates_.fetch_add(updates, std::memory_order_relaxed);
+    if (lodSkips)
+        numAnimationLodSkips_.fetch_add(lodSkips, std::memory_order_relaxed);
+    if (skinningSkips)
+        numSkinningSkips_.fetch_add(skinningSkips, std::memory_order_relaxed);
+}
+
 void Renderer::QueueRenderSurface(RenderSurface* renderTarget)
 {
     if (renderTarget)
@@ -1182,6 +1304,8 @@ void Renderer::SetBatchShaders(Batch& batch, Technique* tech, bool allowShadows,
         // If instancing is not supported, but was requested, choose static geometry vertex shader instead
         if (batch.geometryType_ == GEOM_INSTANCED && !GetDynamicInstancing())
             batch.geometryType_ = GEOM_STATIC;
+        else if (batch.geometryType_ == GEOM_SKINPALETTE_INSTANCED && !GetDynamicInstancing())
+            batch.geometryType_ = GEOM_SKINPALETTE;
 
         if (batch.geometryType_ == GEOM_STATIC_NOINSTANCING)
             batch.geometryType_ = GEOM_STATIC;
@@ -1266,6 +1390,7 @@ void Renderer::SetBatchShaders(Batch& batch, Technique* tech, bool allowShadows,
     // Log error if shaders could not be assigned, but only once per technique
     if (!batch.vertexShader_ || !batch.pixelShader_)
     {
+        MutexLock lock(shaderErrorMutex_);
         if (!shaderErrorDisplayed_.Contains(tech))
         {
             shaderErrorDisplayed_.Insert(tech);
@@ -1369,6 +1494,169 @@ bool Renderer::ResizeInstancingBuffer(unsigned numInstances)
     return true;
 }
 
+void Renderer::UpdateSkinPaletteTexture()
+{
+    // Each matrix takes 3 texels. Skip if no matrices were added after the rows already uploaded this frame
+    unsigned numTexels = skinPalette_.Size() * 3;
+    if (!skinningPalette_ || numTexels <= skinPaletteRows_ * SKIN_PALETTE_WIDTH)
+        return;
+
+    // Pad the data to full texture rows. Matrices added later continue after the padding, so the offsets of
+    // already uploaded matrices stay valid
+    int height = (int)((numTexels + SKIN_PALETTE_WIDTH - 1) / SKIN_PALETTE_WIDTH);
+    skinPalette_.Resize((unsigned)(height * SKIN_PALETTE_WIDTH + 2) / 3);
+    int startRow = (int)skinPaletteRows_;
+
+    if (!skinPaletteTexture_)
+    {
+        skinPaletteTexture_ = new Texture2D(context_);
+        skinPaletteTexture_->SetNumLevels(1);
+        skinPaletteTexture_->SetFilterMode(FILTER_NEAREST);
+    }
+
+    // Grow the texture in powers of two to avoid reallocating it as the number of skinned models varies
+    if (skinPaletteTexture_->GetHeight() < height)
+    {
+        int newHeight = 1;
+        while (newHeight < height)
+            newHeight <<= 1;
+
+        if (!skinPaletteTexture_->SetSize(SKIN_PALETTE_WIDTH, newHeight, Graphics::GetRGBAFloat32Format(), TEXTURE_DYNAMIC))
+        {
+            FLOCKSDK_LOGERROR("Failed to resize skinning palette texture to " + String(newHeight) + " rows");
+            return;
+        }
+
+        FLOCKSDK_LOGDEBUG("Resized skinning palette texture to " + String(newHeight) + " rows");
+        // Resizing loses the contents, so upload all rows
+        startRow = 0;
+    }
+
+    // Upload only the rows added since the previous view was rendered
+    const float* data = reinterpret_cast<const float*>(skinPalette_.Buffer()) + startRow * SKIN_PALETTE_WIDTH * 4;
+    skinPaletteTexture_->SetData(0, 0, startRow, SKIN_PALETTE_WIDTH, height - startRow, data);
+    skinPaletteRows_ = (unsigned)height;
+}
+
+void Renderer::UpdateTextureStreaming()
+{
+    // Upload the mip levels that have finished loading
+    for (Vector<SharedPtr<TextureStreamRequest> >::Iterator i = textureStreamRequests_.Begin(); i != textureStreamRequests_.End();)
+    {
+        TextureStreamRequest* request = *i;
+        if (!request->item_->completed_)
+        {
+            ++i;
+            continue;
+        }
+
+        if (request->texture_ && request->image_)
+            request->texture_->SetStreamingData(request->image_, request->level_);
+        i = textureStreamRequests_.Erase(i);
+    }
+
+    if (!textureStreaming_ || textureStreamRequests_.Size() >= MAX_TEXTURE_STREAM_REQUESTS)
+        return;
+
+    FLOCKSDK_PROFILE(UpdateTextureStreaming);
+
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    StringHash type = Texture2D::GetTypeStatic();
+    const HashMap<StringHash, ResourceGroup>& groups = cache->GetAllResources();
+    HashMap<StringHash, ResourceGroup>::ConstIterator group = groups.Find(type);
+    if (group == groups.End())
+        return;
+
+    // Find the textures that have more or fewer mip levels resident than the views need, by the number of levels. The
+    // memory use of the resource group is not updated when levels are streamed, so sum it here
+    PODVector<Pair<unsigned, Texture2D*> > raiseLevels;
+    PODVector<Pair<unsigned, Texture2D*> > dropLevels;
+    unsigned long long memoryUse = 0;
+
+    for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator i = group->second_.resources_.Begin();
+         i != group->second_.resources_.End(); ++i)
+    {
+        Texture2D* texture = static_cast<Texture2D*>(i->second_.Get());
+        memoryUse += texture->GetMemoryUse();
+        if (!texture->GetStreaming() || texture->GetAsyncLoadState() != ASYNC_DONE)
+            continue;
+
+        bool inProgress = false;
+        for (auto j = 0u; j < textureStreamRequests_.Size(); ++j)
+        {
+            if (textureStreamRequests_[j]->texture_ == texture)
+            {
+                inProgress = true;
+                break;
+            }
+        }
+        if (inProgress)
+            continue;
+
+        // Textures that have not been seen for a while only need their lowest levels
+        unsigned level = texture->GetStreamingLowLevel();
+        if (frame_.frameNumber_ - texture->GetStreamingRequestFrame() <= TEXTURE_STREAMING_IDLE_FRAMES)
+            level = Min(level, texture->GetRequestedStreamingLevel());
+        level = Max(level, (unsigned)texture->GetMipsToSkip(textureQuality_));
+
+        unsigned currentLevel = texture->GetStreamingLevel();
+        if (level < currentLevel)
+            raiseLevels.Push(MakePair(currentLevel - level, texture));
+        else if (level > currentLevel)
+            dropLevels.Push(MakePair(level - currentLevel, texture));
+    }
+
+    unsigned long long budget = cache->GetMemoryBudget(type);
+    if (budget && memoryUse > budget)
+    {
+        // Over budget: evict the levels of the textures with the most unneeded detail first
+        Sort(dropLevels.Begin(), dropLevels.End());
+        for (unsigned i = dropLevels.Size() - 1; i < dropLevels.Size() && textureStreamRequests_.Size() <
+            MAX_TEXTURE_STREAM_REQUESTS; --i)
+        {
+            Texture2D* texture = dropLevels[i].second_;
+            QueueTextureStreaming(texture, texture->GetStreamingLevel() + dropLevels[i].first_);
+        }
+    }
+    else
+    {
+        // Load the textures missing the most detail first, as long as the estimated memory use stays within the budget
+        Sort(raiseLevels.Begin(), raiseLevels.End());
+        for (unsigned i = raiseLevels.Size() - 1; i < raiseLevels.Size() && textureStreamRequests_.Size() <
+            MAX_TEXTURE_STREAM_REQUESTS; --i)
+        {
+            Texture2D* texture = raiseLevels[i].second_;
+            // Each level up quadruples the memory use
+            unsigned long long increase = (unsigned long long)texture->GetMemoryUse() * ((1ULL << (2 * Min(raiseLevels[i].first_, 16U))) - 1);
+            if (budget && memoryUse + increase > budget)
+                continue;
+
+            memoryUse += increase;
+            QueueTextureStreaming(texture, texture->GetStreamingLevel() - raiseLevels[i].first_);
+        }
+    }
+}
+
+void Renderer::QueueTextureStreaming(Texture2D* texture, unsigned level)
+{
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    SharedPtr<TextureStreamRequest> request(new TextureStreamRequest());
+    request->texture_ = texture;
+    request->cache_ = GetSubsystem<ResourceCache>();
+    request->name_ = texture->GetName();
+    request->level_ = level;
+
+    // Use an item outside the pool, as the pool would reset the completed flag before it is checked here
+    request->item_ = new WorkItem();
+    request->item_->workFunction_ = LoadStreamingTextureWork;
+    request->item_->aux_ = request.Get();
+    request->item_->priority_ = 0;
+
+    textureStreamRequests_.Push(request);
+    queue->AddWorkItem(request->item_);
+}
+
 void Renderer::SaveScreenBufferAllocations()
 {
     savedScreenBufferAllocations_ = screenBufferAllocations_;
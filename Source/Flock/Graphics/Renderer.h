@@ -29,6 +29,8 @@
 #include "../Graphics/Viewport.h"
 #include "../Math/Color.h"
 
+#include <atomic>
+
 namespace FlockSDK
 {
 
@@ -53,9 +55,11 @@ class TextureCube;
 class View;
 class Zone;
 struct BatchQueue;
+struct TextureStreamRequest;
 
 static const int SHADOW_MIN_PIXELS = 64;
 static const int INSTANCING_BUFFER_DEFAULT_SIZE = 1024;
+static const int SKIN_PALETTE_WIDTH = 1024;
 
 /// Light vertex shader variations.
 enum LightVSVariation
@@ -238,6 +242,14 @@ public:
     void SetOccluderSizeThreshold(float screenSize);
     /// Set whether to thread occluder rendering. Default false.
     void SetThreadedOcclusion(bool enable);
+    /// Set whether views retain the scene pass batches of static drawables between frames, and only collect them again when the drawable's materials, zone or light mask change. Default false.
+    void SetRetainStaticBatches(bool enable);
+    /// Set whether skinned models upload their bone matrices to one shared palette texture per frame instead of per-draw uniform arrays. Allows any number of bones and instancing of skinned models. Requires OpenGL 3. Default false.
+    void SetSkinningPalette(bool enable);
+    /// Set whether 2D textures loaded afterward stream their mip levels. Only the low levels are loaded first and higher levels are loaded in the background by the on-screen texel density, and unneeded levels are evicted when over the Texture2D memory budget of ResourceCache. Textures not drawn by scene materials, such as UI textures, should disable streaming in their parameter file. Default false.
+    void SetTextureStreaming(bool enable);
+    /// Set the largest mip level size loaded first when streaming textures. Default 64.
+    void SetTextureStreamingMinSize(int size);
     /// Force reload of shaders.
     void ReloadShaders();
 
@@ -322,6 +334,18 @@ public:
     /// Return whether occlusion rendering is threaded.
     bool GetThreadedOcclusion() const { return threadedOcclusion_; }
 
+    /// Return whether views retain the scene pass batches of static drawables between frames.
+    bool GetRetainStaticBatches() const { return retainStaticBatches_; }
+
+    /// Return whether skinned models use the shared skinning palette texture.
+    bool GetSkinningPalette() const { return skinningPalette_; }
+
+    /// Return whether 2D textures stream their mip levels.
+    bool GetTextureStreaming() const { return textureStreaming_; }
+
+    /// Return the largest mip level size loaded first when streaming textures.
+    int GetTextureStreamingMinSize() const { return textureStreamingMinSize_; }
+
     /// Return number of views rendered.
     unsigned GetNumViews() const { return views_.Size(); }
 
@@ -340,6 +364,15 @@ public:
     /// Return number of occluders rendered.
     unsigned GetNumOccluders(bool allViews = false) const;
 
+    /// Return number of animated models whose animation was sampled this frame.
+    unsigned GetNumAnimationUpdates() const { return numAnimationUpdates_.load(); }
+
+    /// Return number of animated model updates skipped or interpolated due to animation LOD this frame.
+    unsigned GetNumAnimationLodSkips() const { return numAnimationLodSkips_.load(); }
+
+    /// Return number of animated model skinning updates skipped for shadow-only casters this frame.
+    unsigned GetNumSkinningSkips() const { return numSkinningSkips_.load(); }
+
     /// Return the default zone.
     Zone* GetDefaultZone() const { return defaultZone_; }
 
@@ -361,6 +394,9 @@ public:
     /// Return the instancing vertex buffer
     VertexBuffer* GetInstancingBuffer() const { return dynamicInstancing_ ? instancingBuffer_ : (VertexBuffer*)0; }
 
+    /// Return the skinning palette texture.
+    Texture2D* GetSkinPaletteTexture() const { return skinPaletteTexture_; }
+
     /// Return the frame update parameters.
     const FrameInfo& GetFrameInfo() const { return frame_; }
 
@@ -370,6 +406,12 @@ public:
     void Render();
     /// Add debug geometry to the debug renderer.
     void DrawDebugGeometry(bool depthTest);
+    /// Add skinning matrices to the skinning palette for the current frame and return their offset in matrices. Called from the main thread.
+    unsigned AddSkinMatrices(const Matrix3x4* matrices, unsigned numMatrices);
+    /// Upload the skinning palette matrices added since the previous upload to the palette texture. Called by View after updating its geometries.
+    void UpdateSkinPaletteTexture();
+    /// Add animation statistics for the current frame. May be called from worker threads.
+    void AddAnimationStats(unsigned updates, unsigned lodSkips, unsigned skinningSkips);
     /// Queue a render surface's viewports for rendering. Called by the surface, or by View.
     void QueueRenderSurface(RenderSurface* renderTarget);
     /// Queue a viewport for rendering. Null surface means backbuffer.
@@ -432,6 +474,10 @@ private:
     void CreateGeometries();
     /// Create instancing vertex buffer.
     void CreateInstancingBuffer();
+    /// Upload finished streamed mip levels and queue loading or eviction of levels for streaming textures.
+    void UpdateTextureStreaming();
+    /// Queue reloading a streaming texture from a mip level of its image in a worker thread.
+    void QueueTextureStreaming(Texture2D* texture, unsigned level);
     /// Create point light shadow indirection texture data.
     void SetIndirectionTextureData();
     /// Update a queued viewport for rendering.
@@ -473,6 +519,10 @@ private:
     SharedPtr<Geometry> pointLightGeometry_;
     /// Instance stream vertex buffer.
     SharedPtr<VertexBuffer> instancingBuffer_;
+    /// Skinning palette texture.
+    SharedPtr<Texture2D> skinPaletteTexture_;
+    /// Skinning palette matrices of the current frame.
+    PODVector<Matrix3x4> skinPalette_;
     /// Default material.
     SharedPtr<Material> defaultMaterial_;
     /// Default range attenuation texture.
@@ -519,8 +569,12 @@ private:
     HashSet<Technique*> shaderErrorDisplayed_;
     /// Mutex for shadow camera allocation.
     Mutex rendererMutex_;
+    /// Mutex for the techniques with missing shaders, as batch shaders are also set from worker threads.
+    Mutex shaderErrorMutex_;
     /// Current variation names for deferred light volume shaders.
     Vector<String> deferredLightPSVariations_;
+    /// Texture streaming loads in progress.
+    Vector<SharedPtr<TextureStreamRequest> > textureStreamRequests_;
     /// Frame info for rendering.
     FrameInfo frame_;
     /// Texture anisotropy level.
@@ -529,6 +583,8 @@ private:
     TextureFilterMode textureFilterMode_;
     /// Texture quality level.
     int textureQuality_;
+    /// Largest mip level size loaded first when streaming textures.
+    int textureStreamingMinSize_;
     /// Material quality level.
     int materialQuality_;
     /// Shadow map resolution.
@@ -561,6 +617,14 @@ private:
     unsigned numPrimitives_;
     /// Number of batches (3D geometry only.)
     unsigned numBatches_;
+    /// Number of animation updates this frame.
+    std::atomic<unsigned> numAnimationUpdates_;
+    /// Number of animation updates skipped due to animation LOD this frame.
+    std::atomic<unsigned> numAnimationLodSkips_;
+    /// Number of skinning updates skipped for shadow-only casters this frame.
+    std::atomic<unsigned> numSkinningSkips_;
+    /// Number of skinning palette texture rows uploaded this frame.
+    unsigned skinPaletteRows_;
     /// Frame number on which shaders last changed.
     unsigned shadersChangedFrameNumber_;
     /// Current stencil value for light optimization.
@@ -579,6 +643,12 @@ private:
     int numExtraInstancingBufferElements_;
     /// Threaded occlusion rendering flag.
     bool threadedOcclusion_;
+    /// Retain static drawable batches flag.
+    bool retainStaticBatches_;
+    /// Skinning palette flag.
+    bool skinningPalette_;
+    /// Texture streaming flag.
+    bool textureStreaming_;
     /// Shaders need reloading flag.
     bool shadersDirty_;
     /// Initialized flag.
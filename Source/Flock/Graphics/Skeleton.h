@@ -46,6 +46,7 @@ struct Bone
         initialRotation_(Quaternion::IDENTITY),
         initialScale_(Vector3::ONE),
         animated_(true),
+        maxAnimationLod_(M_MAX_UNSIGNED),
         collisionMask_(0),
         radius_(0.0f)
     {
@@ -67,6 +68,8 @@ struct Bone
     Matrix3x4 offsetMatrix_;
     /// Animation enable flag.
     bool animated_;
+    /// Highest animation LOD level at which the bone is still animated. At higher levels the bone stays in its reset pose.
+    unsigned maxAnimationLod_;
     /// Supported collision types.
     unsigned char collisionMask_;
     /// Radius.
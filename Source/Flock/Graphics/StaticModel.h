@@ -57,6 +57,8 @@ public:
     virtual void UpdateBatches(const FrameInfo& frame);
     /// Return the geometry for a specific LOD level.
     virtual Geometry* GetLodGeometry(unsigned batchIndex, unsigned level);
+    /// Return whether the scene pass batches only depend on the materials, zone and light mask.
+    virtual bool HasStaticBatches() const { return true; }
     /// Return number of occlusion geometry triangles.
     virtual unsigned GetNumOccluderTriangles();
     /// Draw to occlusion buffer. Return true if did not run out of triangles.
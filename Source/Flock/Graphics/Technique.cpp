@@ -241,7 +241,8 @@ HashMap<String, unsigned> Technique::passIndices;
 
 Technique::Technique(Context* context) :
     Resource(context),
-    isDesktop_(false)
+    isDesktop_(false),
+    passesVersion_(0)
 {
 #ifdef DESKTOP_GRAPHICS
     desktopSupport_ = true;
@@ -262,6 +263,7 @@ void Technique::RegisterObject(Context* context)
 bool Technique::BeginLoad(Deserializer& source)
 {
     passes_.Clear();
+    ++passesVersion_;
     cloneTechniques_.Clear();
 
     SetMemoryUse(sizeof(Technique));
@@ -365,6 +367,7 @@ bool Technique::BeginLoad(Deserializer& source)
 void Technique::SetIsDesktop(bool enable)
 {
     isDesktop_ = enable;
+    ++passesVersion_;
 }
 
 void Technique::ReleaseShaders()
@@ -419,6 +422,7 @@ Pass* Technique::CreatePass(const String &name)
     if (passIndex >= passes_.Size())
         passes_.Resize(passIndex + 1);
     passes_[passIndex] = newPass;
+    ++passesVersion_;
 
     // Calculate memory use now
     SetMemoryUse((unsigned)(sizeof(Technique) + GetNumPasses() * sizeof(Pass)));
@@ -434,6 +438,7 @@ void Technique::RemovePass(const String &name)
     else if (i->second_ < passes_.Size() && passes_[i->second_].Get())
     {
         passes_[i->second_].Reset();
+        ++passesVersion_;
         SetMemoryUse((unsigned)(sizeof(Technique) + GetNumPasses() * sizeof(Pass)));
     }
 }
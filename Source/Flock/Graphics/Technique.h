@@ -247,6 +247,8 @@ public:
     Vector<String> GetPassNames() const;
     /// Return all passes.
     PODVector<Pass*> GetPasses() const;
+    /// Return the passes version, which changes when passes are created or removed.
+    unsigned GetPassesVersion() const { return passesVersion_; }
 
     /// Return a clone with added shader compilation defines. Called internally by Material.
     SharedPtr<Technique> CloneWithDefines(const String &vsDefines, const String &psDefines);
@@ -278,6 +280,8 @@ private:
     bool desktopSupport_;
     /// Passes.
     Vector<SharedPtr<Pass> > passes_;
+    /// Passes version.
+    unsigned passesVersion_;
     /// Cached clones with added shader compilation defines.
     HashMap<Pair<StringHash, StringHash>, SharedPtr<Technique> > cloneTechniques_;
 
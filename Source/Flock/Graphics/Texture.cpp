@@ -76,7 +76,8 @@ Texture::Texture(Context* context) :
     parametersDirty_(true),
     autoResolve_(false),
     resolveDirty_(false),
-    levelsDirty_(false)
+    levelsDirty_(false),
+    streaming_(false)
 {
     for (int i = 0; i < MAX_COORDS; ++i)
         addressMode_[i] = ADDRESS_WRAP;
@@ -249,6 +250,9 @@ void Texture::SetParameters(const XMLElement& element)
         if (name == "srgb")
             SetSRGB(paramElem.GetBool("enable"));
 
+        if (name == "streaming")
+            SetStreaming(paramElem.GetBool("enable"));
+
         paramElem = paramElem.GetNext();
     }
 }
@@ -66,6 +66,8 @@ public:
     void SetBackupTexture(Texture* texture);
     /// Set mip levels to skip on a quality setting when loading. Ensures higher quality levels do not skip more.
     void SetMipsToSkip(int quality, int toSkip);
+    /// Set whether to load only the low mip levels first and stream in higher levels by on-screen size. Loaded textures default to the Renderer setting. Only used by 2D textures.
+    void SetStreaming(bool enable) { streaming_ = enable; }
 
     /// Return API-specific texture format.
     unsigned GetFormat() const { return format_; }
@@ -120,6 +122,10 @@ public:
 
     /// Return mip levels to skip on a quality setting when loading.
     int GetMipsToSkip(int quality) const;
+
+    /// Return whether mip levels are streamed.
+    bool GetStreaming() const { return streaming_; }
+
     /// Return mip level width, or 0 if level does not exist.
     int GetLevelWidth(unsigned level) const;
     /// Return mip level width, or 0 if level does not exist.
@@ -244,6 +250,8 @@ protected:
     bool resolveDirty_;
     /// Mipmap levels regeneration needed -flag.
     bool levelsDirty_;
+    /// Mip streaming flag.
+    bool streaming_;
     /// Backup texture.
     SharedPtr<Texture> backupTexture_;
 };
@@ -40,7 +40,13 @@ namespace FlockSDK
 {
 
 Texture2D::Texture2D(Context* context) :
-    Texture(context)
+    Texture(context),
+    streamingLevel_(0),
+    streamingLowLevel_(0),
+    requestedStreamingLevel_(M_MAX_UNSIGNED),
+    streamingRequestFrame_(0),
+    sourceWidth_(0),
+    sourceHeight_(0)
 {
     target_ = GL_TEXTURE_2D;
 }
@@ -98,7 +104,28 @@ bool Texture2D::EndLoad()
     // If over the texture budget, see if materials can be freed to allow textures to be freed
     CheckTextureBudget(GetTypeStatic());
 
+    Renderer* renderer = GetSubsystem<Renderer>();
+    SetStreaming(renderer && renderer->GetTextureStreaming());
     SetParameters(loadParameters_);
+
+    // When streaming, upload first only the mip levels up to the minimum streaming size. Higher levels are streamed in
+    // by Renderer when the texture is seen close enough
+    streamingLevel_ = 0;
+    if (streaming_ && renderer)
+    {
+        unsigned maxLevel = loadImage_->IsCompressed() ? loadImage_->GetNumCompressedLevels() - 1 :
+            CheckMaxLevels(loadImage_->GetWidth(), loadImage_->GetHeight(), 0) - 1;
+        int minSize = renderer->GetTextureStreamingMinSize();
+        int size = Max(loadImage_->GetWidth(), loadImage_->GetHeight());
+        while (size > minSize && streamingLevel_ < maxLevel)
+        {
+            size >>= 1;
+            ++streamingLevel_;
+        }
+    }
+    streamingLowLevel_ = streamingLevel_;
+    requestedStreamingLevel_ = M_MAX_UNSIGNED;
+
     bool success = SetData(loadImage_);
 
     loadImage_.Reset();
@@ -158,6 +185,23 @@ bool Texture2D::SetSize(int width, int height, unsigned format, TextureUsage usa
     return Create();
 }
 
+bool Texture2D::SetStreamingData(Image* image, unsigned level)
+{
+    streamingLevel_ = Min(level, streamingLowLevel_);
+    return SetData(image);
+}
+
+void Texture2D::RequestStreamingLevel(unsigned level, unsigned frameNumber)
+{
+    if (frameNumber != streamingRequestFrame_)
+    {
+        requestedStreamingLevel_ = level;
+        streamingRequestFrame_ = frameNumber;
+    }
+    else if (level < requestedStreamingLevel_)
+        requestedStreamingLevel_ = level;
+}
+
 SharedPtr<Image> Texture2D::GetImage() const
 {
     if (format_ != Graphics::GetRGBAFormat() && format_ != Graphics::GetRGBFormat())
@@ -65,6 +65,10 @@ public:
     bool SetData(unsigned level, int x, int y, int width, int height, const void* data);
     /// Set data from an image. Return true if successful. Optionally make a single channel image alpha-only.
     bool SetData(Image* image, bool useAlpha = false);
+    /// Set data from an image starting from a mip level of the image, when streaming. Return true if successful.
+    bool SetStreamingData(Image* image, unsigned level);
+    /// Request the mip level of the source image needed for the current frame, when streaming. The highest detail requested during a frame is kept. Called by View.
+    void RequestStreamingLevel(unsigned level, unsigned frameNumber);
 
     /// Get data from a mip level. The destination buffer must be big enough. Return true if successful.
     bool GetData(unsigned level, void* dest) const;
@@ -74,6 +78,24 @@ public:
     /// Return render surface.
     RenderSurface* GetRenderSurface() const { return renderSurface_; }
 
+    /// Return the highest-detail resident mip level of the source image, when streaming.
+    unsigned GetStreamingLevel() const { return streamingLevel_; }
+
+    /// Return the lowest-detail mip level of the source image that is loaded first and always kept resident, when streaming.
+    unsigned GetStreamingLowLevel() const { return streamingLowLevel_; }
+
+    /// Return the mip level requested by views on the last requested frame.
+    unsigned GetRequestedStreamingLevel() const { return requestedStreamingLevel_; }
+
+    /// Return frame number of the last streaming request.
+    unsigned GetStreamingRequestFrame() const { return streamingRequestFrame_; }
+
+    /// Return source image width, when streaming.
+    int GetSourceWidth() const { return sourceWidth_; }
+
+    /// Return source image height, when streaming.
+    int GetSourceHeight() const { return sourceHeight_; }
+
 protected:
     /// Create the GPU texture.
     virtual bool Create();
@@ -88,6 +110,18 @@ private:
     SharedPtr<Image> loadImage_;
     /// Parameter file acquired during BeginLoad.
     SharedPtr<XMLFile> loadParameters_;
+    /// Highest-detail resident mip level of the source image.
+    unsigned streamingLevel_;
+    /// Lowest-detail mip level of the source image kept resident.
+    unsigned streamingLowLevel_;
+    /// Mip level requested by views.
+    unsigned requestedStreamingLevel_;
+    /// Frame number of the last streaming request.
+    unsigned streamingRequestFrame_;
+    /// Source image width.
+    int sourceWidth_;
+    /// Source image height.
+    int sourceHeight_;
 };
 
 }
@@ -167,18 +167,27 @@ public:
     OcclusionBuffer* buffer_;
 };
 
-void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
+/// Minimum number of drawables to check for visibility per parallel range.
+static const unsigned CHECK_VISIBILITY_GRAIN_SIZE = 64;
+/// Minimum number of drawables to update geometry for per parallel range.
+static const unsigned UPDATE_GEOMETRY_GRAIN_SIZE = 16;
+/// Number of visible geometries per base batch collection fragment.
+static const unsigned BASE_BATCH_FRAGMENT_SIZE = 64;
+
+/// Last assigned view ID. IDs are not reused, so that batches retained for a destroyed view are never mistaken for another view's.
+static unsigned lastViewID = 0;
+
+void CheckVisibilityWork(unsigned startIndex, unsigned endIndex, PerThreadSceneResult& result, void* data)
 {
-    View* view = reinterpret_cast<View*>(item->aux_);
-    Drawable** start = reinterpret_cast<Drawable**>(item->start_);
-    Drawable** end = reinterpret_cast<Drawable**>(item->end_);
+    View* view = reinterpret_cast<View*>(data);
+    Drawable** start = &view->tempDrawables_[0][0] + startIndex;
+    Drawable** end = &view->tempDrawables_[0][0] + endIndex;
     OcclusionBuffer* buffer = view->occlusionBuffer_;
     const Matrix3x4& viewMatrix = view->cullCamera_->GetView();
     Vector3 viewZ = Vector3(viewMatrix.m20_, viewMatrix.m21_, viewMatrix.m22_);
     Vector3 absViewZ = viewZ.Abs();
     unsigned cameraViewMask = view->cullCamera_->GetViewMask();
     bool cameraZoneOverride = view->cameraZoneOverride_;
-    PerThreadSceneResult& result = view->sceneResults_[threadIndex];
 
     while (start != end)
     {
@@ -244,18 +253,52 @@ void ProcessLightWork(const WorkItem* item, unsigned threadIndex)
     view->ProcessLight(*query, threadIndex);
 }
 
-void UpdateDrawableGeometriesWork(const WorkItem* item, unsigned threadIndex)
+void UpdateDrawableGeometriesWork(unsigned startIndex, unsigned endIndex, unsigned threadIndex, void* data)
 {
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    Drawable** start = reinterpret_cast<Drawable**>(item->start_);
-    Drawable** end = reinterpret_cast<Drawable**>(item->end_);
+    View* view = reinterpret_cast<View*>(data);
 
-    while (start != end)
+    for (auto i = startIndex; i < endIndex; ++i)
     {
-        Drawable* drawable = *start++;
+        Drawable* drawable = view->threadedGeometries_[i];
         // We may leave null pointer holes in the queue if a drawable is found out to require a main thread update
         if (drawable)
-            drawable->UpdateGeometry(frame);
+            drawable->UpdateGeometry(view->frame_);
+    }
+}
+
+void CollectBaseBatchesWork(unsigned startIndex, unsigned endIndex, unsigned threadIndex, void* data)
+{
+    View* view = reinterpret_cast<View*>(data);
+    unsigned numGeometries = view->geometries_.Size();
+
+    for (auto i = startIndex; i < endIndex; ++i)
+    {
+        BaseBatchFragment& fragment = view->baseBatchFragments_[i];
+        unsigned end = Min((i + 1) * BASE_BATCH_FRAGMENT_SIZE, numGeometries);
+
+        for (auto j = i * BASE_BATCH_FRAGMENT_SIZE; j < end; ++j)
+            view->CollectBaseBatches(view->geometries_[j], fragment);
+    }
+}
+
+void AddBaseBatchesWork(unsigned startIndex, unsigned endIndex, unsigned threadIndex, void* data)
+{
+    View* view = reinterpret_cast<View*>(data);
+    unsigned numFragments = (view->geometries_.Size() + BASE_BATCH_FRAGMENT_SIZE - 1) / BASE_BATCH_FRAGMENT_SIZE;
+
+    for (auto i = startIndex; i < endIndex; ++i)
+    {
+        const ScenePassInfo& info = view->scenePasses_[i];
+        // Scene passes sharing a batch queue have their batches stored under the first of them
+        if (info.queueIndex_ != i)
+            continue;
+
+        for (auto j = 0u; j < numFragments; ++j)
+        {
+            PODVector<PendingBatch>& batches = view->baseBatchFragments_[j].batches_[i];
+            for (PODVector<PendingBatch>::Iterator k = batches.Begin(); k != batches.End(); ++k)
+                view->AddBatchToQueue(*info.batchQueue_, k->batch_, k->tech_, k->allowInstancing_);
+        }
     }
 }
 
@@ -309,6 +352,11 @@ View::View(Context* context) :
     tempDrawables_.Resize(numThreads);
     sceneResults_.Resize(numThreads);
     frame_.camera_ = 0;
+
+    id_ = ++lastViewID;
+    retainedBatchesVersion_ = 0;
+    retainedMaterialQuality_ = -1;
+    retainBatches_ = false;
 }
 
 View::~View()
@@ -452,6 +500,16 @@ bool View::Define(RenderSurface* renderTarget, Viewport* viewport)
             info.batchQueue_ = &j->second_;
             SetQueueShaderDefines(*info.batchQueue_, command);
 
+            info.queueIndex_ = scenePasses_.Size();
+            for (auto k = 0u; k < scenePasses_.Size(); ++k)
+            {
+                if (scenePasses_[k].batchQueue_ == info.batchQueue_)
+                {
+                    info.queueIndex_ = k;
+                    break;
+                }
+            }
+
             scenePasses_.Push(info);
         }
         // Allow a custom forward light pass
@@ -586,6 +644,8 @@ void View::Render()
     }
 
     UpdateGeometries();
+    // Skinned models updated by this view have added their matrices to the skinning palette
+    renderer_->UpdateSkinPaletteTexture();
 
     // Allocate screen buffers as necessary
     AllocateScreenBuffers();
@@ -884,30 +944,7 @@ void View::GetDrawables()
             result.maxZ_ = 0.0f;
         }
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = tempDrawables.Size() / numWorkItems;
-
-        PODVector<Drawable*>::Iterator start = tempDrawables.Begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = CheckVisibilityWork;
-            item->aux_ = this;
-
-            PODVector<Drawable*>::Iterator end = tempDrawables.End();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
-
-        queue->Complete(M_MAX_UNSIGNED);
+        queue->ParallelReduce(tempDrawables.Size(), CheckVisibilityWork, this, sceneResults_, CHECK_VISIBILITY_GRAIN_SIZE);
     }
 
     // Combine lights, geometries & scene Z range from the threads
@@ -958,6 +995,7 @@ void View::GetBatches()
 
     nonThreadedGeometries_.Clear();
     threadedGeometries_.Clear();
+    uploadGeometries_.Clear();
 
     ProcessLights();
     GetLightBatches();
@@ -1084,6 +1122,11 @@ void View::GetLightBatches()
                                 nonThreadedGeometries_.Push(drawable);
                             else if (type == UPDATE_WORKER_THREAD)
                                 threadedGeometries_.Push(drawable);
+                            else if (type == UPDATE_WORKER_THREAD_UPLOAD)
+                            {
+                                threadedGeometries_.Push(drawable);
+                                uploadGeometries_.Push(drawable);
+                            }
                         }
 
                         const Vector<SourceBatch>& batches = drawable->GetBatches();
@@ -1183,6 +1226,10 @@ void View::GetBaseBatches()
 {
     FLOCKSDK_PROFILE(GetBaseBatches);
 
+    retainBatches_ = renderer_->GetRetainStaticBatches();
+    if (retainBatches_)
+        UpdateRetainedBatchesVersion();
+
     for (PODVector<Drawable*>::ConstIterator i = geometries_.Begin(); i != geometries_.End(); ++i)
     {
         Drawable* drawable = *i;
@@ -1191,82 +1238,314 @@ void View::GetBaseBatches()
             nonThreadedGeometries_.Push(drawable);
         else if (type == UPDATE_WORKER_THREAD)
             threadedGeometries_.Push(drawable);
+        else if (type == UPDATE_WORKER_THREAD_UPLOAD)
+        {
+            threadedGeometries_.Push(drawable);
+            uploadGeometries_.Push(drawable);
+        }
+    }
 
-        const Vector<SourceBatch>& batches = drawable->GetBatches();
-        bool vertexLightsProcessed = false;
+    // Collect the batches in worker threads into fixed-size fragments of the geometry list, so that adding them to the queues
+    // fragment by fragment gives the same order as a single-threaded pass
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    unsigned numFragments = (geometries_.Size() + BASE_BATCH_FRAGMENT_SIZE - 1) / BASE_BATCH_FRAGMENT_SIZE;
+    if (baseBatchFragments_.Size() < numFragments)
+        baseBatchFragments_.Resize(numFragments);
 
-        for (auto j = 0u; j < batches.Size(); ++j)
-        {
-            const SourceBatch& srcBatch = batches[j];
+    for (auto i = 0u; i < numFragments; ++i)
+    {
+        BaseBatchFragment& fragment = baseBatchFragments_[i];
+        fragment.batches_.Resize(scenePasses_.Size());
+        for (auto j = 0u; j < fragment.batches_.Size(); ++j)
+            fragment.batches_[j].Clear();
+        fragment.auxViewMaterials_.Clear();
+        fragment.streamingMaterials_.Clear();
+    }
 
-            // Check here if the material refers to a rendertarget texture with camera(s) attached
-            // Only check this for backbuffer views (null rendertarget)
-            if (srcBatch.material_ && srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_ && !renderTarget_)
-                CheckMaterialForAuxView(srcBatch.material_);
+    queue->ParallelFor(numFragments, CollectBaseBatchesWork, this);
 
-            Technique* tech = GetTechnique(drawable, srcBatch.material_);
-            if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
-                continue;
+    // Check auxiliary views, find vertex light queues and make sure pass shaders are loaded on the main thread, as these
+    // are not thread-safe
+    PODVector<Pass*> lastPasses(scenePasses_.Size());
+    for (auto i = 0u; i < lastPasses.Size(); ++i)
+        lastPasses[i] = 0;
 
-            // Check each of the scene passes
-            for (unsigned k = 0; k < scenePasses_.Size(); ++k)
-            {
-                ScenePassInfo& info = scenePasses_[k];
-                // Skip forward base pass if the corresponding litbase pass already exists
-                if (info.passIndex_ == basePassIndex_ && j < 32 && drawable->HasBasePass(j))
-                    continue;
+    for (auto i = 0u; i < numFragments; ++i)
+    {
+        BaseBatchFragment& fragment = baseBatchFragments_[i];
 
-                Pass* pass = tech->GetSupportedPass(info.passIndex_);
-                if (!pass)
-                    continue;
+        for (PODVector<Material*>::ConstIterator j = fragment.auxViewMaterials_.Begin(); j != fragment.auxViewMaterials_.End(); ++j)
+        {
+            if ((*j)->GetAuxViewFrameNumber() != frame_.frameNumber_)
+                CheckMaterialForAuxView(*j);
+        }
 
-                Batch destBatch(srcBatch);
-                destBatch.pass_ = pass;
-                destBatch.zone_ = GetZone(drawable);
-                destBatch.isBase_ = true;
-                destBatch.lightMask_ = (unsigned char)GetLightMask(drawable);
+        for (PODVector<Pair<Material*, float> >::ConstIterator j = fragment.streamingMaterials_.Begin();
+             j != fragment.streamingMaterials_.End(); ++j)
+            RequestTextureStreaming(j->first_, j->second_);
 
-                if (info.vertexLights_)
+        for (auto j = 0u; j < scenePasses_.Size(); ++j)
+        {
+            PODVector<PendingBatch>& batches = fragment.batches_[j];
+
+            for (PODVector<PendingBatch>::Iterator k = batches.Begin(); k != batches.End(); ++k)
+            {
+                if (k->vertexLights_)
                 {
-                    const PODVector<Light*>& drawableVertexLights = drawable->GetVertexLights();
-                    if (drawableVertexLights.Size() && !vertexLightsProcessed)
+                    // Find a vertex light queue. If not found, create new
+                    const PODVector<Light*>& drawableVertexLights = k->drawable_->GetVertexLights();
+                    unsigned long long hash = GetVertexLightQueueHash(drawableVertexLights);
+                    HashMap<unsigned long long, LightBatchQueue>::Iterator l = vertexLightQueues_.Find(hash);
+                    if (l == vertexLightQueues_.End())
                     {
-                        // Limit vertex lights. If this is a deferred opaque batch, remove converted per-pixel lights,
-                        // as they will be rendered as light volumes in any case, and drawing them also as vertex lights
-                        // would result in double lighting
-                        drawable->LimitVertexLights(deferred_ && destBatch.pass_->GetBlendMode() == BLEND_REPLACE);
-                        vertexLightsProcessed = true;
+                        l = vertexLightQueues_.Insert(MakePair(hash, LightBatchQueue()));
+                        l->second_.light_ = 0;
+                        l->second_.shadowMap_ = 0;
+                        l->second_.vertexLights_ = drawableVertexLights;
                     }
 
-                    if (drawableVertexLights.Size())
-                    {
-                        // Find a vertex light queue. If not found, create new
-                        unsigned long long hash = GetVertexLightQueueHash(drawableVertexLights);
-                        HashMap<unsigned long long, LightBatchQueue>::Iterator i = vertexLightQueues_.Find(hash);
-                        if (i == vertexLightQueues_.End())
-                        {
-                            i = vertexLightQueues_.Insert(MakePair(hash, LightBatchQueue()));
-                            i->second_.light_ = 0;
-                            i->second_.shadowMap_ = 0;
-                            i->second_.vertexLights_ = drawableVertexLights;
-                        }
+                    k->batch_.lightQueue_ = &(l->second_);
+                }
 
-                        destBatch.lightQueue_ = &(i->second_);
-                    }
+                if (k->batch_.pass_ != lastPasses[j])
+                {
+                    Batch tempBatch(k->batch_);
+                    renderer_->SetBatchShaders(tempBatch, k->tech_, true, *scenePasses_[j].batchQueue_);
+                    lastPasses[j] = k->batch_.pass_;
                 }
-                else
-                    destBatch.lightQueue_ = 0;
+            }
+        }
+    }
+
+    // Fill the batch queues in worker threads, one queue per work range
+    queue->ParallelFor(scenePasses_.Size(), AddBaseBatchesWork, this);
+}
+
+void View::CollectBaseBatches(Drawable* drawable, BaseBatchFragment& fragment)
+{
+    const Vector<SourceBatch>& batches = drawable->GetBatches();
+    bool vertexLightsProcessed = false;
+
+    // Measure the on-screen size of the drawable for streaming the textures of its materials
+    if (renderer_->GetTextureStreaming())
+    {
+        float distance = cullCamera_->IsOrthographic() ? 1.0f : Max(drawable->GetDistance(), M_EPSILON);
+        float screenSize = drawable->GetWorldBoundingBox().Size().Length() * 0.5f * (float)viewSize_.y_ /
+            (distance * cullCamera_->GetHalfViewSize());
+
+        for (auto j = 0u; j < batches.Size(); ++j)
+        {
+            if (batches[j].material_)
+                fragment.streamingMaterials_.Push(MakePair(batches[j].material_.Get(), screenSize));
+        }
+    }
+
+    // Drawables with vertex lights collect their batches as usual, as the vertex lights are limited on each frame
+    if (retainBatches_ && drawable->HasStaticBatches() && drawable->GetVertexLights().Empty())
+    {
+        CollectRetainedBatches(drawable, fragment);
+        return;
+    }
 
-                bool allowInstancing = info.allowInstancing_;
-                if (allowInstancing && info.markToStencil_ && destBatch.lightMask_ != (destBatch.zone_->GetLightMask() & 0xff))
-                    allowInstancing = false;
+    for (auto j = 0u; j < batches.Size(); ++j)
+    {
+        const SourceBatch& srcBatch = batches[j];
+
+        // Check here if the material refers to a rendertarget texture with camera(s) attached
+        // Only check this for backbuffer views (null rendertarget). The check itself is done later on the main thread
+        if (srcBatch.material_ && srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_ && !renderTarget_)
+            fragment.auxViewMaterials_.Push(srcBatch.material_);
+
+        Technique* tech = GetTechnique(drawable, srcBatch.material_);
+        if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
+            continue;
+
+        // Check each of the scene passes
+        for (unsigned k = 0; k < scenePasses_.Size(); ++k)
+        {
+            ScenePassInfo& info = scenePasses_[k];
+            // Skip forward base pass if the corresponding litbase pass already exists
+            if (info.passIndex_ == basePassIndex_ && j < 32 && drawable->HasBasePass(j))
+                continue;
+
+            Pass* pass = tech->GetSupportedPass(info.passIndex_);
+            if (!pass)
+                continue;
 
-                AddBatchToQueue(*info.batchQueue_, destBatch, tech, allowInstancing);
+            PODVector<PendingBatch>& destBatches = fragment.batches_[info.queueIndex_];
+            destBatches.Resize(destBatches.Size() + 1);
+            PendingBatch& pending = destBatches.Back();
+            pending.tech_ = tech;
+            pending.drawable_ = drawable;
+            pending.vertexLights_ = false;
+
+            Batch& destBatch = pending.batch_;
+            destBatch = Batch(srcBatch);
+            destBatch.pass_ = pass;
+            destBatch.zone_ = GetZone(drawable);
+            destBatch.isBase_ = true;
+            destBatch.lightMask_ = (unsigned char)GetLightMask(drawable);
+
+            if (info.vertexLights_)
+            {
+                const PODVector<Light*>& drawableVertexLights = drawable->GetVertexLights();
+                if (drawableVertexLights.Size() && !vertexLightsProcessed)
+                {
+                    // Limit vertex lights. If this is a deferred opaque batch, remove converted per-pixel lights,
+                    // as they will be rendered as light volumes in any case, and drawing them also as vertex lights
+                    // would result in double lighting
+                    drawable->LimitVertexLights(deferred_ && destBatch.pass_->GetBlendMode() == BLEND_REPLACE);
+                    vertexLightsProcessed = true;
+                }
+
+                // The vertex light queue is looked up later on the main thread
+                pending.vertexLights_ = drawableVertexLights.Size() != 0;
             }
+
+            bool allowInstancing = info.allowInstancing_;
+            if (allowInstancing && info.markToStencil_ && destBatch.lightMask_ != (destBatch.zone_->GetLightMask() & 0xff))
+                allowInstancing = false;
+            pending.allowInstancing_ = allowInstancing;
+        }
+    }
+}
+
+void View::CollectRetainedBatches(Drawable* drawable, BaseBatchFragment& fragment)
+{
+    const Vector<SourceBatch>& batches = drawable->GetBatches();
+    RetainedBatches& retained = *drawable->GetRetainedBatches(id_, frame_.frameNumber_);
+    Zone* zone = GetZone(drawable);
+
+    // The retained batches stay valid until the scene passes, the drawable's zone or light mask, or the techniques of
+    // its materials change
+    bool valid = retained.valid_ && retained.viewVersion_ == retainedBatchesVersion_ &&
+        retained.drawableVersion_ == drawable->GetBatchesVersion() && retained.zone_ == zone &&
+        retained.zoneVersion_ == zone->GetBatchesVersion() && retained.basePassFlags_ == drawable->GetBasePassFlags() &&
+        retained.sourceBatches_.Size() == batches.Size();
+
+    for (auto j = 0u; j < batches.Size(); ++j)
+    {
+        Material* material = batches[j].material_;
+        if (material && material->GetAuxViewFrameNumber() != frame_.frameNumber_ && !renderTarget_)
+            fragment.auxViewMaterials_.Push(material);
+
+        if (valid)
+        {
+            const RetainedSourceBatch& state = retained.sourceBatches_[j];
+            Material* techMaterial = material ? material : renderer_->GetDefaultMaterial();
+            if (state.material_ != techMaterial || state.materialVersion_ != techMaterial->GetTechniquesVersion() ||
+                (state.tech_ && state.techVersion_ != state.tech_->GetPassesVersion()))
+                valid = false;
+            // The technique of a material with several techniques also depends on the LOD distance
+            else if (material && material->GetNumTechniques() > 1 && GetTechnique(drawable, material) != state.tech_)
+                valid = false;
+        }
+    }
+
+    if (!valid)
+        RetainBatches(drawable, retained, zone);
+
+    for (PODVector<RetainedBatch>::ConstIterator i = retained.batches_.Begin(); i != retained.batches_.End(); ++i)
+    {
+        // The geometry and transforms may change on every frame, so they are always taken from the source batch
+        const SourceBatch& srcBatch = batches[i->sourceIndex_];
+        if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_)
+            continue;
+
+        PODVector<PendingBatch>& destBatches = fragment.batches_[i->queueIndex_];
+        destBatches.Resize(destBatches.Size() + 1);
+        PendingBatch& pending = destBatches.Back();
+        pending.tech_ = i->tech_;
+        pending.drawable_ = drawable;
+        pending.allowInstancing_ = i->allowInstancing_;
+        pending.vertexLights_ = false;
+
+        Batch& destBatch = pending.batch_;
+        destBatch = Batch(srcBatch);
+        destBatch.pass_ = i->pass_;
+        destBatch.zone_ = zone;
+        destBatch.isBase_ = true;
+        destBatch.lightMask_ = (unsigned char)retained.lightMask_;
+    }
+}
+
+void View::RetainBatches(Drawable* drawable, RetainedBatches& retained, Zone* zone)
+{
+    const Vector<SourceBatch>& batches = drawable->GetBatches();
+
+    retained.viewVersion_ = retainedBatchesVersion_;
+    retained.drawableVersion_ = drawable->GetBatchesVersion();
+    retained.zone_ = zone;
+    retained.zoneVersion_ = zone->GetBatchesVersion();
+    retained.lightMask_ = GetLightMask(drawable);
+    retained.basePassFlags_ = drawable->GetBasePassFlags();
+    retained.sourceBatches_.Resize(batches.Size());
+    retained.batches_.Clear();
+    retained.valid_ = true;
+
+    for (auto j = 0u; j < batches.Size(); ++j)
+    {
+        const SourceBatch& srcBatch = batches[j];
+        Material* techMaterial = srcBatch.material_ ? srcBatch.material_.Get() : renderer_->GetDefaultMaterial();
+        Technique* tech = GetTechnique(drawable, srcBatch.material_);
+
+        RetainedSourceBatch& state = retained.sourceBatches_[j];
+        state.material_ = techMaterial;
+        state.materialVersion_ = techMaterial->GetTechniquesVersion();
+        state.tech_ = tech;
+        state.techVersion_ = tech ? tech->GetPassesVersion() : 0;
+        if (!tech)
+            continue;
+
+        // Check each of the scene passes
+        for (unsigned k = 0; k < scenePasses_.Size(); ++k)
+        {
+            ScenePassInfo& info = scenePasses_[k];
+            // Skip forward base pass if the corresponding litbase pass already exists
+            if (info.passIndex_ == basePassIndex_ && j < 32 && drawable->HasBasePass(j))
+                continue;
+
+            Pass* pass = tech->GetSupportedPass(info.passIndex_);
+            if (!pass)
+                continue;
+
+            bool allowInstancing = info.allowInstancing_;
+            if (allowInstancing && info.markToStencil_ && (unsigned char)retained.lightMask_ != (zone->GetLightMask() & 0xff))
+                allowInstancing = false;
+
+            retained.batches_.Resize(retained.batches_.Size() + 1);
+            RetainedBatch& retainedBatch = retained.batches_.Back();
+            retainedBatch.tech_ = tech;
+            retainedBatch.pass_ = pass;
+            retainedBatch.sourceIndex_ = j;
+            retainedBatch.queueIndex_ = info.queueIndex_;
+            retainedBatch.allowInstancing_ = allowInstancing;
         }
     }
 }
 
+void View::UpdateRetainedBatchesVersion()
+{
+    bool changed = materialQuality_ != retainedMaterialQuality_ || retainedScenePasses_.Size() != scenePasses_.Size();
+
+    for (auto i = 0u; i < scenePasses_.Size() && !changed; ++i)
+    {
+        const ScenePassInfo& info = scenePasses_[i];
+        const ScenePassInfo& retainedInfo = retainedScenePasses_[i];
+        if (info.passIndex_ != retainedInfo.passIndex_ || info.allowInstancing_ != retainedInfo.allowInstancing_ ||
+            info.markToStencil_ != retainedInfo.markToStencil_ || info.vertexLights_ != retainedInfo.vertexLights_ ||
+            info.queueIndex_ != retainedInfo.queueIndex_)
+            changed = true;
+    }
+
+    if (changed)
+    {
+        ++retainedBatchesVersion_;
+        retainedScenePasses_ = scenePasses_;
+        retainedMaterialQuality_ = materialQuality_;
+    }
+}
+
 void View::UpdateGeometries()
 {
     // Update geometries in the source view if necessary (prepare order may differ from render order)
@@ -1320,6 +1599,9 @@ void View::UpdateGeometries()
 
     // Update geometries. Split into threaded and non-threaded updates.
     {
+        Job* updateJob = 0;
+        ParallelForData updateParallelFor;
+
         if (threadedGeometries_.Size())
         {
             // In special cases (context loss, multi-view) a drawable may theoretically first have reported a threaded update, but will actually
@@ -1334,31 +1616,24 @@ void View::UpdateGeometries()
                 }
             }
 
-            int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-            int drawablesPerItem = threadedGeometries_.Size() / numWorkItems;
-
-            PODVector<Drawable*>::Iterator start = threadedGeometries_.Begin();
-            for (int i = 0; i < numWorkItems; ++i)
-            {
-                PODVector<Drawable*>::Iterator end = threadedGeometries_.End();
-                if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                    end = start + drawablesPerItem;
-
-                SharedPtr<WorkItem> item = queue->GetFreeItem();
-                item->priority_ = M_MAX_UNSIGNED;
-                item->workFunction_ = UpdateDrawableGeometriesWork;
-                item->aux_ = const_cast<FrameInfo*>(&frame_);
-                item->start_ = &(*start);
-                item->end_ = &(*end);
-                queue->AddWorkItem(item);
-
-                start = end;
-            }
+            // Queue the threaded updates as children of an empty job, so that they can be waited on after the
+            // non-threaded updates
+            updateJob = queue->CreateJob(0);
+            queue->ParallelFor(updateJob, updateParallelFor, threadedGeometries_.Size(), UpdateDrawableGeometriesWork, this,
+                UPDATE_GEOMETRY_GRAIN_SIZE);
         }
 
-        // While the work queue is processed, update non-threaded geometries
+        // While the worker threads sort the batch queues and update threaded geometries, update non-threaded geometries
         for (PODVector<Drawable*>::ConstIterator i = nonThreadedGeometries_.Begin(); i != nonThreadedGeometries_.End(); ++i)
             (*i)->UpdateGeometry(frame_);
+
+        // Then wait for the threaded updates. The main thread helps with the remaining work while waiting
+        if (updateJob)
+            queue->Join(updateJob);
+
+        // Upload the geometries prepared in worker threads, as GPU access is only allowed from the main thread
+        for (PODVector<Drawable*>::ConstIterator i = uploadGeometries_.Begin(); i != uploadGeometries_.End(); ++i)
+            (*i)->UploadGeometry(frame_);
     }
 
     // Finally ensure all threaded work has completed
@@ -2824,6 +3099,29 @@ void View::CheckMaterialForAuxView(Material* material)
     material->MarkForAuxView(frame_.frameNumber_);
 }
 
+void View::RequestTextureStreaming(Material* material, float screenSize)
+{
+    const HashMap<TextureUnit, SharedPtr<Texture> >& textures = material->GetTextures();
+    for (HashMap<TextureUnit, SharedPtr<Texture> >::ConstIterator i = textures.Begin(); i != textures.End(); ++i)
+    {
+        Texture* texture = i->second_;
+        if (!texture || !texture->GetStreaming() || texture->GetType() != Texture2D::GetTypeStatic())
+            continue;
+
+        // Use the lowest-detail level that still has at least one texel per pixel
+        Texture2D* texture2D = static_cast<Texture2D*>(texture);
+        float size = (float)Max(texture2D->GetSourceWidth(), texture2D->GetSourceHeight());
+        unsigned level = 0;
+        while (size * 0.5f >= screenSize && size > 1.0f)
+        {
+            size *= 0.5f;
+            ++level;
+        }
+
+        texture2D->RequestStreamingLevel(level, frame_.frameNumber_);
+    }
+}
+
 void View::SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& command)
 {
     String vsDefines = command.vertexShaderDefines_.Trimmed();
@@ -2845,13 +3143,16 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     if (!batch.material_)
         batch.material_ = renderer_->GetDefaultMaterial();
 
-    // Convert to instanced if possible
+    // Convert to instanced if possible. Skinned models using the skinning palette can also be instanced
     if (allowInstancing && batch.geometryType_ == GEOM_STATIC && batch.geometry_->GetIndexBuffer())
         batch.geometryType_ = GEOM_INSTANCED;
+    else if (allowInstancing && batch.geometryType_ == GEOM_SKINPALETTE && batch.geometry_->GetIndexBuffer())
+        batch.geometryType_ = GEOM_SKINPALETTE_INSTANCED;
 
-    if (batch.geometryType_ == GEOM_INSTANCED)
+    if (batch.geometryType_ == GEOM_INSTANCED || batch.geometryType_ == GEOM_SKINPALETTE_INSTANCED)
     {
         BatchGroupKey key(batch);
+        GeometryType instancedType = batch.geometryType_;
 
         HashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Find(key);
         if (i == queue.batchGroups_.End())
@@ -2859,7 +3160,7 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
             // Create a new group based on the batch
             // In case the group remains below the instancing limit, do not enable instancing shaders yet
             BatchGroup newGroup(batch);
-            newGroup.geometryType_ = GEOM_STATIC;
+            newGroup.geometryType_ = instancedType == GEOM_SKINPALETTE_INSTANCED ? GEOM_SKINPALETTE : GEOM_STATIC;
             renderer_->SetBatchShaders(newGroup, tech, allowShadows, queue);
             newGroup.CalculateSortKey();
             i = queue.batchGroups_.Insert(MakePair(key, newGroup));
@@ -2870,7 +3171,7 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
         // Convert to using instancing shaders when the instancing limit is reached
         if (oldSize < minInstances_ && (int)i->second_.instances_.Size() >= minInstances_)
         {
-            i->second_.geometryType_ = GEOM_INSTANCED;
+            i->second_.geometryType_ = instancedType;
             renderer_->SetBatchShaders(i->second_, tech, allowShadows, queue);
             i->second_.CalculateSortKey();
         }
@@ -89,6 +89,8 @@ struct ScenePassInfo
     bool vertexLights_;
     /// Batch queue.
     BatchQueue* batchQueue_;
+    /// Index of the first scene pass that uses the same batch queue.
+    unsigned queueIndex_;
 };
 
 /// Per-thread geometry, light and scene range collection structure.
@@ -104,13 +106,42 @@ struct PerThreadSceneResult
     float maxZ_;
 };
 
+/// Scene pass batch collected in a worker thread, to be added to its batch queue afterward.
+struct PendingBatch
+{
+    /// Batch.
+    Batch batch_;
+    /// Technique.
+    Technique* tech_;
+    /// Drawable, used to find the vertex light queue.
+    Drawable* drawable_;
+    /// Allow instancing flag.
+    bool allowInstancing_;
+    /// Vertex light queue needed flag.
+    bool vertexLights_;
+};
+
+/// Scene pass batches collected from a fixed-size range of visible geometries.
+struct BaseBatchFragment
+{
+    /// Batches indexed by the batch queue's scene pass index.
+    Vector<PODVector<PendingBatch> > batches_;
+    /// Materials to check for auxiliary views.
+    PODVector<Material*> auxViewMaterials_;
+    /// Materials with the on-screen size in pixels of the drawable using them, for texture streaming.
+    PODVector<Pair<Material*, float> > streamingMaterials_;
+};
+
 static const unsigned MAX_VIEWPORT_TEXTURES = 2;
 
 /// Internal structure for 3D rendering work. Created for each backbuffer and texture viewport, but not for shadow cameras.
 class FLOCKSDK_API View : public Object
 {
-    friend void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex);
+    friend void CheckVisibilityWork(unsigned startIndex, unsigned endIndex, PerThreadSceneResult& result, void* data);
     friend void ProcessLightWork(const WorkItem* item, unsigned threadIndex);
+    friend void CollectBaseBatchesWork(unsigned startIndex, unsigned endIndex, unsigned threadIndex, void* data);
+    friend void AddBaseBatchesWork(unsigned startIndex, unsigned endIndex, unsigned threadIndex, void* data);
+    friend void UpdateDrawableGeometriesWork(unsigned startIndex, unsigned endIndex, unsigned threadIndex, void* data);
 
     FLOCKSDK_OBJECT(View, Object);
 
@@ -206,6 +237,14 @@ private:
     void GetLightBatches();
     /// Get unlit batches.
     void GetBaseBatches();
+    /// Collect a visible geometry's scene pass batches. Called from worker threads.
+    void CollectBaseBatches(Drawable* drawable, BaseBatchFragment& fragment);
+    /// Collect a static drawable's scene pass batches from the batches it has retained for this view, collecting them again if they are no longer valid. Called from worker threads.
+    void CollectRetainedBatches(Drawable* drawable, BaseBatchFragment& fragment);
+    /// Collect the scene pass batches a static drawable retains for this view. Called from worker threads.
+    void RetainBatches(Drawable* drawable, RetainedBatches& retained, Zone* zone);
+    /// Start a new retained batches version if the scene passes or material quality have changed.
+    void UpdateRetainedBatchesVersion();
     /// Update geometries and sort batches.
     void UpdateGeometries();
     /// Get pixel lit batches for a certain light and drawable.
@@ -259,6 +298,8 @@ private:
     Technique* GetTechnique(Drawable* drawable, Material* material);
     /// Check if material should render an auxiliary view (if it has a camera attached.)
     void CheckMaterialForAuxView(Material* material);
+    /// Request the mip levels of a material's streaming textures needed for an on-screen size in pixels.
+    void RequestTextureStreaming(Material* material, float screenSize);
     /// Set shader defines for a batch queue if used.
     void SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& command);
     /// Choose shaders for a batch and add it to queue.
@@ -388,6 +429,18 @@ private:
     Vector<PODVector<Drawable*> > tempDrawables_;
     /// Per-thread geometries, lights and Z range collection results.
     Vector<PerThreadSceneResult> sceneResults_;
+    /// Scene pass batches collected per range of visible geometries.
+    Vector<BaseBatchFragment> baseBatchFragments_;
+    /// Scene passes of the current retained batches version.
+    PODVector<ScenePassInfo> retainedScenePasses_;
+    /// Unique view ID, used to find the scene pass batches that drawables retain for this view.
+    unsigned id_;
+    /// Version of the scene passes and material quality that retained batches are collected for.
+    unsigned retainedBatchesVersion_;
+    /// Material quality of the current retained batches version.
+    int retainedMaterialQuality_;
+    /// Retain static drawable batches flag for the current frame.
+    bool retainBatches_;
     /// Visible zones.
     PODVector<Zone*> zones_;
     /// Visible geometry objects.
@@ -396,6 +449,8 @@ private:
     PODVector<Drawable*> nonThreadedGeometries_;
     /// Geometry objects that will be updated in worker threads.
     PODVector<Drawable*> threadedGeometries_;
+    /// Geometry objects that will be updated in worker threads, then uploaded in the main thread.
+    PODVector<Drawable*> uploadGeometries_;
     /// Occluder objects.
     PODVector<Drawable*> occluders_;
     /// Lights.
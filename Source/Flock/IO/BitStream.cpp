@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/BitStream.h"
+
+namespace FlockSDK
+{
+
+BitWriter::BitWriter() :
+    numBits_(0)
+{
+}
+
+void BitWriter::WriteBits(unsigned value, unsigned numBits)
+{
+    for (auto i = 0u; i < numBits; ++i)
+    {
+        unsigned bitIndex = numBits_ & 7;
+        if (!bitIndex)
+            buffer_.Push(0);
+        if (value & (1u << i))
+            buffer_.Back() |= (unsigned char)(1u << bitIndex);
+        ++numBits_;
+    }
+}
+
+void BitWriter::WriteVarInt(int value)
+{
+    // Zigzag-encode so that small negative values also have few significant bits
+    unsigned encoded = ((unsigned)value << 1) ^ (unsigned)(value >> 31);
+    if (!encoded)
+    {
+        WriteBit(false);
+        return;
+    }
+
+    // Write the number of significant bits, then the bits below the implicit highest one
+    unsigned significantBits = 0;
+    while (significantBits < 32 && (encoded >> significantBits))
+        ++significantBits;
+
+    WriteBit(true);
+    WriteBits(significantBits - 1, 5);
+    WriteBits(encoded, significantBits - 1);
+}
+
+void BitWriter::Clear()
+{
+    buffer_.Clear();
+    numBits_ = 0;
+}
+
+BitReader::BitReader(const unsigned char* data, unsigned size) :
+    data_(data),
+    size_(data ? size : 0),
+    position_(0)
+{
+}
+
+unsigned BitReader::ReadBits(unsigned numBits)
+{
+    unsigned value = 0;
+    for (auto i = 0u; i < numBits; ++i)
+    {
+        if (position_ < size_ << 3 && (data_[position_ >> 3] & (1u << (position_ & 7))))
+            value |= 1u << i;
+        ++position_;
+    }
+
+    return value;
+}
+
+int BitReader::ReadVarInt()
+{
+    if (!ReadBit())
+        return 0;
+
+    unsigned significantBits = ReadBits(5) + 1;
+    unsigned encoded = (1u << (significantBits - 1)) | ReadBits(significantBits - 1);
+    return (int)(encoded >> 1) ^ -(int)(encoded & 1);
+}
+
+}
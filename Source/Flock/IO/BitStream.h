@@ -0,0 +1,88 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Vector.h"
+
+namespace FlockSDK
+{
+
+/// Writer that packs values at bit granularity into a byte buffer.
+class FLOCKSDK_API BitWriter
+{
+public:
+    /// Construct empty.
+    BitWriter();
+
+    /// Write the lowest bits of a value, up to 32 bits.
+    void WriteBits(unsigned value, unsigned numBits);
+    /// Write a single bit.
+    void WriteBit(bool value) { WriteBits(value ? 1 : 0, 1); }
+    /// Write a signed integer with a variable bit length. Values close to zero take only a few bits.
+    void WriteVarInt(int value);
+    /// Clear the written data.
+    void Clear();
+
+    /// Return the packed data.
+    const unsigned char* GetData() const { return buffer_.Size() ? &buffer_[0] : 0; }
+
+    /// Return size of the packed data in bytes.
+    unsigned GetSize() const { return buffer_.Size(); }
+
+    /// Return number of bits written.
+    unsigned GetNumBits() const { return numBits_; }
+
+private:
+    /// Packed data.
+    PODVector<unsigned char> buffer_;
+    /// Number of bits written.
+    unsigned numBits_;
+};
+
+/// Reader for data packed by BitWriter.
+class FLOCKSDK_API BitReader
+{
+public:
+    /// Construct with a pointer and size in bytes.
+    BitReader(const unsigned char* data, unsigned size);
+
+    /// Read a value of up to 32 bits. Bits past the end read as zero.
+    unsigned ReadBits(unsigned numBits);
+    /// Read a single bit.
+    bool ReadBit() { return ReadBits(1) != 0; }
+    /// Read a signed integer written with WriteVarInt().
+    int ReadVarInt();
+
+    /// Return whether the end of data has been reached.
+    bool IsEof() const { return position_ >= size_ << 3; }
+
+private:
+    /// Data pointer.
+    const unsigned char* data_;
+    /// Size in bytes.
+    unsigned size_;
+    /// Read position in bits.
+    unsigned position_;
+};
+
+}
@@ -56,11 +56,15 @@ static const char* openMode[] =
 #endif
 
 static const unsigned SKIP_BUFFER_SIZE = 1024;
+/// Largest possible unpacked size of a compressed block, as the block header stores sizes in 16 bits.
+static const unsigned MAX_COMPRESSED_BLOCK_SIZE = 65535;
 
 File::File(Context* context) :
     Object(context),
     mode_(FILE_READ),
     handle_(0),
+    mappedData_(0),
+    mappedPosition_(0),
     readBufferOffset_(0),
     readBufferSize_(0),
     offset_(0),
@@ -75,6 +79,8 @@ File::File(Context* context, const String &fileName, FileMode mode) :
     Object(context),
     mode_(FILE_READ),
     handle_(0),
+    mappedData_(0),
+    mappedPosition_(0),
     readBufferOffset_(0),
     readBufferSize_(0),
     offset_(0),
@@ -90,6 +96,8 @@ File::File(Context* context, PackageFile* package, const String &fileName) :
     Object(context),
     mode_(FILE_READ),
     handle_(0),
+    mappedData_(0),
+    mappedPosition_(0),
     readBufferOffset_(0),
     readBufferSize_(0),
     offset_(0),
@@ -120,8 +128,18 @@ bool File::Open(PackageFile* package, const String &fileName)
     if (!entry)
         return false;
 
-    bool success = OpenInternal(package->GetName(), FILE_READ, true);
-    if (!success)
+    if (package->IsMemoryMapped())
+    {
+        // Read straight from the mapping, no file handle is needed
+        Close();
+        package_ = package;
+        mappedData_ = package->GetMappedData();
+        mode_ = FILE_READ;
+        position_ = 0;
+        readSyncNeeded_ = false;
+        writeSyncNeeded_ = false;
+    }
+    else if (!OpenInternal(package->GetName(), FILE_READ, true))
     {
         FLOCKSDK_LOGERROR("Could not open package file " + fileName);
         return false;
@@ -164,24 +182,53 @@ unsigned File::Read(void* dest, unsigned size)
 
         while (sizeLeft)
         {
-            if (!readBuffer_ || readBufferOffset_ >= readBufferSize_)
+            if (readBufferOffset_ >= readBufferSize_)
             {
                 unsigned char blockHeaderBytes[4];
-                ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes);
+                if (!ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes))
+                {
+                    FLOCKSDK_LOGERROR("Error while reading from file " + GetName());
+                    return 0;
+                }
 
                 MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
                 unsigned unpackedSize = blockHeader.ReadUShort();
                 unsigned packedSize = blockHeader.ReadUShort();
 
-                if (!readBuffer_)
+                // Packed data can be decompressed in place from a memory mapping
+                const unsigned char* packedData;
+                if (mappedData_)
+                {
+                    if (mappedPosition_ + packedSize > package_->GetTotalSize())
+                    {
+                        FLOCKSDK_LOGERROR("Error while reading from file " + GetName());
+                        return 0;
+                    }
+                    packedData = mappedData_ + mappedPosition_;
+                    mappedPosition_ += packedSize;
+                }
+                else
+                {
+                    if (!inputBuffer_)
+                        inputBuffer_ = new unsigned char[LZ4_compressBound(MAX_COMPRESSED_BLOCK_SIZE)];
+                    /// \todo Handle errors
+                    ReadInternal(inputBuffer_.Get(), packedSize);
+                    packedData = inputBuffer_.Get();
+                }
+
+                // If the whole block is wanted, decompress directly into the destination
+                if (unpackedSize <= sizeLeft)
                 {
-                    readBuffer_ = new unsigned char[unpackedSize];
-                    inputBuffer_ = new unsigned char[LZ4_compressBound(unpackedSize)];
+                    LZ4_decompress_fast((const char*)packedData, (char*)destPtr, unpackedSize);
+                    destPtr += unpackedSize;
+                    sizeLeft -= unpackedSize;
+                    position_ += unpackedSize;
+                    continue;
                 }
 
-                /// \todo Handle errors
-                ReadInternal(inputBuffer_.Get(), packedSize);
-                LZ4_decompress_fast((const char*)inputBuffer_.Get(), (char*)readBuffer_.Get(), unpackedSize);
+                if (!readBuffer_)
+                    readBuffer_ = new unsigned char[MAX_COMPRESSED_BLOCK_SIZE];
+                LZ4_decompress_fast((const char*)packedData, (char*)readBuffer_.Get(), unpackedSize);
 
                 readBufferSize_ = unpackedSize;
                 readBufferOffset_ = 0;
@@ -329,11 +376,17 @@ void File::Close()
 {
     readBuffer_.Reset();
     inputBuffer_.Reset();
+    readBufferOffset_ = 0;
+    readBufferSize_ = 0;
 
-    if (handle_)
+    if (handle_ || mappedData_)
     {
-        fclose((FILE*)handle_);
+        if (handle_)
+            fclose((FILE*)handle_);
         handle_ = 0;
+        package_.Reset();
+        mappedData_ = 0;
+        mappedPosition_ = 0;
         position_ = 0;
         size_ = 0;
         offset_ = 0;
@@ -354,7 +407,7 @@ void File::SetName(const String &name)
 
 bool File::IsOpen() const
 {
-    return handle_ != 0;
+    return handle_ != 0 || mappedData_ != 0;
 }
 
 bool File::OpenInternal(const String &fileName, FileMode mode, bool fromPackage)
@@ -426,11 +479,26 @@ bool File::OpenInternal(const String &fileName, FileMode mode, bool fromPackage)
 
 bool File::ReadInternal(void* dest, unsigned size)
 {
+    if (mappedData_)
+    {
+        if (mappedPosition_ + size > package_->GetTotalSize())
+            return false;
+        memcpy(dest, mappedData_ + mappedPosition_, size);
+        mappedPosition_ += size;
+        return true;
+    }
+
     return fread(dest, size, 1, (FILE*)handle_) == 1;
 }
 
 void File::SeekInternal(unsigned newPosition)
 {
+    if (mappedData_)
+    {
+        mappedPosition_ = newPosition;
+        return;
+    }
+
     fseek((FILE*)handle_, newPosition, SEEK_SET);
 }
 
@@ -89,6 +89,12 @@ public:
     /// Return whether the file originates from a package.
     bool IsPackaged() const { return offset_ != 0; }
 
+    /// Return whether the file is read from a memory mapped package.
+    bool IsMemoryMapped() const { return mappedData_ != 0; }
+
+    /// Return pointer to the file contents within a memory mapped package, or null if not mapped or compressed. Wrap in a MemoryBuffer for zero-copy reading.
+    const unsigned char* GetMappedData() const { return mappedData_ && !compressed_ ? mappedData_ + offset_ : 0; }
+
 private:
     /// Open file internally using either C standard IO functions or SDL RWops for Android asset files. Return true if successful.
     bool OpenInternal(const String &fileName, FileMode mode, bool fromPackage = false);
@@ -103,6 +109,12 @@ private:
     FileMode mode_;
     /// File handle.
     void* handle_;
+    /// Memory mapped package being read from, held to keep the mapping alive.
+    SharedPtr<PackageFile> package_;
+    /// Start of the package memory mapping, or null when reading through the file handle.
+    const unsigned char* mappedData_;
+    /// Read position within the package memory mapping.
+    unsigned mappedPosition_;
     /// Read buffer for Android asset or compressed file loading.
     SharedArrayPtr<unsigned char> readBuffer_;
     /// Decompression input buffer for compressed file loading.
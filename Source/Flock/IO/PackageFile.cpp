@@ -23,17 +23,40 @@
 #include "../Precompiled.h"
 
 #include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/PackageFile.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace FlockSDK
 {
 
+/// Return package format version from the file ID, or 0 if not a package file.
+static unsigned GetPackageVersion(const String &id)
+{
+    if (id == "UPAK" || id == "ULZ4")
+        return 1;
+    else if (id == "UPK2" || id == "ULZ2")
+        return 2;
+    else
+        return 0;
+}
+
 PackageFile::PackageFile(Context* context) :
     Object(context),
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
+    version_(1),
+    mappedData_(0),
+    mappingHandle_(0),
     compressed_(false)
 {
 }
@@ -43,6 +66,9 @@ PackageFile::PackageFile(Context* context, const String &fileName, unsigned star
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
+    version_(1),
+    mappedData_(0),
+    mappingHandle_(0),
     compressed_(false)
 {
     Open(fileName, startOffset);
@@ -50,10 +76,13 @@ PackageFile::PackageFile(Context* context, const String &fileName, unsigned star
 
 PackageFile::~PackageFile()
 {
+    UnmapMemory();
 }
 
 bool PackageFile::Open(const String &fileName, unsigned startOffset)
 {
+    UnmapMemory();
+
     SharedPtr<File> file(new File(context_, fileName));
     if (!file->IsOpen())
         return false;
@@ -61,7 +90,7 @@ bool PackageFile::Open(const String &fileName, unsigned startOffset)
     // Check ID, then read the directory
     file->Seek(startOffset);
     String id = file->ReadFileID();
-    if (id != "UPAK" && id != "ULZ4")
+    if (!GetPackageVersion(id))
     {
         // If start offset has not been explicitly specified, also try to read package size from the end of file
         // to know how much we must rewind to find the package start
@@ -78,7 +107,7 @@ bool PackageFile::Open(const String &fileName, unsigned startOffset)
             }
         }
 
-        if (id != "UPAK" && id != "ULZ4")
+        if (!GetPackageVersion(id))
         {
             FLOCKSDK_LOGERROR(fileName + " is not a valid package file");
             return false;
@@ -88,11 +117,50 @@ bool PackageFile::Open(const String &fileName, unsigned startOffset)
     fileName_ = fileName;
     nameHash_ = fileName_;
     totalSize_ = file->GetSize();
-    compressed_ = id == "ULZ4";
+    compressed_ = id == "ULZ4" || id == "ULZ2";
+    version_ = GetPackageVersion(id);
+    totalDataSize_ = 0;
+    entries_.Clear();
+    directory_.Clear();
+    directoryNames_.Clear();
 
     unsigned numFiles = file->ReadUInt();
     checksum_ = file->ReadUInt();
 
+    if (version_ >= 2)
+    {
+        // Read the hash-sorted directory and name table as is, without creating strings
+        unsigned namesSize = file->ReadUInt();
+        directory_.Resize(numFiles);
+        directoryNames_.Resize(namesSize);
+        unsigned directorySize = numFiles * sizeof(PackageDirectoryEntry);
+        if ((numFiles && file->Read(&directory_[0], directorySize) != directorySize) ||
+            (namesSize && file->Read(&directoryNames_[0], namesSize) != namesSize) || (namesSize && directoryNames_.Back()))
+        {
+            FLOCKSDK_LOGERROR(fileName + " has a corrupted package directory");
+            directory_.Clear();
+            directoryNames_.Clear();
+            return false;
+        }
+
+        for (auto i = 0u; i < numFiles; ++i)
+        {
+            PackageDirectoryEntry& dirEntry = directory_[i];
+            dirEntry.entry_.offset_ += startOffset;
+            totalDataSize_ += dirEntry.entry_.size_;
+            if (dirEntry.nameOffset_ >= namesSize || (i && dirEntry.nameHash_ < directory_[i - 1].nameHash_) ||
+                (!compressed_ && dirEntry.entry_.offset_ + dirEntry.entry_.size_ > totalSize_))
+            {
+                FLOCKSDK_LOGERROR(fileName + " has a corrupted package directory");
+                directory_.Clear();
+                directoryNames_.Clear();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     for (auto i = 0u; i < numFiles; ++i)
     {
         String entryName = file->ReadString();
@@ -112,30 +180,111 @@ bool PackageFile::Open(const String &fileName, unsigned startOffset)
     return true;
 }
 
-bool PackageFile::Exists(const String &fileName) const
+bool PackageFile::MapMemory()
 {
-    bool found = entries_.Find(fileName) != entries_.End();
+    if (mappedData_)
+        return true;
+
+    if (fileName_.Empty() || !totalSize_)
+    {
+        FLOCKSDK_LOGERROR("Package file must be opened before mapping it to memory");
+        return false;
+    }
 
 #ifdef _WIN32
-    // On Windows perform a fallback case-insensitive search
-    if (!found)
+    HANDLE fileHandle = CreateFileW(GetWideNativePath(fileName_).CString(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, 0);
+    if (fileHandle == INVALID_HANDLE_VALUE)
     {
-        for (HashMap<String, PackageEntry>::ConstIterator i = entries_.Begin(); i != entries_.End(); ++i)
-        {
-            if (!i->first_.Compare(fileName, false))
-            {
-                found = true;
-                break;
-            }
-        }
+        FLOCKSDK_LOGERROR("Could not open package file " + fileName_ + " for memory mapping");
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+    CloseHandle(fileHandle);
+    if (!mapping)
+    {
+        FLOCKSDK_LOGERROR("Could not memory map package file " + fileName_);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, totalSize_);
+    if (!data)
+    {
+        CloseHandle(mapping);
+        FLOCKSDK_LOGERROR("Could not memory map package file " + fileName_);
+        return false;
     }
+
+    mappingHandle_ = mapping;
+#else
+    int fd = open(GetNativePath(fileName_).CString(), O_RDONLY);
+    if (fd < 0)
+    {
+        FLOCKSDK_LOGERROR("Could not open package file " + fileName_ + " for memory mapping");
+        return false;
+    }
+
+    // The descriptor is not needed once the mapping exists
+    void* data = mmap(0, totalSize_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        FLOCKSDK_LOGERROR("Could not memory map package file " + fileName_);
+        return false;
+    }
+#endif
+
+    mappedData_ = (unsigned char*)data;
+    return true;
+}
+
+void PackageFile::UnmapMemory()
+{
+    if (!mappedData_)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mappedData_);
+    CloseHandle((HANDLE)mappingHandle_);
+    mappingHandle_ = 0;
+#else
+    munmap(mappedData_, totalSize_);
 #endif
 
-    return found;
+    mappedData_ = 0;
+}
+
+bool PackageFile::Exists(const String &fileName) const
+{
+    return GetEntry(fileName) != 0;
 }
 
 const PackageEntry* PackageFile::GetEntry(const String &fileName) const
 {
+    if (version_ >= 2)
+    {
+        // Binary search the name hash, then compare names in case of hash collisions
+        unsigned nameHash = StringHash(fileName).Value();
+        for (PODVector<PackageDirectoryEntry>::ConstIterator i = LowerBound(directory_.Begin(), directory_.End(), nameHash);
+             i != directory_.End() && i->nameHash_ == nameHash; ++i)
+        {
+            if (fileName == &directoryNames_[i->nameOffset_])
+                return &i->entry_;
+        }
+
+#ifdef _WIN32
+        // On Windows perform a fallback case-insensitive search
+        for (PODVector<PackageDirectoryEntry>::ConstIterator i = directory_.Begin(); i != directory_.End(); ++i)
+        {
+            if (!fileName.Compare(&directoryNames_[i->nameOffset_], false))
+                return &i->entry_;
+        }
+#endif
+
+        return 0;
+    }
+
     HashMap<String, PackageEntry>::ConstIterator i = entries_.Find(fileName);
     if (i != entries_.End())
         return &i->second_;
@@ -155,4 +304,43 @@ const PackageEntry* PackageFile::GetEntry(const String &fileName) const
     return 0;
 }
 
+const HashMap<String, PackageEntry>& PackageFile::GetEntries() const
+{
+    if (version_ < 2)
+        return entries_;
+
+    MutexLock lock(entriesMutex_);
+    if (entries_.Size() != directory_.Size())
+    {
+        entries_.Clear();
+        for (PODVector<PackageDirectoryEntry>::ConstIterator i = directory_.Begin(); i != directory_.End(); ++i)
+            entries_[&directoryNames_[i->nameOffset_]] = i->entry_;
+    }
+
+    return entries_;
+}
+
+const Vector<String> PackageFile::GetEntryNames() const
+{
+    if (version_ >= 2)
+    {
+        Vector<String> names;
+        names.Reserve(directory_.Size());
+        for (PODVector<PackageDirectoryEntry>::ConstIterator i = directory_.Begin(); i != directory_.End(); ++i)
+            names.Push(&directoryNames_[i->nameOffset_]);
+        return names;
+    }
+
+    return entries_.Keys();
+}
+
+const unsigned char* PackageFile::GetEntryData(const String &fileName) const
+{
+    if (!mappedData_ || compressed_)
+        return 0;
+
+    const PackageEntry* entry = GetEntry(fileName);
+    return entry ? mappedData_ + entry->offset_ : 0;
+}
+
 }
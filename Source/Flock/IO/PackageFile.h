@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
 namespace FlockSDK
@@ -38,6 +39,20 @@ struct PackageEntry
     unsigned checksum_;
 };
 
+/// Directory record of a version 2 package file. Records are sorted by name hash to allow binary search without building a name map.
+struct PackageDirectoryEntry
+{
+    /// Compare name hash for binary search.
+    bool operator <(unsigned nameHash) const { return nameHash_ < nameHash; }
+
+    /// Hash of the file name.
+    unsigned nameHash_;
+    /// Offset of the null-terminated file name within the name table.
+    unsigned nameOffset_;
+    /// File entry.
+    PackageEntry entry_;
+};
+
 /// Stores files of a directory tree sequentially for convenient access.
 class FLOCKSDK_API PackageFile : public Object
 {
@@ -53,13 +68,15 @@ public:
 
     /// Open the package file. Return true if successful.
     bool Open(const String &fileName, unsigned startOffset = 0);
+    /// Map the opened package file into memory so that entries are read without file IO. Return true if successful.
+    bool MapMemory();
     /// Check if a file exists within the package file. This will be case-insensitive on Windows and case-sensitive on other platforms.
     bool Exists(const String &fileName) const;
     /// Return the file entry corresponding to the name, or null if not found. This will be case-insensitive on Windows and case-sensitive on other platforms.
     const PackageEntry* GetEntry(const String &fileName) const;
 
-    /// Return all file entries.
-    const HashMap<String, PackageEntry>& GetEntries() const { return entries_; }
+    /// Return all file entries. For version 2 packages the map is built on first call. Safe to call from several threads.
+    const HashMap<String, PackageEntry>& GetEntries() const;
 
     /// Return the package file name.
     const String &GetName() const { return fileName_; }
@@ -68,7 +85,7 @@ public:
     StringHash GetNameHash() const { return nameHash_; }
 
     /// Return number of files.
-    unsigned GetNumFiles() const { return entries_.Size(); }
+    unsigned GetNumFiles() const { return version_ >= 2 ? directory_.Size() : entries_.Size(); }
 
     /// Return total size of the package file.
     unsigned GetTotalSize() const { return totalSize_; }
@@ -83,11 +100,32 @@ public:
     bool IsCompressed() const { return compressed_; }
 
     /// Return list of file names in the package.
-    const Vector<String> GetEntryNames() const { return entries_.Keys(); }
+    const Vector<String> GetEntryNames() const;
+
+    /// Return package format version.
+    unsigned GetVersion() const { return version_; }
+
+    /// Return whether the package file is mapped into memory.
+    bool IsMemoryMapped() const { return mappedData_ != 0; }
+
+    /// Return the start of the memory mapping, or null if not mapped.
+    const unsigned char* GetMappedData() const { return mappedData_; }
+
+    /// Return pointer to an uncompressed entry's data within the memory mapping, or null if not mapped, compressed or not found. Wrap in a MemoryBuffer for zero-copy reading.
+    const unsigned char* GetEntryData(const String &fileName) const;
 
 private:
-    /// File entries.
-    HashMap<String, PackageEntry> entries_;
+    /// Release the memory mapping.
+    void UnmapMemory();
+
+    /// File entries. Built on demand for version 2 packages.
+    mutable HashMap<String, PackageEntry> entries_;
+    /// Mutex for building the file entries on demand, as resource cache I/O threads may request them.
+    mutable Mutex entriesMutex_;
+    /// Hash-sorted directory of a version 2 package.
+    PODVector<PackageDirectoryEntry> directory_;
+    /// Null-terminated file names of a version 2 package.
+    PODVector<char> directoryNames_;
     /// File name.
     String fileName_;
     /// Package file name hash.
@@ -98,6 +136,12 @@ private:
     unsigned totalDataSize_;
     /// Package file checksum.
     unsigned checksum_;
+    /// Package format version.
+    unsigned version_;
+    /// Memory mapped package file contents.
+    unsigned char* mappedData_;
+    /// Platform file mapping handle.
+    void* mappingHandle_;
     /// Compressed flag.
     bool compressed_;
 };
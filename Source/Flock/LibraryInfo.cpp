@@ -39,6 +39,9 @@ const char* GetCompilerDefines()
 #ifdef FLOCKSDK_SSE
     "#define FLOCKSDK_SSE\n"
 #endif
+#ifdef FLOCKSDK_AVX2
+    "#define FLOCKSDK_AVX2\n"
+#endif
 #ifdef FLOCKSDK_LUAJIT
     "#define FLOCKSDK_LUAJIT\n"
 #endif
@@ -59,6 +59,9 @@ void ProjectAndMergeEdge(Vector3 v0, Vector3 v1, Rect &rect, const Matrix4& proj
 
 Frustum::Frustum()
 {
+#ifdef FLOCKSDK_SSE
+    UpdatePlaneData();
+#endif
 }
 
 Frustum::Frustum(const Frustum& frustum)
@@ -72,6 +75,9 @@ Frustum& Frustum::operator =(const Frustum& rhs)
         planes_[i] = rhs.planes_[i];
     for (auto i = 0u; i < NUM_FRUSTUM_VERTICES; ++i)
         vertices_[i] = rhs.vertices_[i];
+#ifdef FLOCKSDK_SSE
+    memcpy(planeData_, rhs.planeData_, sizeof planeData_);
+#endif
 
     return *this;
 }
@@ -226,6 +232,92 @@ Rect Frustum::Projected(const Matrix4& projection) const
     return rect;
 }
 
+unsigned Frustum::GetInsideMask(const float* boxData, unsigned stride, unsigned count) const
+{
+    const float* centerX = boxData;
+    const float* centerY = boxData + stride;
+    const float* centerZ = boxData + 2 * stride;
+    const float* halfSizeX = boxData + 3 * stride;
+    const float* halfSizeY = boxData + 4 * stride;
+    const float* halfSizeZ = boxData + 5 * stride;
+    unsigned mask = 0;
+
+#ifdef FLOCKSDK_AVX2
+    for (auto i = 0u; i < count; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(centerX + i);
+        __m256 cy = _mm256_loadu_ps(centerY + i);
+        __m256 cz = _mm256_loadu_ps(centerZ + i);
+        __m256 ex = _mm256_loadu_ps(halfSizeX + i);
+        __m256 ey = _mm256_loadu_ps(halfSizeY + i);
+        __m256 ez = _mm256_loadu_ps(halfSizeZ + i);
+        __m256 outside = _mm256_setzero_ps();
+
+        for (auto j = 0u; j < NUM_FRUSTUM_PLANES; ++j)
+        {
+            const Plane& plane = planes_[j];
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.normal_.x_), cx),
+                _mm256_mul_ps(_mm256_set1_ps(plane.normal_.y_), cy)), _mm256_mul_ps(_mm256_set1_ps(plane.normal_.z_), cz)),
+                _mm256_set1_ps(plane.d_));
+            __m256 absDist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.absNormal_.x_), ex),
+                _mm256_mul_ps(_mm256_set1_ps(plane.absNormal_.y_), ey)), _mm256_mul_ps(_mm256_set1_ps(plane.absNormal_.z_), ez));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, _mm256_sub_ps(_mm256_setzero_ps(), absDist), _CMP_LT_OQ));
+        }
+
+        mask |= (~_mm256_movemask_ps(outside) & 0xffu) << i;
+    }
+#elif defined(FLOCKSDK_SSE)
+    for (auto i = 0u; i < count; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(centerX + i);
+        __m128 cy = _mm_loadu_ps(centerY + i);
+        __m128 cz = _mm_loadu_ps(centerZ + i);
+        __m128 ex = _mm_loadu_ps(halfSizeX + i);
+        __m128 ey = _mm_loadu_ps(halfSizeY + i);
+        __m128 ez = _mm_loadu_ps(halfSizeZ + i);
+        __m128 outside = _mm_setzero_ps();
+
+        for (auto j = 0u; j < NUM_FRUSTUM_PLANES; ++j)
+        {
+            const Plane& plane = planes_[j];
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal_.x_), cx),
+                _mm_mul_ps(_mm_set1_ps(plane.normal_.y_), cy)), _mm_mul_ps(_mm_set1_ps(plane.normal_.z_), cz)),
+                _mm_set1_ps(plane.d_));
+            __m128 absDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.absNormal_.x_), ex),
+                _mm_mul_ps(_mm_set1_ps(plane.absNormal_.y_), ey)), _mm_mul_ps(_mm_set1_ps(plane.absNormal_.z_), ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), absDist)));
+        }
+
+        mask |= (~_mm_movemask_ps(outside) & 0xfu) << i;
+    }
+#else
+    for (auto i = 0u; i < count; ++i)
+    {
+        Vector3 center(centerX[i], centerY[i], centerZ[i]);
+        Vector3 edge(halfSizeX[i], halfSizeY[i], halfSizeZ[i]);
+        bool inside = true;
+
+        for (auto j = 0u; j < NUM_FRUSTUM_PLANES; ++j)
+        {
+            const Plane& plane = planes_[j];
+            float dist = plane.normal_.DotProduct(center) + plane.d_;
+            float absDist = plane.absNormal_.DotProduct(edge);
+
+            if (dist < -absDist)
+            {
+                inside = false;
+                break;
+            }
+        }
+
+        if (inside)
+            mask |= 1u << i;
+    }
+#endif
+
+    return count < 32 ? mask & ((1u << count) - 1) : mask;
+}
+
 void Frustum::UpdatePlanes()
 {
     planes_[PLANE_NEAR].Define(vertices_[2], vertices_[1], vertices_[0]);
@@ -245,6 +337,23 @@ void Frustum::UpdatePlanes()
         }
     }
 
+#ifdef FLOCKSDK_SSE
+    UpdatePlaneData();
+#endif
+}
+
+#ifdef FLOCKSDK_SSE
+void Frustum::UpdatePlaneData()
+{
+    for (auto i = 0u; i < NUM_FRUSTUM_SIMD_PLANES; ++i)
+    {
+        const Plane& plane = planes_[i % NUM_FRUSTUM_PLANES];
+        planeData_[0][i] = plane.normal_.x_;
+        planeData_[1][i] = plane.normal_.y_;
+        planeData_[2][i] = plane.normal_.z_;
+        planeData_[3][i] = plane.d_;
+    }
 }
+#endif
 
 }
@@ -28,6 +28,10 @@
 #include "../Math/Rect.h"
 #include "../Math/Sphere.h"
 
+#ifdef FLOCKSDK_AVX2
+#include <immintrin.h>
+#endif
+
 namespace FlockSDK
 {
 
@@ -44,6 +48,7 @@ enum FrustumPlane
 
 static const unsigned NUM_FRUSTUM_PLANES = 6;
 static const unsigned NUM_FRUSTUM_VERTICES = 8;
+static const unsigned NUM_FRUSTUM_SIMD_PLANES = 8;
 
 /// Convex constructed of 6 planes.
 class FLOCKSDK_API Frustum
@@ -119,6 +124,13 @@ public:
     /// Test if a bounding box is inside, outside or intersects.
     Intersection IsInside(const BoundingBox& box) const
     {
+#ifdef FLOCKSDK_SSE
+        int outsideMask, intersectMask;
+        TestPlanes(box, outsideMask, intersectMask);
+        if (outsideMask)
+            return OUTSIDE;
+        return intersectMask ? INTERSECTS : INSIDE;
+#else
         Vector3 center = box.Center();
         Vector3 edge = center - box.min_;
         bool allInside = true;
@@ -136,11 +148,17 @@ public:
         }
 
         return allInside ? INSIDE : INTERSECTS;
+#endif
     }
 
     /// Test if a bounding box is (partially) inside or outside.
     Intersection IsInsideFast(const BoundingBox& box) const
     {
+#ifdef FLOCKSDK_SSE
+        int outsideMask, intersectMask;
+        TestPlanes(box, outsideMask, intersectMask);
+        return outsideMask ? OUTSIDE : INSIDE;
+#else
         Vector3 center = box.Center();
         Vector3 edge = center - box.min_;
 
@@ -155,8 +173,58 @@ public:
         }
 
         return INSIDE;
+#endif
     }
 
+#ifdef FLOCKSDK_SSE
+    /// Test a bounding box against all planes at once. Return bitmasks of the planes the box is outside of and intersecting.
+    void TestPlanes(const BoundingBox& box, int& outsideMask, int& intersectMask) const
+    {
+        // Multiply and add separately in the same order as the scalar test so that the distances round the same way
+        Vector3 boxCenter = box.Center();
+        Vector3 halfSize = boxCenter - box.min_;
+#ifdef FLOCKSDK_AVX2
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+        __m256 nx = _mm256_loadu_ps(planeData_[0]);
+        __m256 ny = _mm256_loadu_ps(planeData_[1]);
+        __m256 nz = _mm256_loadu_ps(planeData_[2]);
+        __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_set1_ps(boxCenter.x_)),
+            _mm256_mul_ps(ny, _mm256_set1_ps(boxCenter.y_))), _mm256_mul_ps(nz, _mm256_set1_ps(boxCenter.z_))),
+            _mm256_loadu_ps(planeData_[3]));
+        __m256 absDist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_and_ps(nx, absMask), _mm256_set1_ps(halfSize.x_)),
+            _mm256_mul_ps(_mm256_and_ps(ny, absMask), _mm256_set1_ps(halfSize.y_))),
+            _mm256_mul_ps(_mm256_and_ps(nz, absMask), _mm256_set1_ps(halfSize.z_)));
+        outsideMask = _mm256_movemask_ps(_mm256_cmp_ps(dist, _mm256_sub_ps(_mm256_setzero_ps(), absDist), _CMP_LT_OQ));
+        intersectMask = _mm256_movemask_ps(_mm256_cmp_ps(dist, absDist, _CMP_LT_OQ));
+#else
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 cx = _mm_set1_ps(boxCenter.x_);
+        const __m128 cy = _mm_set1_ps(boxCenter.y_);
+        const __m128 cz = _mm_set1_ps(boxCenter.z_);
+        const __m128 ex = _mm_set1_ps(halfSize.x_);
+        const __m128 ey = _mm_set1_ps(halfSize.y_);
+        const __m128 ez = _mm_set1_ps(halfSize.z_);
+        outsideMask = 0;
+        intersectMask = 0;
+        for (auto i = 0u; i < NUM_FRUSTUM_SIMD_PLANES; i += 4)
+        {
+            __m128 nx = _mm_loadu_ps(&planeData_[0][i]);
+            __m128 ny = _mm_loadu_ps(&planeData_[1][i]);
+            __m128 nz = _mm_loadu_ps(&planeData_[2][i]);
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_mul_ps(nz, cz)),
+                _mm_loadu_ps(&planeData_[3][i]));
+            __m128 absDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex), _mm_mul_ps(_mm_and_ps(ny, absMask), ey)),
+                _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+            outsideMask |= _mm_movemask_ps(_mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), absDist))) << i;
+            intersectMask |= _mm_movemask_ps(_mm_cmplt_ps(dist, absDist)) << i;
+        }
+#endif
+    }
+#endif
+
+    /// Test up to 32 bounding boxes packed as center X, Y, Z and half size X, Y, Z rows of the given stride. Return a bitmask of the boxes that are (partially) inside. The rows must be readable up to a multiple of 8 boxes.
+    unsigned GetInsideMask(const float* boxData, unsigned stride, unsigned count) const;
+
     /// Return distance of a point to the frustum, or 0 if inside.
     float Distance(const Vector3 &point) const
     {
@@ -176,11 +244,19 @@ public:
 
     /// Update the planes. Called internally.
     void UpdatePlanes();
+#ifdef FLOCKSDK_SSE
+    /// Copy the planes into the structure-of-arrays plane data. Called internally.
+    void UpdatePlaneData();
+#endif
 
     /// Frustum planes.
     Plane planes_[NUM_FRUSTUM_PLANES];
     /// Frustum vertices.
     Vector3 vertices_[NUM_FRUSTUM_VERTICES];
+#ifdef FLOCKSDK_SSE
+    /// Plane normal X, Y, Z and D components in structure-of-arrays form for SIMD tests. The last two planes repeat the first two.
+    float planeData_[4][NUM_FRUSTUM_SIMD_PLANES];
+#endif
 };
 
 }
@@ -272,17 +272,31 @@ Quaternion Quaternion::Slerp(const Quaternion &rhs, float t) const
         t2 = t;
     }
 
+#ifdef FLOCKSDK_SSE
+    __m128 q1 = _mm_mul_ps(_mm_loadu_ps(&w_), _mm_set1_ps(t1));
+    __m128 q2 = _mm_mul_ps(_mm_loadu_ps(&rhs.w_), _mm_set1_ps(sign * t2));
+    return Quaternion(_mm_add_ps(q1, q2));
+#else
     return *this * t1 + (rhs * sign) * t2;
+#endif
 }
 
 Quaternion Quaternion::Nlerp(const Quaternion &rhs, float t, bool shortestPath) const
 {
+#ifdef FLOCKSDK_SSE
+    __m128 q1 = _mm_loadu_ps(&w_);
+    __m128 q2 = _mm_loadu_ps(&rhs.w_);
+    if (shortestPath && DotProduct(rhs) < 0.0f)
+        q2 = _mm_xor_ps(q2, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000UL)));
+    Quaternion result(_mm_add_ps(q1, _mm_mul_ps(_mm_sub_ps(q2, q1), _mm_set1_ps(t))));
+#else
     Quaternion result;
     float fCos = DotProduct(rhs);
     if (fCos < 0.0f && shortestPath)
         result = (*this) + (((-rhs) - (*this)) * t);
     else
         result = (*this) + ((rhs - (*this)) * t);
+#endif
     result.Normalize();
     return result;
 }
@@ -31,6 +31,7 @@
 #include "../Network/Connection.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
+#include "../Network/NetworkInterest.h"
 #include "../Network/NetworkPriority.h"
 #include "../Network/Protocol.h"
 #include "../Resource/ResourceCache.h"
@@ -62,7 +63,8 @@ Connection::Connection(Context* context, bool isClient, kNet::SharedPtr<kNet::Me
     isClient_(isClient),
     connectPending_(false),
     sceneLoaded_(false),
-    logStatistics_(false)
+    logStatistics_(false),
+    bufferMessages_(false)
 {
     sceneState_.connection_ = this;
 
@@ -101,6 +103,22 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
         return;
     }
 
+    // During a parallel server update only serialize the message, as kNet message queuing is not thread-safe
+    if (bufferMessages_)
+    {
+        BufferedMessage buffered;
+        buffered.msgID_ = msgID;
+        buffered.offset_ = bufferedData_.GetSize();
+        buffered.size_ = numBytes;
+        buffered.contentID_ = contentID;
+        buffered.reliable_ = reliable;
+        buffered.inOrder_ = inOrder;
+        bufferedMessages_.Push(buffered);
+        if (numBytes)
+            bufferedData_.Write(data, numBytes);
+        return;
+    }
+
     kNet::NetworkMessage* msg = connection_->StartNewMessage((unsigned long)msgID, numBytes);
     if (!msg)
     {
@@ -243,8 +261,12 @@ void Connection::SendServerUpdate()
     nodesToProcess_.Insert(sceneID);
     ProcessNode(sceneID);
 
-    // Then go through all dirtied nodes
-    nodesToProcess_.Insert(sceneState_.dirtyNodes_);
+    // Then go through all dirtied nodes, or only the relevant ones if interest management is in use
+    NetworkInterest* interest = scene_->GetComponent<NetworkInterest>();
+    if (interest && interest->IsEnabledEffective())
+        ProcessInterest(interest);
+    else
+        nodesToProcess_.Insert(sceneState_.dirtyNodes_);
     nodesToProcess_.Erase(sceneID); // Do not process the root node twice
 
     while (nodesToProcess_.Size())
@@ -254,6 +276,25 @@ void Connection::SendServerUpdate()
     }
 }
 
+void Connection::WriteServerUpdate()
+{
+    bufferMessages_ = true;
+    SendServerUpdate();
+    SendRemoteEvents();
+    SendPackages();
+    bufferMessages_ = false;
+}
+
+void Connection::SendBufferedMessages()
+{
+    const unsigned char* data = bufferedData_.GetData();
+    for (auto i = bufferedMessages_.Begin(); i != bufferedMessages_.End(); ++i)
+        SendMessage(i->msgID_, i->reliable_, i->inOrder_, data + i->offset_, i->size_, i->contentID_);
+
+    bufferedMessages_.Clear();
+    bufferedData_.Clear();
+}
+
 void Connection::SendClientUpdate()
 {
     if (!scene_ || !sceneLoaded_)
@@ -315,7 +356,7 @@ void Connection::SendRemoteEvents()
 
 void Connection::SendPackages()
 {
-    while (!uploads_.Empty() && connection_->NumOutboundMessagesPending() < 1000)
+    while (!uploads_.Empty() && connection_->NumOutboundMessagesPending() + bufferedMessages_.Size() < 1000)
     {
         unsigned char buffer[PACKAGE_FRAGMENT_SIZE];
         for (auto i = uploads_.Begin(); i != uploads_.End();)
@@ -524,6 +565,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             }
 
             // Read initial attributes, then snap the motion smoothing immediately to the end
+            node->ResetNetworkBaseline();
             node->ReadDeltaUpdate(msg);
             auto *transform = node->GetComponent<SmoothedTransform>();
             if (transform)
@@ -564,6 +606,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
                 }
 
                 // Read initial attributes and apply
+                component->ResetNetworkBaseline();
                 component->ReadDeltaUpdate(msg);
                 component->ApplyAttributes();
             }
@@ -648,6 +691,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
                 }
 
                 // Read initial attributes and apply
+                component->ResetNetworkBaseline();
                 component->ReadDeltaUpdate(msg);
                 component->ApplyAttributes();
             }
@@ -1111,6 +1155,9 @@ void Connection::ProcessNode(unsigned nodeID)
             // would be enough. However, this may be better due to the client not possibly having updated parenting
             // information at the time of receiving this message
             SendMessage(MSG_REMOVENODE, true, true, msg_);
+
+            // Releasing the weak references is not thread-safe, as other connections may refer to the same node
+            MutexLock lock(scene_->GetReplicationMutex());
             sceneState_.nodeStates_.Erase(nodeID);
         }
         else
@@ -1130,6 +1177,58 @@ void Connection::ProcessNode(unsigned nodeID)
     }
 }
 
+void Connection::ProcessInterest(NetworkInterest* interest)
+{
+    interest->GetRelevantNodes(position_, relevantNodes_, deferredNodes_);
+
+    // Remove the nodes that have left the area of interest from the client
+    for (auto i = sceneState_.nodeStates_.Begin(); i != sceneState_.nodeStates_.End();)
+    {
+        auto current = i++;
+        unsigned nodeID = current->first_;
+        if (relevantNodes_.Contains(nodeID))
+            continue;
+
+        msg_.Clear();
+        msg_.WriteNetID(nodeID);
+        SendMessage(MSG_REMOVENODE, true, true, msg_);
+        sceneState_.dirtyNodes_.Erase(nodeID);
+
+        // The node and its components stay alive, so they must stop referring to the states before they are erased
+        MutexLock lock(scene_->GetReplicationMutex());
+        NodeReplicationState& nodeState = current->second_;
+        if (nodeState.node_)
+        {
+            nodeState.node_->RemoveReplicationState(&nodeState);
+            for (auto j = nodeState.componentStates_.Begin(); j != nodeState.componentStates_.End(); ++j)
+            {
+                if (j->second_.component_)
+                    j->second_.component_->RemoveReplicationState(&j->second_);
+            }
+        }
+        sceneState_.nodeStates_.Erase(current);
+    }
+
+    // Create the nodes that have entered the area of interest
+    for (auto i = relevantNodes_.Begin(); i != relevantNodes_.End(); ++i)
+    {
+        if (!sceneState_.nodeStates_.Contains(*i))
+            nodesToProcess_.Insert(*i);
+    }
+
+    // Update the dirty nodes that are relevant and in a cell due for an update. Dirty nodes outside the area are
+    // forgotten, as they will be sent in full when entering
+    for (auto i = sceneState_.dirtyNodes_.Begin(); i != sceneState_.dirtyNodes_.End();)
+    {
+        auto current = i++;
+        unsigned nodeID = *current;
+        if (!relevantNodes_.Contains(nodeID))
+            sceneState_.dirtyNodes_.Erase(current);
+        else if (!deferredNodes_.Contains(nodeID))
+            nodesToProcess_.Insert(nodeID);
+    }
+}
+
 void Connection::ProcessNewNode(Node* node)
 {
     // Process depended upon nodes first, if they are dirty
@@ -1147,11 +1246,14 @@ void Connection::ProcessNewNode(Node* node)
     NodeReplicationState& nodeState = sceneState_.nodeStates_[node->GetID()];
     nodeState.connection_ = this;
     nodeState.sceneState_ = &sceneState_;
-    nodeState.node_ = node;
-    node->AddReplicationState(&nodeState);
+    {
+        MutexLock lock(scene_->GetReplicationMutex());
+        nodeState.node_ = node;
+        node->AddReplicationState(&nodeState);
 
-    // Write node's attributes
-    node->WriteInitialDeltaUpdate(msg_, timeStamp_);
+        // Write node's attributes. The initial state is shared between connections, so write it under the lock as well
+        node->WriteInitialDeltaUpdate(msg_, timeStamp_, nodeState.quantizedBaseline_);
+    }
 
     // Write node's user variables
     const VariantMap& vars = node->GetVars();
@@ -1164,7 +1266,7 @@ void Connection::ProcessNewNode(Node* node)
 
     // Write node's components
     msg_.WriteVLE(node->GetNumNetworkComponents());
-    const auto components = node->GetComponents();
+    const Vector<SharedPtr<Component>>& components = node->GetComponents();
     for (auto i = 0u; i < components.Size(); ++i)
     {
         Component *component = components[i];
@@ -1175,12 +1277,13 @@ void Connection::ProcessNewNode(Node* node)
         ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
         componentState.connection_ = this;
         componentState.nodeState_ = &nodeState;
-        componentState.component_ = component;
-        component->AddReplicationState(&componentState);
-
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
-        component->WriteInitialDeltaUpdate(msg_, timeStamp_);
+
+        MutexLock lock(scene_->GetReplicationMutex());
+        componentState.component_ = component;
+        component->AddReplicationState(&componentState);
+        component->WriteInitialDeltaUpdate(msg_, timeStamp_, componentState.quantizedBaseline_);
     }
 
     SendMessage(MSG_CREATENODE, true, true, msg_);
@@ -1241,7 +1344,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
         {
             msg_.Clear();
             msg_.WriteNetID(node->GetID());
-            node->WriteDeltaUpdate(msg_, nodeState.dirtyAttributes_, timeStamp_);
+            node->WriteDeltaUpdate(msg_, nodeState.dirtyAttributes_, timeStamp_, nodeState.quantizedBaseline_);
 
             // Write changed variables
             msg_.WriteVLE(nodeState.dirtyVars_.Size());
@@ -1284,6 +1387,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             msg_.WriteNetID(current->first_);
 
             SendMessage(MSG_REMOVECOMPONENT, true, true, msg_);
+
+            MutexLock lock(scene_->GetReplicationMutex());
             nodeState.componentStates_.Erase(current);
         }
         else
@@ -1319,7 +1424,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 {
                     msg_.Clear();
                     msg_.WriteNetID(component->GetID());
-                    component->WriteDeltaUpdate(msg_, componentState.dirtyAttributes_, timeStamp_);
+                    component->WriteDeltaUpdate(msg_, componentState.dirtyAttributes_, timeStamp_,
+                        componentState.quantizedBaseline_);
 
                     SendMessage(MSG_COMPONENTDELTAUPDATE, true, true, msg_);
 
@@ -1347,14 +1453,16 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
                 componentState.connection_ = this;
                 componentState.nodeState_ = &nodeState;
-                componentState.component_ = component;
-                component->AddReplicationState(&componentState);
-
                 msg_.Clear();
                 msg_.WriteNetID(node->GetID());
                 msg_.WriteStringHash(component->GetType());
                 msg_.WriteNetID(component->GetID());
-                component->WriteInitialDeltaUpdate(msg_, timeStamp_);
+                {
+                    MutexLock lock(scene_->GetReplicationMutex());
+                    componentState.component_ = component;
+                    component->AddReplicationState(&componentState);
+                    component->WriteInitialDeltaUpdate(msg_, timeStamp_, componentState.quantizedBaseline_);
+                }
 
                 SendMessage(MSG_CREATECOMPONENT, true, true, msg_);
             }
@@ -41,6 +41,7 @@ namespace FlockSDK
 
 class File;
 class MemoryBuffer;
+class NetworkInterest;
 class Node;
 class Scene;
 class Serializable;
@@ -59,6 +60,23 @@ struct RemoteEvent
     bool inOrder_;
 };
 
+/// Message serialized during a parallel server update, to be sent from the main thread.
+struct BufferedMessage
+{
+    /// Message ID.
+    int msgID_;
+    /// Offset of the message data in the buffer.
+    unsigned offset_;
+    /// Message data size.
+    unsigned size_;
+    /// Content ID.
+    unsigned contentID_;
+    /// Reliable flag.
+    bool reliable_;
+    /// In order flag.
+    bool inOrder_;
+};
+
 /// Package file receive transfer.
 struct PackageDownload
 {
@@ -144,6 +162,10 @@ public:
     void SendRemoteEvents();
     /// Send package files to client. Called by network.
     void SendPackages();
+    /// Serialize scene update, remote event and package messages into the outgoing buffer without sending them. Can be called from worker threads for different connections in parallel. Called by Network.
+    void WriteServerUpdate();
+    /// Send the messages serialized by WriteServerUpdate(). Called by Network.
+    void SendBufferedMessages();
     /// Process pending latest data for nodes and components.
     void ProcessPendingLatestData();
     /// Process a message from the server or client. Called by Network.
@@ -251,6 +273,8 @@ private:
     void ProcessRemoteEvent(int msgID, MemoryBuffer& msg);
     /// Process a node for sending a network update. Recurses to process depended on node(s) first.
     void ProcessNode(unsigned nodeID);
+    /// Collect the nodes to process from the area of interest, and remove the nodes that have left it.
+    void ProcessInterest(NetworkInterest* interest);
     /// Process a node that the client has not yet received.
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
@@ -286,8 +310,16 @@ private:
     HashMap<unsigned, PODVector<unsigned char> > componentLatestData_;
     /// Node ID's to process during a replication update.
     HashSet<unsigned> nodesToProcess_;
+    /// Node ID's in the area of interest during a replication update.
+    HashSet<unsigned> relevantNodes_;
+    /// Node ID's in the area of interest that are not due for an update.
+    HashSet<unsigned> deferredNodes_;
     /// Reusable message buffer.
     VectorBuffer msg_;
+    /// Messages serialized during a parallel server update.
+    PODVector<BufferedMessage> bufferedMessages_;
+    /// Data of the serialized messages.
+    VectorBuffer bufferedData_;
     /// Queued remote events.
     Vector<RemoteEvent> remoteEvents_;
     /// Scene file to load once all packages (if any) have been downloaded.
@@ -312,6 +344,8 @@ private:
     bool sceneLoaded_;
     /// Show statistics flag.
     bool logStatistics_;
+    /// Buffer messages instead of sending flag.
+    bool bufferMessages_;
 };
 
 }
@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
 #include "../Input/InputEvents.h"
@@ -34,6 +35,7 @@
 #include "../Network/HttpRequest.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
+#include "../Network/NetworkInterest.h"
 #include "../Network/NetworkPriority.h"
 #include "../Network/Protocol.h"
 #include "../Scene/Scene.h"
@@ -45,6 +47,13 @@ namespace FlockSDK
 
 static const int DEFAULT_UPDATE_FPS = 30;
 
+static void WriteServerUpdateWork(unsigned start, unsigned end, unsigned threadIndex, void* data)
+{
+    Connection** connections = reinterpret_cast<Connection**>(data);
+    for (auto i = start; i < end; ++i)
+        connections[i]->WriteServerUpdate();
+}
+
 Network::Network(Context* context) :
     Object(context),
     updateFps_(DEFAULT_UPDATE_FPS),
@@ -500,20 +509,32 @@ void Network::PostUpdate(float timeStep)
                 }
 
                 for (HashSet<Scene*>::ConstIterator i = networkScenes_.Begin(); i != networkScenes_.End(); ++i)
+                {
                     (*i)->PrepareNetworkUpdate();
+
+                    NetworkInterest* interest = (*i)->GetComponent<NetworkInterest>();
+                    if (interest && interest->IsEnabledEffective())
+                        interest->UpdateGrid();
+                }
             }
 
             {
                 FLOCKSDK_PROFILE(SendServerUpdate);
 
-                // Then send server updates for each client connection
+                // Then serialize server updates for each client connection in parallel, and send them from the main thread
+                updateConnections_.Clear();
                 for (auto i = clientConnections_.Begin();
                      i != clientConnections_.End(); ++i)
+                    updateConnections_.Push(i->second_);
+
+                if (!updateConnections_.Empty())
                 {
-                    i->second_->SendServerUpdate();
-                    i->second_->SendRemoteEvents();
-                    i->second_->SendPackages();
+                    GetSubsystem<WorkQueue>()->ParallelFor(updateConnections_.Size(), WriteServerUpdateWork,
+                        &updateConnections_[0]);
                 }
+
+                for (auto i = updateConnections_.Begin(); i != updateConnections_.End(); ++i)
+                    (*i)->SendBufferedMessages();
             }
         }
 
@@ -588,6 +609,7 @@ void Network::ConfigureNetworkSimulator()
 void RegisterNetworkLibrary(Context* context)
 {
     NetworkPriority::RegisterObject(context);
+    NetworkInterest::RegisterObject(context);
 }
 
 }
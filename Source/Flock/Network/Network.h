@@ -158,6 +158,8 @@ private:
     HashSet<StringHash> blacklistedRemoteEvents_;
     /// Networked scenes.
     HashSet<Scene*> networkScenes_;
+    /// Client connections to serialize server updates for in parallel.
+    PODVector<Connection*> updateConnections_;
     /// Update FPS.
     int updateFps_;
     /// Simulated latency (send delay) in milliseconds.
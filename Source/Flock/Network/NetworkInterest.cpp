@@ -0,0 +1,211 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Network/NetworkInterest.h"
+#include "../Scene/Scene.h"
+
+namespace FlockSDK
+{
+
+extern const char* NETWORK_CATEGORY;
+
+static const float DEFAULT_CELL_SIZE = 50.0f;
+static const float DEFAULT_VIEW_DISTANCE = 250.0f;
+static const float DEFAULT_NEAR_DISTANCE = 100.0f;
+static const unsigned DEFAULT_FAR_UPDATE_INTERVAL = 4;
+
+static inline unsigned long long PackCell(int x, int y)
+{
+    return ((unsigned long long)(unsigned)x << 32) | (unsigned)y;
+}
+
+NetworkInterest::NetworkInterest(Context* context) :
+    Component(context),
+    cellSize_(DEFAULT_CELL_SIZE),
+    viewDistance_(DEFAULT_VIEW_DISTANCE),
+    nearDistance_(DEFAULT_NEAR_DISTANCE),
+    farUpdateInterval_(DEFAULT_FAR_UPDATE_INTERVAL),
+    updateCount_(0)
+{
+}
+
+NetworkInterest::~NetworkInterest()
+{
+}
+
+void NetworkInterest::RegisterObject(Context* context)
+{
+    context->RegisterFactory<NetworkInterest>(NETWORK_CATEGORY);
+
+    FLOCKSDK_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    FLOCKSDK_ACCESSOR_ATTRIBUTE("Cell Size", GetCellSize, SetCellSize, float, DEFAULT_CELL_SIZE, AM_DEFAULT);
+    FLOCKSDK_ACCESSOR_ATTRIBUTE("View Distance", GetViewDistance, SetViewDistance, float, DEFAULT_VIEW_DISTANCE, AM_DEFAULT);
+    FLOCKSDK_ACCESSOR_ATTRIBUTE("Near Distance", GetNearDistance, SetNearDistance, float, DEFAULT_NEAR_DISTANCE, AM_DEFAULT);
+    FLOCKSDK_ACCESSOR_ATTRIBUTE("Far Update Interval", GetFarUpdateInterval, SetFarUpdateInterval, unsigned,
+        DEFAULT_FAR_UPDATE_INTERVAL, AM_DEFAULT);
+}
+
+void NetworkInterest::SetCellSize(float size)
+{
+    cellSize_ = Max(size, M_EPSILON);
+    MarkNetworkUpdate();
+}
+
+void NetworkInterest::SetViewDistance(float distance)
+{
+    viewDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void NetworkInterest::SetNearDistance(float distance)
+{
+    nearDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void NetworkInterest::SetFarUpdateInterval(unsigned interval)
+{
+    farUpdateInterval_ = Max(interval, 1U);
+    MarkNetworkUpdate();
+}
+
+void NetworkInterest::SetAlwaysRelevant(Node* node, bool enable)
+{
+    if (!node)
+        return;
+
+    if (enable)
+        alwaysRelevant_.Insert(node->GetID());
+    else
+        alwaysRelevant_.Erase(node->GetID());
+}
+
+bool NetworkInterest::IsAlwaysRelevant(Node* node) const
+{
+    return node && alwaysRelevant_.Contains(node->GetID());
+}
+
+void NetworkInterest::UpdateGrid()
+{
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+    ++updateCount_;
+
+    // Keep the cell vectors allocated, and remove the cells that stay empty afterward
+    for (HashMap<unsigned long long, PODVector<Node*> >::Iterator i = cells_.Begin(); i != cells_.End(); ++i)
+        i->second_.Clear();
+
+    const HashMap<unsigned, Node*>& nodes = scene->GetReplicatedNodes();
+    for (HashMap<unsigned, Node*>::ConstIterator i = nodes.Begin(); i != nodes.End(); ++i)
+    {
+        Node* node = i->second_;
+        if (node == scene || alwaysRelevant_.Contains(i->first_))
+            continue;
+
+        IntVector2 cell = GetCell(node->GetWorldPosition());
+        cells_[PackCell(cell.x_, cell.y_)].Push(node);
+    }
+
+    for (HashMap<unsigned long long, PODVector<Node*> >::Iterator i = cells_.Begin(); i != cells_.End();)
+    {
+        if (i->second_.Empty())
+            i = cells_.Erase(i);
+        else
+            ++i;
+    }
+}
+
+void NetworkInterest::GetRelevantNodes(const Vector3& position, HashSet<unsigned>& dest, HashSet<unsigned>& deferred) const
+{
+    dest.Clear();
+    deferred.Clear();
+
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+    dest.Insert(scene->GetID());
+
+    for (HashSet<unsigned>::ConstIterator i = alwaysRelevant_.Begin(); i != alwaysRelevant_.End(); ++i)
+    {
+        Node* node = scene->GetNode(*i);
+        if (node)
+            AddRelevantNode(node, dest);
+    }
+
+    IntVector2 center = GetCell(position);
+    int radius = (int)ceilf(viewDistance_ / cellSize_);
+    float viewDistanceSquared = viewDistance_ * viewDistance_;
+    float nearDistanceSquared = nearDistance_ * nearDistance_;
+
+    for (int y = center.y_ - radius; y <= center.y_ + radius; ++y)
+    {
+        for (int x = center.x_ - radius; x <= center.x_ + radius; ++x)
+        {
+            HashMap<unsigned long long, PODVector<Node*> >::ConstIterator i = cells_.Find(PackCell(x, y));
+            if (i == cells_.End())
+                continue;
+
+            // Cells beyond the near distance are updated on staggered network updates to spread the load
+            Vector2 cellCenter(((float)x + 0.5f) * cellSize_, ((float)y + 0.5f) * cellSize_);
+            bool far = (cellCenter - Vector2(position.x_, position.z_)).LengthSquared() > nearDistanceSquared;
+            bool due = !far || (updateCount_ + ((unsigned)x * 73856093u ^ (unsigned)y * 19349663u)) % farUpdateInterval_ == 0;
+
+            const PODVector<Node*>& nodes = i->second_;
+            for (auto j = 0u; j < nodes.Size(); ++j)
+            {
+                Node* node = nodes[j];
+                if ((node->GetWorldPosition() - position).LengthSquared() > viewDistanceSquared)
+                    continue;
+
+                AddRelevantNode(node, dest);
+                if (!due)
+                    deferred.Insert(node->GetID());
+            }
+        }
+    }
+}
+
+IntVector2 NetworkInterest::GetCell(const Vector3& position) const
+{
+    return IntVector2(FloorToInt(position.x_ / cellSize_), FloorToInt(position.z_ / cellSize_));
+}
+
+void NetworkInterest::AddRelevantNode(Node* node, HashSet<unsigned>& dest) const
+{
+    bool exists;
+    dest.Insert(node->GetID(), exists);
+    if (exists)
+        return;
+
+    // The client can not create a node before its parent and other depended on nodes
+    const PODVector<Node*>& dependencyNodes = node->GetDependencyNodes();
+    for (auto i = 0u; i < dependencyNodes.Size(); ++i)
+        AddRelevantNode(dependencyNodes[i], dest);
+}
+
+}
@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashSet.h"
+#include "../Scene/Component.h"
+
+namespace FlockSDK
+{
+
+/// %Network interest management component. When added to a replicated scene, each connection only receives the nodes within the view distance of its observer position, and nodes in cells beyond the near distance are updated at a reduced rate.
+class FLOCKSDK_API NetworkInterest : public Component
+{
+    FLOCKSDK_OBJECT(NetworkInterest, Component);
+
+public:
+    /// Construct.
+    NetworkInterest(Context* context);
+    /// Destruct.
+    virtual ~NetworkInterest();
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Set grid cell size. Default 50.
+    void SetCellSize(float size);
+    /// Set distance within which nodes are replicated to a connection. Default 250.
+    void SetViewDistance(float distance);
+    /// Set distance within which cells are updated on every network update. Default 100.
+    void SetNearDistance(float distance);
+    /// Set the number of network updates between updates of cells beyond the near distance. Default 4.
+    void SetFarUpdateInterval(unsigned interval);
+    /// Set whether a node is replicated to all connections regardless of its position.
+    void SetAlwaysRelevant(Node* node, bool enable);
+
+    /// Return grid cell size.
+    float GetCellSize() const { return cellSize_; }
+
+    /// Return view distance.
+    float GetViewDistance() const { return viewDistance_; }
+
+    /// Return near distance.
+    float GetNearDistance() const { return nearDistance_; }
+
+    /// Return far cell update interval.
+    unsigned GetFarUpdateInterval() const { return farUpdateInterval_; }
+
+    /// Return whether a node is replicated to all connections regardless of its position.
+    bool IsAlwaysRelevant(Node* node) const;
+
+    /// Rebuild the spatial grid from the replicated nodes' world positions. Called by Network before sending server updates.
+    void UpdateGrid();
+    /// Collect the IDs of nodes relevant to an observer position, including the nodes they depend on, and the subset in far cells that are not due for an update. Is thread-safe. Called by Connection.
+    void GetRelevantNodes(const Vector3& position, HashSet<unsigned>& dest, HashSet<unsigned>& deferred) const;
+
+private:
+    /// Return grid cell coordinate of a world position.
+    IntVector2 GetCell(const Vector3& position) const;
+    /// Add a node and the nodes it depends on to the relevant set.
+    void AddRelevantNode(Node* node, HashSet<unsigned>& dest) const;
+
+    /// Nodes by packed grid cell coordinate.
+    HashMap<unsigned long long, PODVector<Node*> > cells_;
+    /// IDs of nodes relevant to all connections.
+    HashSet<unsigned> alwaysRelevant_;
+    /// Grid cell size.
+    float cellSize_;
+    /// View distance.
+    float viewDistance_;
+    /// Full update rate distance.
+    float nearDistance_;
+    /// Far cell update interval.
+    unsigned farUpdateInterval_;
+    /// Grid update counter for staggering far cell updates.
+    unsigned updateCount_;
+};
+
+}
@@ -24,7 +24,12 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#include "../IO/File.h"
+#include "../IO/Deserializer.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/Serializer.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
@@ -34,92 +39,216 @@
 namespace FlockSDK
 {
 
-BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
-    owner_(owner)
+/// Background loader I/O thread.
+class BackgroundLoadThread : public Thread, public RefCounted
 {
-}
+public:
+    /// Construct.
+    BackgroundLoadThread(BackgroundLoader* owner) :
+        owner_(owner)
+    {
+    }
 
-BackgroundLoader::~BackgroundLoader()
+    /// Read queued files until stopped.
+    virtual void ThreadFunction()
+    {
+        while (shouldRun_)
+        {
+            if (!owner_->ProcessItem())
+                Time::Sleep(5);
+        }
+    }
+
+private:
+    /// Background loader.
+    BackgroundLoader* owner_;
+};
+
+/// Memory buffer over background loaded file data. Reports the file name, as resources use it in messages and to resolve relative paths.
+class BackgroundLoadBuffer : public MemoryBuffer
 {
-    MutexLock lock(backgroundLoadMutex_);
+public:
+    /// Construct.
+    BackgroundLoadBuffer(const void* data, unsigned size, const String &name) :
+        MemoryBuffer(data, size),
+        name_(name)
+    {
+    }
 
-    backgroundLoadQueue_.Clear();
+    /// Return the file name.
+    virtual const String &GetName() const { return name_; }
+
+private:
+    /// File name.
+    String name_;
+};
+
+BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
+    owner_(owner),
+    numThreads_(DEFAULT_BACKGROUND_LOAD_THREADS),
+    numPendingWorkItems_(0),
+    useWorkQueue_(false)
+{
 }
 
-void BackgroundLoader::ThreadFunction()
+BackgroundLoader::~BackgroundLoader()
 {
-    while (shouldRun_)
-    {
-        backgroundLoadMutex_.Acquire();
+    for (auto i = 0u; i < threads_.Size(); ++i)
+        threads_[i]->Stop();
+    threads_.Clear();
 
-        // Search for a queued resource that has not been loaded yet
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-        while (i != backgroundLoadQueue_.End())
+    // Take back BeginLoad work that has not started, then wait for the rest to finish
+    if (numPendingWorkItems_)
+    {
+        Vector<SharedPtr<WorkItem> > workItems;
         {
-            if (i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
+            MutexLock lock(backgroundLoadMutex_);
+            for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
+                 i != backgroundLoadQueue_.End(); ++i)
+            {
+                if (i->second_.workItem_)
+                    workItems.Push(i->second_.workItem_);
+            }
         }
 
-        if (i == backgroundLoadQueue_.End())
+        if (workQueue_)
         {
-            // No resources to load found
+            unsigned removed = workQueue_->RemoveWorkItems(workItems);
+            backgroundLoadMutex_.Acquire();
+            numPendingWorkItems_ -= removed;
             backgroundLoadMutex_.Release();
-            Time::Sleep(5);
         }
-        else
+
+        for (;;)
         {
-            BackgroundLoadItem& item = i->second_;
-            Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
+            backgroundLoadMutex_.Acquire();
+            unsigned numPending = numPendingWorkItems_;
             backgroundLoadMutex_.Release();
+            if (!numPending)
+                break;
+            Time::Sleep(1);
+        }
+    }
 
-            bool success = false;
-            SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
-            {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
-            }
+    MutexLock lock(backgroundLoadMutex_);
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.Size())
-            {
-                for (HashSet<Pair<StringHash, StringHash>>::Iterator i = item.dependents_.Begin();
-                     i != item.dependents_.End(); ++i)
-                {
-                    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
-                    if (j != backgroundLoadQueue_.End())
-                        j->second_.dependencies_.Erase(key);
-                }
+    backgroundLoadQueue_.Clear();
+}
 
-                item.dependents_.Clear();
-            }
+bool BackgroundLoader::ProcessItem()
+{
+    backgroundLoadMutex_.Acquire();
 
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
+    // Search for the highest priority queued resource that has not been loaded yet
+    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.End();
+    for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Begin();
+         j != backgroundLoadQueue_.End(); ++j)
+    {
+        if (j->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED &&
+            (i == backgroundLoadQueue_.End() || j->second_.priority_ > i->second_.priority_))
+            i = j;
+    }
+
+    if (i == backgroundLoadQueue_.End())
+    {
+        // No resources to load found
+        backgroundLoadMutex_.Release();
+        return false;
+    }
+
+    BackgroundLoadItem& item = i->second_;
+    Resource* resource = item.resource_;
+    // Claim the item for this thread. We can be sure that the item is not removed from the queue as long as it is
+    // in the "queued" or "loading" state
+    resource->SetAsyncLoadState(ASYNC_LOADING);
+    backgroundLoadMutex_.Release();
+
+    bool success = false;
+    SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
+    SharedArrayPtr<unsigned char> data;
+    if (file)
+    {
+        // Uncompressed files in a memory mapped package are parsed in place
+        if (file->GetMappedData() || !file->GetSize())
+            success = true;
+        else
+        {
+            data = new unsigned char[file->GetSize()];
+            success = file->Read(data.Get(), file->GetSize()) == file->GetSize();
+            file->Close();
         }
     }
+
+    if (!success)
+    {
+        CompleteItem(item, false);
+        return true;
+    }
+
+    backgroundLoadMutex_.Acquire();
+    item.file_ = file;
+    item.data_ = data;
+    item.readyToLoad_ = useWorkQueue_;
+    backgroundLoadMutex_.Release();
+
+    // Without worker threads, parse in this thread
+    if (!useWorkQueue_)
+        BeginLoad(item);
+
+    return true;
 }
 
-bool BackgroundLoader::QueueResource(StringHash type, const String &name, bool sendEventOnFailure, Resource* caller)
+bool BackgroundLoader::QueueResource(StringHash type, const String &name, bool sendEventOnFailure, Resource* caller,
+    unsigned priority)
 {
     StringHash nameHash(name);
     Pair<StringHash, StringHash> key = MakePair(type, nameHash);
 
     MutexLock lock(backgroundLoadMutex_);
 
-    // Check if already exists in the queue
-    if (backgroundLoadQueue_.Find(key) != backgroundLoadQueue_.End())
+    // Dependencies inherit the priority of the resource requesting them. Remember the dependency so that it can be
+    // queued up front when preloading the requesting resource next time
+    if (caller)
+    {
+        Pair<StringHash, StringHash> callerKey = MakePair(caller->GetType(), caller->GetNameHash());
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(callerKey);
+        if (j != backgroundLoadQueue_.End())
+            priority = Max(priority, j->second_.priority_);
+
+        Vector<ResourceRef>& dependencies = dependencyGraph_[callerKey];
+        ResourceRef ref(type, name);
+        if (!dependencies.Contains(ref))
+            dependencies.Push(ref);
+    }
+
+    // Check if already exists in the queue. If so, raise its priority if necessary
+    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator existing = backgroundLoadQueue_.Find(key);
+    if (existing != backgroundLoadQueue_.End())
+    {
+        BackgroundLoadItem& item = existing->second_;
+        item.priority_ = Max(item.priority_, priority);
+
+        // If the resource was queued ahead of the caller (preloaded) and has not completed BeginLoad yet, the caller
+        // must still wait for it
+        AsyncLoadState state = item.resource_->GetAsyncLoadState();
+        if (caller && (state == ASYNC_QUEUED || state == ASYNC_LOADING))
+        {
+            Pair<StringHash, StringHash> callerKey = MakePair(caller->GetType(), caller->GetNameHash());
+            HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(callerKey);
+            if (j != backgroundLoadQueue_.End())
+            {
+                item.dependents_.Insert(callerKey);
+                j->second_.dependencies_.Insert(key);
+            }
+        }
+
         return false;
+    }
 
     BackgroundLoadItem& item = backgroundLoadQueue_[key];
     item.sendEventOnFailure_ = sendEventOnFailure;
+    item.priority_ = priority;
+    item.readyToLoad_ = false;
 
     // Make sure the pointer is non-null and is a Resource subclass
     item.resource_ = DynamicCast<Resource>(owner_->GetContext()->CreateObject(type));
@@ -161,9 +290,8 @@ bool BackgroundLoader::QueueResource(StringHash type, const String &name, bool s
                        " requested for a background loaded resource but was not in the background load queue");
     }
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
+    // Start the I/O threads now
+    StartThreads();
 
     return true;
 }
@@ -180,16 +308,40 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
         backgroundLoadMutex_.Release();
 
         {
-            Resource* resource = i->second_.resource_;
+            BackgroundLoadItem& item = i->second_;
+            Resource* resource = item.resource_;
             HiresTimer waitTimer;
             bool didWait = false;
 
             for (;;)
             {
-                unsigned numDeps = i->second_.dependencies_.Size();
+                // If the file has been read but BeginLoad has not started, run it now instead of waiting for a worker
+                backgroundLoadMutex_.Acquire();
+                bool beginLoadNow = item.readyToLoad_;
+                item.readyToLoad_ = false;
+                backgroundLoadMutex_.Release();
+
+                if (!beginLoadNow && item.workItem_ && !item.workItem_->completed_ && workQueue_ &&
+                    workQueue_->RemoveWorkItem(item.workItem_))
+                {
+                    backgroundLoadMutex_.Acquire();
+                    --numPendingWorkItems_;
+                    backgroundLoadMutex_.Release();
+                    beginLoadNow = true;
+                }
+
+                if (beginLoadNow)
+                {
+                    item.workItem_.Reset();
+                    BeginLoad(item);
+                }
+
+                unsigned numDeps = item.dependencies_.Size();
                 AsyncLoadState state = resource->GetAsyncLoadState();
                 if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
                 {
+                    // Dependencies may be waiting to be submitted to the work queue
+                    SubmitLoadItems();
                     didWait = true;
                     Time::Sleep(1);
                 }
@@ -215,10 +367,12 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
+    if (threads_.Size())
     {
         HiresTimer timer;
 
+        SubmitLoadItems();
+
         backgroundLoadMutex_.Acquire();
 
         for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
@@ -248,12 +402,158 @@ void BackgroundLoader::FinishResources(int maxMs)
     }
 }
 
+void BackgroundLoader::GetDependencies(StringHash type, StringHash nameHash, Vector<ResourceRef>& dest) const
+{
+    MutexLock lock(backgroundLoadMutex_);
+
+    HashMap<Pair<StringHash, StringHash>, Vector<ResourceRef> >::ConstIterator i = dependencyGraph_.Find(MakePair(type, nameHash));
+    if (i != dependencyGraph_.End())
+        dest.Push(i->second_);
+}
+
+bool BackgroundLoader::SaveDependencies(Serializer& dest) const
+{
+    MutexLock lock(backgroundLoadMutex_);
+
+    dest.WriteVLE(dependencyGraph_.Size());
+    for (HashMap<Pair<StringHash, StringHash>, Vector<ResourceRef> >::ConstIterator i = dependencyGraph_.Begin();
+         i != dependencyGraph_.End(); ++i)
+    {
+        dest.WriteStringHash(i->first_.first_);
+        dest.WriteStringHash(i->first_.second_);
+        dest.WriteVLE(i->second_.Size());
+        for (auto j = 0u; j < i->second_.Size(); ++j)
+            dest.WriteResourceRef(i->second_[j]);
+    }
+
+    return true;
+}
+
+bool BackgroundLoader::LoadDependencies(Deserializer& source)
+{
+    MutexLock lock(backgroundLoadMutex_);
+
+    unsigned numResources = source.ReadVLE();
+    for (auto i = 0u; i < numResources && !source.IsEof(); ++i)
+    {
+        StringHash type = source.ReadStringHash();
+        StringHash nameHash = source.ReadStringHash();
+        Vector<ResourceRef>& dependencies = dependencyGraph_[MakePair(type, nameHash)];
+        unsigned numDependencies = source.ReadVLE();
+        for (auto j = 0u; j < numDependencies; ++j)
+        {
+            ResourceRef ref = source.ReadResourceRef();
+            if (!dependencies.Contains(ref))
+                dependencies.Push(ref);
+        }
+    }
+
+    return true;
+}
+
 unsigned BackgroundLoader::GetNumQueuedResources() const
 {
     MutexLock lock(backgroundLoadMutex_);
     return backgroundLoadQueue_.Size();
 }
 
+void BackgroundLoader::BeginLoadWork(const WorkItem* item, unsigned threadIndex)
+{
+    BackgroundLoader* loader = reinterpret_cast<BackgroundLoader*>(item->aux_);
+    loader->BeginLoad(*reinterpret_cast<BackgroundLoadItem*>(item->start_));
+
+    MutexLock lock(loader->backgroundLoadMutex_);
+    --loader->numPendingWorkItems_;
+}
+
+void BackgroundLoader::StartThreads()
+{
+    if (threads_.Size())
+        return;
+
+    // Work items can only be added from the main thread, so read files are submitted for BeginLoad once per frame
+    workQueue_ = owner_->GetSubsystem<WorkQueue>();
+    useWorkQueue_ = workQueue_ && workQueue_->GetNumThreads() > 0;
+
+    for (auto i = 0u; i < numThreads_; ++i)
+    {
+        SharedPtr<BackgroundLoadThread> thread(new BackgroundLoadThread(this));
+        thread->Run();
+        threads_.Push(thread);
+    }
+}
+
+void BackgroundLoader::SubmitLoadItems()
+{
+    if (!useWorkQueue_ || !workQueue_)
+        return;
+
+    Vector<SharedPtr<WorkItem> > workItems;
+
+    backgroundLoadMutex_.Acquire();
+    for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
+         i != backgroundLoadQueue_.End(); ++i)
+    {
+        BackgroundLoadItem& item = i->second_;
+        if (!item.readyToLoad_)
+            continue;
+
+        // Maximum priority is reserved for per-frame engine work. The item is kept by the load item after it has
+        // completed, so do not take it from the pool, where it could be recycled for unrelated work
+        SharedPtr<WorkItem> workItem(new WorkItem());
+        workItem->workFunction_ = BeginLoadWork;
+        workItem->start_ = &item;
+        workItem->aux_ = this;
+        workItem->priority_ = Min(item.priority_, M_MAX_UNSIGNED - 1);
+        item.workItem_ = workItem;
+        item.readyToLoad_ = false;
+        workItems.Push(workItem);
+        ++numPendingWorkItems_;
+    }
+    backgroundLoadMutex_.Release();
+
+    for (auto i = 0u; i < workItems.Size(); ++i)
+        workQueue_->AddWorkItem(workItems[i]);
+}
+
+void BackgroundLoader::BeginLoad(BackgroundLoadItem& item)
+{
+    Resource* resource = item.resource_;
+    File* file = item.file_;
+    const unsigned char* data = item.data_ ? item.data_.Get() : file->GetMappedData();
+
+    BackgroundLoadBuffer source(data, file->GetSize(), file->GetName());
+    bool success = resource->BeginLoad(source);
+
+    item.file_.Reset();
+    item.data_.Reset();
+    CompleteItem(item, success);
+}
+
+void BackgroundLoader::CompleteItem(BackgroundLoadItem& item, bool success)
+{
+    Resource* resource = item.resource_;
+
+    // Process dependencies now
+    // Need to lock the queue again when manipulating other entries
+    Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
+    MutexLock lock(backgroundLoadMutex_);
+    if (item.dependents_.Size())
+    {
+        for (HashSet<Pair<StringHash, StringHash>>::Iterator i = item.dependents_.Begin();
+             i != item.dependents_.End(); ++i)
+        {
+            HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
+            if (j != backgroundLoadQueue_.End())
+                j->second_.dependencies_.Erase(key);
+        }
+
+        item.dependents_.Clear();
+    }
+
+    resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+}
+
 void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
 {
     Resource* resource = item.resource_;
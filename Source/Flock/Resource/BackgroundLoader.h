@@ -22,19 +22,30 @@
 
 #pragma once
 
+#include "../Container/ArrayPtr.h"
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
 #include "../Core/Mutex.h"
 #include "../Container/Ptr.h"
 #include "../Container/RefCounted.h"
 #include "../Core/Thread.h"
+#include "../Core/Variant.h"
 #include "../Math/StringHash.h"
 
 namespace FlockSDK
 {
 
+class BackgroundLoadThread;
+class Deserializer;
+class File;
 class Resource;
 class ResourceCache;
+class Serializer;
+class WorkQueue;
+struct WorkItem;
+
+/// Default number of background loader I/O threads.
+static const unsigned DEFAULT_BACKGROUND_LOAD_THREADS = 4;
 
 /// Queue item for background loading of a resource.
 struct BackgroundLoadItem
@@ -45,12 +56,22 @@ struct BackgroundLoadItem
     HashSet<Pair<StringHash, StringHash> > dependencies_;
     /// Resources that depend on this resource's loading.
     HashSet<Pair<StringHash, StringHash> > dependents_;
+    /// Source file, kept open while its data is read in place from a memory mapped package.
+    SharedPtr<File> file_;
+    /// File data read by the I/O stage, or null if read in place.
+    SharedArrayPtr<unsigned char> data_;
+    /// Work item running the BeginLoad stage.
+    SharedPtr<WorkItem> workItem_;
+    /// Load priority. Higher value = will be loaded first.
+    unsigned priority_;
+    /// Whether the file has been read and is waiting to be submitted for BeginLoad.
+    bool readyToLoad_;
     /// Whether to send failure event.
     bool sendEventOnFailure_;
 };
 
-/// Background loader of resources. Owned by the ResourceCache.
-class BackgroundLoader : public RefCounted, public Thread
+/// Background resource loader. I/O threads read queued files concurrently, after which BeginLoad runs on the work queue worker threads.
+class BackgroundLoader : public RefCounted
 {
 public:
     /// Construct.
@@ -59,29 +80,62 @@ public:
     /// Destruct. Forcibly clear the load queue.
     ~BackgroundLoader();
 
-    /// Resource background loading loop.
-    virtual void ThreadFunction();
+    /// Read the highest priority queued file. Called by the I/O threads. Return true if an item was processed.
+    bool ProcessItem();
 
     /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
-    bool QueueResource(StringHash type, const String &name, bool sendEventOnFailure, Resource* caller);
+    bool QueueResource(StringHash type, const String &name, bool sendEventOnFailure, Resource* caller, unsigned priority = 0);
     /// Wait and finish possible loading of a resource when being requested from the cache.
     void WaitForResource(StringHash type, StringHash nameHash);
     /// Process resources that are ready to finish.
     void FinishResources(int maxMs);
+    /// Set number of I/O threads. Takes effect when the threads are next started.
+    void SetNumThreads(unsigned num) { numThreads_ = Max(num, 1U); }
+    /// Append the resources that a resource requested when it was background loaded.
+    void GetDependencies(StringHash type, StringHash nameHash, Vector<ResourceRef>& dest) const;
+    /// Save learned dependencies. Return true if successful.
+    bool SaveDependencies(Serializer& dest) const;
+    /// Load learned dependencies. Return true if successful.
+    bool LoadDependencies(Deserializer& source);
 
     /// Return amount of resources in the load queue.
     unsigned GetNumQueuedResources() const;
+    /// Return number of I/O threads.
+    unsigned GetNumThreads() const { return numThreads_; }
+
+    /// Run BeginLoad for a background load item. Called by the work queue.
+    static void BeginLoadWork(const WorkItem* item, unsigned threadIndex);
 
 private:
+    /// Start the I/O threads if not running yet.
+    void StartThreads();
+    /// Submit items whose files have been read to the work queue. Called from the main thread.
+    void SubmitLoadItems();
+    /// Run BeginLoad for an item whose file has been read, then mark it complete.
+    void BeginLoad(BackgroundLoadItem& item);
+    /// Update dependencies and the load state of an item after the BeginLoad stage.
+    void CompleteItem(BackgroundLoadItem& item, bool success);
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
 
     /// Resource cache.
     ResourceCache* owner_;
+    /// Work queue for the BeginLoad stage.
+    WeakPtr<WorkQueue> workQueue_;
+    /// I/O threads.
+    Vector<SharedPtr<BackgroundLoadThread> > threads_;
     /// Mutex for thread-safe access to the background load queue.
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Resources requested by each background loaded resource, keyed by type and name hash of the requesting resource.
+    HashMap<Pair<StringHash, StringHash>, Vector<ResourceRef> > dependencyGraph_;
+    /// Number of I/O threads.
+    unsigned numThreads_;
+    /// Number of work items submitted but not yet finished.
+    unsigned numPendingWorkItems_;
+    /// Whether BeginLoad runs on the work queue worker threads instead of the I/O threads.
+    bool useWorkQueue_;
 };
 
 }
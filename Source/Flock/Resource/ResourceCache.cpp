@@ -26,10 +26,12 @@
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
+#include "../IO/Deserializer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/FileWatcher.h"
 #include "../IO/Log.h"
 #include "../IO/PackageFile.h"
+#include "../IO/Serializer.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/Image.h"
 #include "../Resource/JSONFile.h"
@@ -71,13 +73,14 @@ ResourceCache::ResourceCache(Context* context) :
     autoReloadResources_(false),
     returnFailedResources_(false),
     searchPackagesFirst_(true),
+    memoryMapPackages_(false),
     isRouting_(false),
     finishBackgroundResourcesMs_(5)
 {
     // Register Resource library object factories
     RegisterResourceLibrary(context_);
 
-    // Create resource background loader. Its thread will start on the first background request
+    // Create resource background loader. Its threads will start on the first background request
     backgroundLoader_ = new BackgroundLoader(this);
 
     // Subscribe BeginFrame for handling directory watchers and background loaded resource finalization
@@ -151,7 +154,14 @@ bool ResourceCache::AddPackageFile(PackageFile* package, unsigned priority)
 bool ResourceCache::AddPackageFile(const String &fileName, unsigned priority)
 {
     SharedPtr<PackageFile> package(new PackageFile(context_));
-    return package->Open(fileName) && AddPackageFile(package);
+    if (!package->Open(fileName))
+        return false;
+
+    // Fall back to file handle reads if the mapping fails, for example due to address space on 32-bit builds
+    if (memoryMapPackages_ && !package->MapMemory())
+        FLOCKSDK_LOGWARNING("Reading package file " + fileName + " without memory mapping");
+
+    return AddPackageFile(package);
 }
 
 bool ResourceCache::AddManualResource(Resource* resource)
@@ -628,7 +638,8 @@ Resource* ResourceCache::GetResource(StringHash type, const String &nameIn, bool
     return resource;
 }
 
-bool ResourceCache::BackgroundLoadResource(StringHash type, const String &nameIn, bool sendEventOnFailure, Resource* caller)
+bool ResourceCache::BackgroundLoadResource(StringHash type, const String &nameIn, bool sendEventOnFailure, Resource* caller,
+    unsigned priority)
 {
     // If empty name, fail immediately
     String name = SanitateResourceName(nameIn);
@@ -640,7 +651,7 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const String &nameIn
     if (FindResource(type, nameHash) != noResource)
         return false;
 
-    return backgroundLoader_->QueueResource(type, name, sendEventOnFailure, caller);
+    return backgroundLoader_->QueueResource(type, name, sendEventOnFailure, caller, priority);
 }
 
 SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String &nameIn, bool sendEventOnFailure)
@@ -701,6 +712,76 @@ unsigned ResourceCache::GetNumBackgroundLoadResources() const
     return backgroundLoader_->GetNumQueuedResources();
 }
 
+void ResourceCache::GetBackgroundLoadDependencies(StringHash type, const String &name, Vector<ResourceRef>& dest) const
+{
+    backgroundLoader_->GetDependencies(type, StringHash(SanitateResourceName(name)), dest);
+}
+
+void ResourceCache::SetResourceManifest(const String &fileName, unsigned checksum, const Vector<ResourceRef>& resources)
+{
+    ResourceManifest& manifest = resourceManifests_[StringHash(fileName)];
+    manifest.checksum_ = checksum;
+    manifest.resources_ = resources;
+}
+
+const Vector<ResourceRef>* ResourceCache::GetResourceManifest(const String &fileName, unsigned checksum) const
+{
+    HashMap<StringHash, ResourceManifest>::ConstIterator i = resourceManifests_.Find(StringHash(fileName));
+    if (i == resourceManifests_.End() || i->second_.checksum_ != checksum)
+        return 0;
+
+    return &i->second_.resources_;
+}
+
+bool ResourceCache::SaveResourceManifests(Serializer& dest) const
+{
+    if (!dest.WriteFileID("URDG"))
+        return false;
+
+    dest.WriteVLE(resourceManifests_.Size());
+    for (HashMap<StringHash, ResourceManifest>::ConstIterator i = resourceManifests_.Begin(); i != resourceManifests_.End(); ++i)
+    {
+        dest.WriteStringHash(i->first_);
+        dest.WriteUInt(i->second_.checksum_);
+        dest.WriteVLE(i->second_.resources_.Size());
+        for (auto j = 0u; j < i->second_.resources_.Size(); ++j)
+            dest.WriteResourceRef(i->second_.resources_[j]);
+    }
+
+    return backgroundLoader_->SaveDependencies(dest);
+}
+
+bool ResourceCache::LoadResourceManifests(Deserializer& source)
+{
+    if (source.ReadFileID() != "URDG")
+    {
+        FLOCKSDK_LOGERROR(source.GetName() + " is not a valid resource manifest file");
+        return false;
+    }
+
+    unsigned numManifests = source.ReadVLE();
+    for (auto i = 0u; i < numManifests && !source.IsEof(); ++i)
+    {
+        ResourceManifest& manifest = resourceManifests_[source.ReadStringHash()];
+        manifest.checksum_ = source.ReadUInt();
+        manifest.resources_.Resize(source.ReadVLE());
+        for (auto j = 0u; j < manifest.resources_.Size(); ++j)
+            manifest.resources_[j] = source.ReadResourceRef();
+    }
+
+    return backgroundLoader_->LoadDependencies(source);
+}
+
+void ResourceCache::SetNumBackgroundLoadThreads(unsigned num)
+{
+    backgroundLoader_->SetNumThreads(num);
+}
+
+unsigned ResourceCache::GetNumBackgroundLoadThreads() const
+{
+    return backgroundLoader_->GetNumThreads();
+}
+
 void ResourceCache::GetResources(PODVector<Resource*>& result, StringHash type) const
 {
     result.Clear();
@@ -32,8 +32,10 @@ namespace FlockSDK
 {
 
 class BackgroundLoader;
+class Deserializer;
 class FileWatcher;
 class PackageFile;
+class Serializer;
 
 /// Sets to priority so that a package or file is pushed to the end of the vector.
 static const unsigned PRIORITY_LAST = 0xffffffff;
@@ -56,6 +58,21 @@ struct ResourceGroup
     HashMap<StringHash, SharedPtr<Resource> > resources_;
 };
 
+/// Resources referenced by a scene or object file, stored so that they can be preloaded without parsing the file.
+struct ResourceManifest
+{
+    /// Construct with defaults.
+    ResourceManifest() :
+        checksum_(0)
+    {
+    }
+
+    /// Checksum of the file the manifest was collected from.
+    unsigned checksum_;
+    /// Referenced resources.
+    Vector<ResourceRef> resources_;
+};
+
 /// Resource request types.
 enum ResourceRequest
 {
@@ -125,9 +142,13 @@ public:
 
     /// Define whether when getting resources should check package files or directories first. True for packages, false for directories.
     void SetSearchPackagesFirst(bool value) { searchPackagesFirst_ = value; }
+    /// Define whether package files added by name are memory mapped for reading. Default false. Affects packages added afterward.
+    void SetMemoryMapPackages(bool enable) { memoryMapPackages_ = enable; }
 
     /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources.
     void SetFinishBackgroundResourcesMs(int ms) { finishBackgroundResourcesMs_ = Max(ms, 1); }
+    /// Set number of background loading I/O threads. Default 4. Takes effect when background loading is first started.
+    void SetNumBackgroundLoadThreads(unsigned num);
 
     /// Add a resource router object. By default there is none, so the routing process is skipped.
     void AddResourceRouter(ResourceRouter* router, bool addAsFirst = false);
@@ -140,10 +161,20 @@ public:
     Resource* GetResource(StringHash type, const String &name, bool sendEventOnFailure = true);
     /// Load a resource without storing it in the resource cache. Return null if not found or if fails. Can be called from outside the main thread if the resource itself is safe to load completely (it does not possess for example GPU data.)
     SharedPtr<Resource> GetTempResource(StringHash type, const String &name, bool sendEventOnFailure = true);
-    /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Can be called from outside the main thread.
-    bool BackgroundLoadResource(StringHash type, const String &name, bool sendEventOnFailure = true, Resource* caller = 0);
+    /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Can be called from outside the main thread. Higher priority resources are read and loaded first, and resources requested by a caller inherit its priority.
+    bool BackgroundLoadResource(StringHash type, const String &name, bool sendEventOnFailure = true, Resource* caller = 0, unsigned priority = 0);
     /// Return number of pending background-loaded resources.
     unsigned GetNumBackgroundLoadResources() const;
+    /// Append the resources that a resource requested as dependencies when it was last background loaded. Can be called from outside the main thread.
+    void GetBackgroundLoadDependencies(StringHash type, const String &name, Vector<ResourceRef>& dest) const;
+    /// Store the resources referenced by a scene or object file.
+    void SetResourceManifest(const String &fileName, unsigned checksum, const Vector<ResourceRef>& resources);
+    /// Return the resources referenced by a scene or object file, or null if not stored or the file checksum has changed.
+    const Vector<ResourceRef>* GetResourceManifest(const String &fileName, unsigned checksum) const;
+    /// Save resource manifests and learned background load dependencies. Return true if successful.
+    bool SaveResourceManifests(Serializer& dest) const;
+    /// Load resource manifests and background load dependencies saved earlier. Return true if successful.
+    bool LoadResourceManifests(Deserializer& source);
     /// Return all loaded resources of a specific type.
     void GetResources(PODVector<Resource*>& result, StringHash type) const;
     /// Return an already loaded resource of specific type & name, or null if not found. Will not load if does not exist.
@@ -167,7 +198,7 @@ public:
     /// Template version of releasing a resource by name.
     template <class T> void ReleaseResource(const String &name, bool force = false);
     /// Template version of queueing a resource background load.
-    template <class T> bool BackgroundLoadResource(const String &name, bool sendEventOnFailure = true, Resource* caller = 0);
+    template <class T> bool BackgroundLoadResource(const String &name, bool sendEventOnFailure = true, Resource* caller = 0, unsigned priority = 0);
     /// Template version of returning loaded resources of a specific type.
     template <class T> void GetResources(PODVector<T*>& result) const;
     /// Return whether a file exists in the resource directories or package files. Does not check manually added in-memory resources.
@@ -190,9 +221,15 @@ public:
     /// Return whether when getting resources should check package files or directories first.
     bool GetSearchPackagesFirst() const { return searchPackagesFirst_; }
 
+    /// Return whether package files added by name are memory mapped.
+    bool GetMemoryMapPackages() const { return memoryMapPackages_; }
+
     /// Return how many milliseconds maximum to spend on finishing background loaded resources.
     int GetFinishBackgroundResourcesMs() const { return finishBackgroundResourcesMs_; }
 
+    /// Return number of background loading I/O threads.
+    unsigned GetNumBackgroundLoadThreads() const;
+
     /// Return a resource router by index.
     ResourceRouter* GetResourceRouter(unsigned index) const;
 
@@ -240,6 +277,8 @@ private:
     HashMap<StringHash, HashSet<StringHash> > dependentResources_;
     /// Resource background loader.
     SharedPtr<BackgroundLoader> backgroundLoader_;
+    /// Resource manifests by file name hash.
+    HashMap<StringHash, ResourceManifest> resourceManifests_;
     /// Resource routers.
     Vector<SharedPtr<ResourceRouter> > resourceRouters_;
     /// Automatic resource reloading flag.
@@ -248,6 +287,8 @@ private:
     bool returnFailedResources_;
     /// Search priority flag.
     bool searchPackagesFirst_;
+    /// Package memory mapping flag.
+    bool memoryMapPackages_;
     /// Resource routing flag to prevent endless recursion.
     mutable bool isRouting_;
     /// How many milliseconds maximum per frame to spend on finishing background loaded resources.
@@ -278,10 +319,10 @@ template <class T> SharedPtr<T> ResourceCache::GetTempResource(const String &nam
     return StaticCast<T>(GetTempResource(type, name, sendEventOnFailure));
 }
 
-template <class T> bool ResourceCache::BackgroundLoadResource(const String &name, bool sendEventOnFailure, Resource* caller)
+template <class T> bool ResourceCache::BackgroundLoadResource(const String &name, bool sendEventOnFailure, Resource* caller, unsigned priority)
 {
     StringHash type = T::GetTypeStatic();
-    return BackgroundLoadResource(type, name, sendEventOnFailure, caller);
+    return BackgroundLoadResource(type, name, sendEventOnFailure, caller, priority);
 }
 
 template <class T> void ResourceCache::GetResources(PODVector<T*>& result) const
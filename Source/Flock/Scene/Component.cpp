@@ -162,6 +162,7 @@ void Component::PrepareNetworkUpdate()
         return;
 
     unsigned numAttributes = attributes->Size();
+    DirtyBits changedAttributes;
 
     // Check for attribute changes
     for (auto i = 0u; i < numAttributes; ++i)
@@ -176,6 +177,7 @@ void Component::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            changedAttributes.Set(i);
 
             // Mark the attribute dirty in all replication states that are tracking this component
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
@@ -195,6 +197,10 @@ void Component::PrepareNetworkUpdate()
         }
     }
 
+    // Serialize the changed attributes once for all connections
+    if (changedAttributes.Count())
+        UpdateNetworkSnapshot(changedAttributes);
+
     networkUpdate_ = false;
 }
 
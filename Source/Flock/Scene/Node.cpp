@@ -34,6 +34,7 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 #include "../Scene/SmoothedTransform.h"
+#include "../Scene/TransformStore.h"
 #include "../Scene/UnknownComponent.h"
 
 namespace FlockSDK
@@ -52,7 +53,8 @@ Node::Node(Context* context) :
     position_(Vector3::ZERO),
     rotation_(Quaternion::IDENTITY),
     scale_(Vector3::ONE),
-    worldRotation_(Quaternion::IDENTITY)
+    worldRotation_(Quaternion::IDENTITY),
+    transformIndex_(M_MAX_UNSIGNED)
 {
     impl_ = new NodeImpl();
     impl_->owner_ = 0;
@@ -81,10 +83,12 @@ void Node::RegisterObject(Context* context)
     FLOCKSDK_ATTRIBUTE("Variables", VariantMap, vars_, Variant::emptyVariantMap, AM_FILE); // Network replication of vars uses custom data
     FLOCKSDK_ACCESSOR_ATTRIBUTE("Network Position", GetNetPositionAttr, SetNetPositionAttr, Vector3, Vector3::ZERO,
         AM_NET | AM_LATESTDATA | AM_NOEDIT);
-    FLOCKSDK_ACCESSOR_ATTRIBUTE("Network Rotation", GetNetRotationAttr, SetNetRotationAttr, PODVector<unsigned char>, Variant::emptyBuffer,
+    FLOCKSDK_ACCESSOR_ATTRIBUTE("Network Rotation", GetNetRotationAttr, SetNetRotationAttr, Quaternion, Quaternion::IDENTITY,
         AM_NET | AM_LATESTDATA | AM_NOEDIT);
     FLOCKSDK_ACCESSOR_ATTRIBUTE("Network Parent Node", GetNetParentAttr, SetNetParentAttr, PODVector<unsigned char>, Variant::emptyBuffer,
         AM_NET | AM_NOEDIT);
+    // Unit quaternion components are within -1 and 1; 12 bits per component give the same size as a packed quaternion
+    FLOCKSDK_QUANTIZE_ATTRIBUTE("Network Rotation", -1.0f, 1.0f, 1.0f / 2047.0f);
 }
 
 bool Node::Load(Deserializer& source, bool setInstanceDefault)
@@ -743,6 +747,10 @@ void Node::MarkDirty()
             return;
         cur->dirty_ = true;
 
+        // Let the transform store recalculate the world transform in its batched update, unless requested earlier
+        if (TransformStore* store = cur->scene_ ? cur->scene_->GetTransformStore() : 0)
+            store->MarkDirty(cur);
+
         // Notify listener components first, then mark child nodes
         for (Vector<WeakPtr<Component>>::Iterator i = cur->listeners_.Begin(); i != cur->listeners_.End();)
         {
@@ -828,6 +836,8 @@ void Node::AddChild(Node* node, unsigned index)
     children_.Insert(index, nodeShared);
     if (scene_ && node->GetScene() != scene_)
         scene_->NodeAdded(node);
+    else if (scene_ && scene_->GetTransformStore())
+        scene_->GetTransformStore()->MarkStructureDirty();
 
     node->parent_ = this;
     node->MarkDirty();
@@ -1443,14 +1453,13 @@ void Node::SetNetPositionAttr(const Vector3 &value)
         SetPosition(value);
 }
 
-void Node::SetNetRotationAttr(const PODVector<unsigned char>& value)
+void Node::SetNetRotationAttr(const Quaternion &value)
 {
-    MemoryBuffer buf(value);
     SmoothedTransform* transform = GetComponent<SmoothedTransform>();
     if (transform)
-        transform->SetTargetRotation(buf.ReadPackedQuaternion());
+        transform->SetTargetRotation(value);
     else
-        SetRotation(buf.ReadPackedQuaternion());
+        SetRotation(value);
 }
 
 void Node::SetNetParentAttr(const PODVector<unsigned char>& value)
@@ -1495,11 +1504,9 @@ const Vector3 &Node::GetNetPositionAttr() const
     return position_;
 }
 
-const PODVector<unsigned char>& Node::GetNetRotationAttr() const
+const Quaternion &Node::GetNetRotationAttr() const
 {
-    impl_->attrBuffer_.Clear();
-    impl_->attrBuffer_.WritePackedQuaternion(rotation_);
-    return impl_->attrBuffer_.GetBuffer();
+    return rotation_;
 }
 
 const PODVector<unsigned char>& Node::GetNetParentAttr() const
@@ -1692,6 +1699,7 @@ void Node::PrepareNetworkUpdate()
 
     const Vector<AttributeInfo>* attributes = networkState_->attributes_;
     unsigned numAttributes = attributes->Size();
+    DirtyBits changedAttributes;
 
     // Check for attribute changes
     for (auto i = 0u; i < numAttributes; ++i)
@@ -1706,6 +1714,7 @@ void Node::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            changedAttributes.Set(i);
 
             // Mark the attribute dirty in all replication states that are tracking this node
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
@@ -1724,6 +1733,10 @@ void Node::PrepareNetworkUpdate()
         }
     }
 
+    // Serialize the changed attributes once for all connections
+    if (changedAttributes.Count())
+        UpdateNetworkSnapshot(changedAttributes);
+
     // Finally check for user var changes
     for (VariantMap::ConstIterator i = vars_.Begin(); i != vars_.End(); ++i)
     {
@@ -2081,6 +2094,10 @@ void Node::UpdateWorldTransform() const
         worldRotation_ = parent_->GetWorldRotation() * rotation_;
     }
 
+    // Keep the transform store in sync, as children may be recalculated there later
+    if (TransformStore* store = scene_ ? scene_->GetTransformStore() : 0)
+        store->SetWorldTransform(transformIndex_, worldTransform_, worldRotation_);
+
     dirty_ = false;
 }
 
@@ -75,6 +75,8 @@ class FLOCKSDK_API Node : public Animatable
     FLOCKSDK_OBJECT(Node, Animatable);
 
     friend class Connection;
+    friend class TransformStore;
+    friend void UpdateTransformsWork(unsigned start, unsigned end, unsigned threadIndex, void* data);
 
 public:
     /// Construct.
@@ -579,13 +581,13 @@ public:
     /// Set network position attribute.
     void SetNetPositionAttr(const Vector3 &value);
     /// Set network rotation attribute.
-    void SetNetRotationAttr(const PODVector<unsigned char>& value);
+    void SetNetRotationAttr(const Quaternion &value);
     /// Set network parent attribute.
     void SetNetParentAttr(const PODVector<unsigned char>& value);
     /// Return network position attribute.
     const Vector3 &GetNetPositionAttr() const;
     /// Return network rotation attribute.
-    const PODVector<unsigned char>& GetNetRotationAttr() const;
+    const Quaternion &GetNetRotationAttr() const;
     /// Return network parent attribute.
     const PODVector<unsigned char>& GetNetParentAttr() const;
     /// Load components and optionally load child nodes.
@@ -687,6 +689,8 @@ private:
     Vector3 scale_;
     /// World-space rotation.
     mutable Quaternion worldRotation_;
+    /// Index in the scene's transform store, if enabled.
+    unsigned transformIndex_;
     /// Components.
     Vector<SharedPtr<Component> > components_;
     /// Child scene nodes.
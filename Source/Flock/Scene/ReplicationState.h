@@ -26,6 +26,7 @@
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
 #include "../Container/Ptr.h"
+#include "../IO/VectorBuffer.h"
 #include "../Math/StringHash.h"
 
 #include <cstring>
@@ -115,6 +116,12 @@ struct FLOCKSDK_API DirtyBits
     /// Return number of set bits.
     unsigned Count() const { return count_; }
 
+    /// Test for equality with another set of bits.
+    bool operator ==(const DirtyBits& rhs) const
+    {
+        return count_ == rhs.count_ && !memcmp(data_, rhs.data_, MAX_NETWORK_ATTRIBUTES / 8);
+    }
+
     /// Bit data.
     unsigned char data_[MAX_NETWORK_ATTRIBUTES / 8];
     /// Number of set bits.
@@ -126,7 +133,10 @@ struct FLOCKSDK_API NetworkState
 {
     /// Construct with defaults.
     NetworkState() :
-        interceptMask_(0)
+        interceptMask_(0),
+        deltaSnapshotValid_(false),
+        latestDataSnapshotValid_(false),
+        initialSnapshotValid_(false)
     {
     }
 
@@ -142,6 +152,26 @@ struct FLOCKSDK_API NetworkState
     VariantMap previousVars_;
     /// Bitmask for intercepting network messages. Used on the client only.
     unsigned long long interceptMask_;
+    /// Attribute bits of the shared delta update payload.
+    DirtyBits deltaSnapshotBits_;
+    /// Delta update payload without the time stamp, serialized once per change and shared by all connections.
+    VectorBuffer deltaSnapshot_;
+    /// Latest data payload without the time stamp, shared by all connections.
+    VectorBuffer latestDataSnapshot_;
+    /// Initial delta update payload without the time stamp, shared by all connections.
+    VectorBuffer initialSnapshot_;
+    /// Delta update payload valid flag.
+    bool deltaSnapshotValid_;
+    /// Latest data payload valid flag.
+    bool latestDataSnapshotValid_;
+    /// Initial delta update payload valid flag.
+    bool initialSnapshotValid_;
+    /// Quantized values of the quantized attributes. On the server these track the current values, on the client the last received values that deltas apply to.
+    PODVector<int> quantizedValues_;
+    /// Quantized default values of the quantized attributes.
+    PODVector<int> quantizedDefaults_;
+    /// Quantized values the shared delta update payload is relative to.
+    PODVector<int> deltaSnapshotBaseline_;
 };
 
 /// Base class for per-user network replication states.
@@ -160,6 +190,8 @@ struct FLOCKSDK_API ComponentReplicationState : public ReplicationState
     WeakPtr<Component> component_;
     /// Dirty attribute bits.
     DirtyBits dirtyAttributes_;
+    /// Quantized attribute values last sent to the client.
+    PODVector<int> quantizedBaseline_;
 };
 
 /// Per-user node network replication state.
@@ -181,6 +213,8 @@ struct FLOCKSDK_API NodeReplicationState : public ReplicationState
     DirtyBits dirtyAttributes_;
     /// Dirty user vars.
     HashSet<StringHash> dirtyVars_;
+    /// Quantized attribute values last sent to the client.
+    PODVector<int> quantizedBaseline_;
     /// Components by ID.
     HashMap<unsigned, ComponentReplicationState> componentStates_;
     /// Interest management priority accumulator.
@@ -349,9 +349,14 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
         {
             FLOCKSDK_PROFILE(FindResourcesToPreload);
 
-            unsigned currentPos = file->GetPosition();
-            PreloadResources(file, isSceneFile);
-            file->Seek(currentPos);
+            if (!LoadResourceManifest(file))
+            {
+                unsigned currentPos = file->GetPosition();
+                PreloadResources(file, isSceneFile);
+                file->Seek(currentPos);
+                StoreResourceManifest(file);
+            }
+            QueuePreloadResources();
         }
 
         // Store own old ID for resolving possible root node references
@@ -373,7 +378,12 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
         FLOCKSDK_PROFILE(FindResourcesToPreload);
 
         FLOCKSDK_LOGINFO("Preloading resources from " + file->GetName());
-        PreloadResources(file, isSceneFile);
+        if (!LoadResourceManifest(file))
+        {
+            PreloadResources(file, isSceneFile);
+            StoreResourceManifest(file);
+        }
+        QueuePreloadResources();
     }
 
     return true;
@@ -415,7 +425,12 @@ bool Scene::LoadAsyncXML(File* file, LoadMode mode)
         {
             FLOCKSDK_PROFILE(FindResourcesToPreload);
 
-            PreloadResourcesXML(rootElement);
+            if (!LoadResourceManifest(file))
+            {
+                PreloadResourcesXML(rootElement);
+                StoreResourceManifest(file);
+            }
+            QueuePreloadResources();
         }
 
         // Store own old ID for resolving possible root node references
@@ -442,7 +457,12 @@ bool Scene::LoadAsyncXML(File* file, LoadMode mode)
         FLOCKSDK_PROFILE(FindResourcesToPreload);
 
         FLOCKSDK_LOGINFO("Preloading resources from " + file->GetName());
-        PreloadResourcesXML(xml->GetRoot());
+        if (!LoadResourceManifest(file))
+        {
+            PreloadResourcesXML(xml->GetRoot());
+            StoreResourceManifest(file);
+        }
+        QueuePreloadResources();
     }
 
     return true;
@@ -484,7 +504,12 @@ bool Scene::LoadAsyncJSON(File* file, LoadMode mode)
         {
             FLOCKSDK_PROFILE(FindResourcesToPreload);
 
-            PreloadResourcesJSON(rootVal);
+            if (!LoadResourceManifest(file))
+            {
+                PreloadResourcesJSON(rootVal);
+                StoreResourceManifest(file);
+            }
+            QueuePreloadResources();
         }
 
         // Store own old ID for resolving possible root node references
@@ -507,7 +532,12 @@ bool Scene::LoadAsyncJSON(File* file, LoadMode mode)
         FLOCKSDK_PROFILE(FindResourcesToPreload);
 
         FLOCKSDK_LOGINFO("Preloading resources from " + file->GetName());
-        PreloadResourcesJSON(json->GetRoot());
+        if (!LoadResourceManifest(file))
+        {
+            PreloadResourcesJSON(json->GetRoot());
+            StoreResourceManifest(file);
+        }
+        QueuePreloadResources();
     }
 
     return true;
@@ -522,6 +552,7 @@ void Scene::StopAsyncLoading()
     asyncProgress_.xmlElement_ = XMLElement::EMPTY;
     asyncProgress_.jsonIndex_ = 0;
     asyncProgress_.resources_.Clear();
+    asyncProgress_.preloadResources_.Clear();
     resolver_.Reset();
 }
 
@@ -803,12 +834,30 @@ void Scene::Update(float timeStep)
     // Post-update variable timestep logic
     SendEvent(E_SCENEPOSTUPDATE, eventData);
 
+    // Recalculate the world transforms dirtied during the update in one batched pass
+    if (transformStore_)
+    {
+        FLOCKSDK_PROFILE(UpdateTransforms);
+        transformStore_->Update();
+    }
+
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
     // SetElapsedTime()
     elapsedTime_ += timeStep;
 }
 
+void Scene::SetTransformStoreEnabled(bool enable)
+{
+    if (enable == IsTransformStoreEnabled())
+        return;
+
+    if (enable)
+        transformStore_ = new TransformStore(this);
+    else
+        transformStore_.Reset();
+}
+
 void Scene::BeginThreadedUpdate()
 {
     // Check the work queue subsystem whether it actually has created worker threads. If not, do not enter threaded mode.
@@ -914,6 +963,8 @@ void Scene::NodeAdded(Node* node)
         oldScene->NodeRemoved(node);
 
     node->SetScene(this);
+    if (transformStore_)
+        transformStore_->MarkStructureDirty();
 
     // If the new node has an ID of zero (default), assign a replicated ID now
     unsigned id = node->GetID();
@@ -991,6 +1042,8 @@ void Scene::NodeRemoved(Node* node)
         localNodes_.Erase(id);
 
     node->ResetScene();
+    if (transformStore_)
+        transformStore_->MarkStructureDirty();
 
     // Remove node from tag cache
     if (!node->GetTags().Empty())
@@ -1106,6 +1159,13 @@ void Scene::PrepareNetworkUpdate()
 
     networkUpdateNodes_.Clear();
     networkUpdateComponents_.Clear();
+
+    // Update dirty world transforms now, as connections read them from worker threads for update prioritization
+    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    {
+        if (i->second_->IsDirty())
+            i->second_->GetWorldTransform();
+    }
 }
 
 void Scene::CleanupConnection(Connection* connection)
@@ -1291,9 +1351,6 @@ void Scene::FinishSaving(Serializer* dest) const
 
 void Scene::PreloadResources(File* file, bool isSceneFile)
 {
-    // If not threaded, can not background load resources, so rather load synchronously later when needed
-    ResourceCache* cache = GetSubsystem<ResourceCache>();
-
     // Read node ID (not needed)
     /*unsigned nodeID = */file->ReadUInt();
 
@@ -1330,28 +1387,13 @@ void Scene::PreloadResources(File* file, bool isSceneFile)
                 if (attr.type_ == VAR_RESOURCEREF)
                 {
                     const ResourceRef& ref = varValue.GetResourceRef();
-                    // Sanitate resource name beforehand so that when we get the background load event, the name matches exactly
-                    String name = cache->SanitateResourceName(ref.name_);
-                    bool success = cache->BackgroundLoadResource(ref.type_, name);
-                    if (success)
-                    {
-                        ++asyncProgress_.totalResources_;
-                        asyncProgress_.resources_.Insert(StringHash(name));
-                    }
+                    AddPreloadResource(ref.type_, ref.name_);
                 }
                 else if (attr.type_ == VAR_RESOURCEREFLIST)
                 {
                     const ResourceRefList& refList = varValue.GetResourceRefList();
                     for (unsigned k = 0; k < refList.names_.Size(); ++k)
-                    {
-                        String name = cache->SanitateResourceName(refList.names_[k]);
-                        bool success = cache->BackgroundLoadResource(refList.type_, name);
-                        if (success)
-                        {
-                            ++asyncProgress_.totalResources_;
-                            asyncProgress_.resources_.Insert(StringHash(name));
-                        }
-                    }
+                        AddPreloadResource(refList.type_, refList.names_[k]);
                 }
             }
         }
@@ -1365,9 +1407,6 @@ void Scene::PreloadResources(File* file, bool isSceneFile)
 
 void Scene::PreloadResourcesXML(const XMLElement& element)
 {
-    // If not threaded, can not background load resources, so rather load synchronously later when needed
-    ResourceCache* cache = GetSubsystem<ResourceCache>();
-
     // Node or Scene attributes do not include any resources; therefore skip to the components
     XMLElement compElem = element.GetChild("component");
     while (compElem)
@@ -1393,27 +1432,13 @@ void Scene::PreloadResourcesXML(const XMLElement& element)
                         if (attr.type_ == VAR_RESOURCEREF)
                         {
                             ResourceRef ref = attrElem.GetVariantValue(attr.type_).GetResourceRef();
-                            String name = cache->SanitateResourceName(ref.name_);
-                            bool success = cache->BackgroundLoadResource(ref.type_, name);
-                            if (success)
-                            {
-                                ++asyncProgress_.totalResources_;
-                                asyncProgress_.resources_.Insert(StringHash(name));
-                            }
+                            AddPreloadResource(ref.type_, ref.name_);
                         }
                         else if (attr.type_ == VAR_RESOURCEREFLIST)
                         {
                             ResourceRefList refList = attrElem.GetVariantValue(attr.type_).GetResourceRefList();
                             for (unsigned k = 0; k < refList.names_.Size(); ++k)
-                            {
-                                String name = cache->SanitateResourceName(refList.names_[k]);
-                                bool success = cache->BackgroundLoadResource(refList.type_, name);
-                                if (success)
-                                {
-                                    ++asyncProgress_.totalResources_;
-                                    asyncProgress_.resources_.Insert(StringHash(name));
-                                }
-                            }
+                                AddPreloadResource(refList.type_, refList.names_[k]);
                         }
 
                         startIndex = (i + 1) % attributes->Size();
@@ -1443,9 +1468,6 @@ void Scene::PreloadResourcesXML(const XMLElement& element)
 
 void Scene::PreloadResourcesJSON(const JSONValue& value)
 {
-    // If not threaded, can not background load resources, so rather load synchronously later when needed
-    ResourceCache* cache = GetSubsystem<ResourceCache>();
-
     // Node or Scene attributes do not include any resources; therefore skip to the components
     JSONArray componentArray = value.Get("components").GetArray();
 
@@ -1476,27 +1498,13 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
                         if (attr.type_ == VAR_RESOURCEREF)
                         {
                             ResourceRef ref = attrVal.Get("value").GetVariantValue(attr.type_).GetResourceRef();
-                            String name = cache->SanitateResourceName(ref.name_);
-                            bool success = cache->BackgroundLoadResource(ref.type_, name);
-                            if (success)
-                            {
-                                ++asyncProgress_.totalResources_;
-                                asyncProgress_.resources_.Insert(StringHash(name));
-                            }
+                            AddPreloadResource(ref.type_, ref.name_);
                         }
                         else if (attr.type_ == VAR_RESOURCEREFLIST)
                         {
                             ResourceRefList refList = attrVal.Get("value").GetVariantValue(attr.type_).GetResourceRefList();
                             for (unsigned k = 0; k < refList.names_.Size(); ++k)
-                            {
-                                String name = cache->SanitateResourceName(refList.names_[k]);
-                                bool success = cache->BackgroundLoadResource(refList.type_, name);
-                                if (success)
-                                {
-                                    ++asyncProgress_.totalResources_;
-                                    asyncProgress_.resources_.Insert(StringHash(name));
-                                }
-                            }
+                                AddPreloadResource(refList.type_, refList.names_[k]);
                         }
 
                         startIndex = (i + 1) % attributes->Size();
@@ -1522,6 +1530,88 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
     }
 }
 
+void Scene::AddPreloadResource(StringHash type, const String &name)
+{
+    // Sanitate resource name beforehand so that when we get the background load event, the name matches exactly
+    String sanitatedName = GetSubsystem<ResourceCache>()->SanitateResourceName(name);
+    if (!sanitatedName.Empty())
+        asyncProgress_.preloadResources_.Push(ResourceRef(type, sanitatedName));
+}
+
+bool Scene::LoadResourceManifest(File* file)
+{
+    asyncProgress_.preloadResources_.Clear();
+
+    // Without a checksum a changed file could not be detected, so always collect the resources again
+    unsigned checksum = file->GetChecksum();
+    if (!checksum)
+        return false;
+
+    const Vector<ResourceRef>* manifest = GetSubsystem<ResourceCache>()->GetResourceManifest(file->GetName(), checksum);
+    if (!manifest)
+        return false;
+
+    asyncProgress_.preloadResources_ = *manifest;
+    return true;
+}
+
+void Scene::StoreResourceManifest(File* file)
+{
+    unsigned checksum = file->GetChecksum();
+    if (checksum)
+        GetSubsystem<ResourceCache>()->SetResourceManifest(file->GetName(), checksum, asyncProgress_.preloadResources_);
+}
+
+void Scene::QueuePreloadResources()
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    const Vector<ResourceRef>& resources = asyncProgress_.preloadResources_;
+
+    // Expand the preload list breadth first with the dependencies the resources requested when they were last background
+    // loaded, so that the whole closure is queued up front instead of being discovered one level at a time
+    Vector<ResourceRef> closure;
+    PODVector<unsigned> depths;
+    HashSet<Pair<StringHash, StringHash> > visited;
+    for (auto i = 0u; i < resources.Size(); ++i)
+    {
+        Pair<StringHash, StringHash> key = MakePair(resources[i].type_, StringHash(resources[i].name_));
+        if (!visited.Contains(key))
+        {
+            visited.Insert(key);
+            closure.Push(resources[i]);
+            depths.Push(0);
+        }
+    }
+
+    Vector<ResourceRef> dependencies;
+    for (auto i = 0u; i < closure.Size(); ++i)
+    {
+        unsigned depth = depths[i] + 1;
+        dependencies.Clear();
+        cache->GetBackgroundLoadDependencies(closure[i].type_, closure[i].name_, dependencies);
+        for (auto j = 0u; j < dependencies.Size(); ++j)
+        {
+            Pair<StringHash, StringHash> key = MakePair(dependencies[j].type_, StringHash(dependencies[j].name_));
+            if (!visited.Contains(key))
+            {
+                visited.Insert(key);
+                closure.Push(dependencies[j]);
+                depths.Push(depth);
+            }
+        }
+    }
+
+    // Deeper dependencies get higher priority, as the resources referring to them can not finish loading before them
+    for (auto i = 0u; i < closure.Size(); ++i)
+    {
+        if (cache->BackgroundLoadResource(closure[i].type_, closure[i].name_, true, 0, depths[i]))
+        {
+            ++asyncProgress_.totalResources_;
+            asyncProgress_.resources_.Insert(StringHash(closure[i].name_));
+        }
+    }
+}
+
 void RegisterSceneLibrary(Context* context)
 {
     ValueAnimation::RegisterObject(context);
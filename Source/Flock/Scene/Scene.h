@@ -28,6 +28,7 @@
 #include "../Resource/JSONFile.h"
 #include "../Scene/Node.h"
 #include "../Scene/SceneResolver.h"
+#include "../Scene/TransformStore.h"
 
 namespace FlockSDK
 {
@@ -71,6 +72,8 @@ struct AsyncProgress
     LoadMode mode_;
     /// Resource name hashes left to load.
     HashSet<StringHash> resources_;
+    /// Resources referenced by the file, collected for preloading.
+    Vector<ResourceRef> preloadResources_;
     /// Loaded resources.
     unsigned loadedResources_;
     /// Total resources.
@@ -211,6 +214,13 @@ public:
     /// Return a node user variable name, or empty if not registered.
     const String &GetVarName(StringHash hash) const;
 
+    /// Set whether to keep node transforms in a contiguous transform store and recalculate dirty world transforms in one batched pass per frame. Recommended for scenes with a large number of nodes.
+    void SetTransformStoreEnabled(bool enable);
+    /// Return whether the transform store is enabled.
+    bool IsTransformStoreEnabled() const { return transformStore_.Get() != 0; }
+    /// Return the transform store, or null if not enabled.
+    TransformStore* GetTransformStore() const { return transformStore_.Get(); }
+
     /// Update scene. Called by HandleUpdate.
     void Update(float timeStep);
     /// Begin a threaded update. During threaded update components can choose to delay dirty processing.
@@ -222,6 +232,10 @@ public:
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
+    /// Return replicated nodes by ID.
+    const HashMap<unsigned, Node*>& GetReplicatedNodes() const { return replicatedNodes_; }
+    /// Return the mutex guarding replication state registration while connections serialize updates in parallel.
+    Mutex& GetReplicationMutex() { return replicationMutex_; }
 
     /// Get free node ID, either non-local or local.
     unsigned GetFreeNodeID(CreateMode mode);
@@ -275,6 +289,14 @@ private:
     void PreloadResourcesXML(const XMLElement& element);
     /// Preload resources from a JSON scene or object prefab file.
     void PreloadResourcesJSON(const JSONValue& value);
+    /// Add a resource referenced by the file being loaded to the preload list.
+    void AddPreloadResource(StringHash type, const String &name);
+    /// Fill the preload list from the resource manifest cached for the file. Return true if it exists and the file is unchanged.
+    bool LoadResourceManifest(File* file);
+    /// Cache the collected preload list as the resource manifest of the file.
+    void StoreResourceManifest(File* file);
+    /// Queue the preload list and the known dependencies of each resource for background loading.
+    void QueuePreloadResources();
 
     /// Replicated scene nodes by ID.
     HashMap<unsigned, Node*> replicatedNodes_;
@@ -304,6 +326,10 @@ private:
     PODVector<Component*> delayedDirtyComponents_;
     /// Mutex for the delayed dirty notification queue.
     Mutex sceneMutex_;
+    /// Mutex for adding and removing replication states from worker threads.
+    Mutex replicationMutex_;
+    /// Transform store, if enabled.
+    UniquePtr<TransformStore> transformStore_;
     /// Preallocated event data map for smoothing update events.
     VariantMap smoothingData_;
     /// Next free non-local node ID.
@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../IO/BitStream.h"
 #include "../IO/Deserializer.h"
 #include "../IO/Log.h"
 #include "../IO/Serializer.h"
@@ -711,6 +712,254 @@ void Serializable::SetInterceptNetworkUpdate(const String &attributeName, bool e
     }
 }
 
+static unsigned GetQuantizedComponents(const AttributeInfo& attr)
+{
+    if (attr.quantizePrecision_ <= 0.0f)
+        return 0;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        return 1;
+
+    case VAR_VECTOR2:
+        return 2;
+
+    case VAR_VECTOR3:
+        return 3;
+
+    case VAR_VECTOR4:
+    case VAR_QUATERNION:
+        return 4;
+
+    default:
+        return 0;
+    }
+}
+
+static unsigned GetQuantizedBits(const AttributeInfo& attr)
+{
+    auto steps = (unsigned)RoundToInt((attr.quantizeMax_ - attr.quantizeMin_) / attr.quantizePrecision_);
+    auto bits = 0u;
+    while (bits < 32 && (steps >> bits))
+        ++bits;
+    return bits;
+}
+
+static void QuantizeValue(const AttributeInfo& attr, const Variant& value, int* dest)
+{
+    float components[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        components[0] = value.GetFloat();
+        break;
+
+    case VAR_VECTOR2:
+        {
+            const Vector2& vector = value.GetVector2();
+            components[0] = vector.x_;
+            components[1] = vector.y_;
+        }
+        break;
+
+    case VAR_VECTOR3:
+        {
+            const Vector3& vector = value.GetVector3();
+            components[0] = vector.x_;
+            components[1] = vector.y_;
+            components[2] = vector.z_;
+        }
+        break;
+
+    case VAR_VECTOR4:
+        {
+            const Vector4& vector = value.GetVector4();
+            components[0] = vector.x_;
+            components[1] = vector.y_;
+            components[2] = vector.z_;
+            components[3] = vector.w_;
+        }
+        break;
+
+    case VAR_QUATERNION:
+        {
+            const Quaternion& quat = value.GetQuaternion();
+            components[0] = quat.w_;
+            components[1] = quat.x_;
+            components[2] = quat.y_;
+            components[3] = quat.z_;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    unsigned numComponents = GetQuantizedComponents(attr);
+    for (auto i = 0u; i < numComponents; ++i)
+    {
+        dest[i] = RoundToInt((Clamp(components[i], attr.quantizeMin_, attr.quantizeMax_) - attr.quantizeMin_) /
+            attr.quantizePrecision_);
+    }
+}
+
+static Variant DequantizeValue(const AttributeInfo& attr, const int* src)
+{
+    float components[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    unsigned numComponents = GetQuantizedComponents(attr);
+    for (auto i = 0u; i < numComponents; ++i)
+        components[i] = attr.quantizeMin_ + (float)src[i] * attr.quantizePrecision_;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        return Variant(components[0]);
+
+    case VAR_VECTOR2:
+        return Variant(Vector2(components[0], components[1]));
+
+    case VAR_VECTOR3:
+        return Variant(Vector3(components[0], components[1], components[2]));
+
+    case VAR_VECTOR4:
+        return Variant(Vector4(components[0], components[1], components[2], components[3]));
+
+    case VAR_QUATERNION:
+        return Variant(Quaternion(components[0], components[1], components[2], components[3]).Normalized());
+
+    default:
+        return Variant::EMPTY;
+    }
+}
+
+static bool MatchQuantized(const NetworkState& state, const DirtyBits& attributeBits, const PODVector<int>& lhs,
+    const PODVector<int>& rhs)
+{
+    if (state.quantizedValues_.Empty())
+        return true;
+
+    unsigned offset = 0;
+    for (auto i = 0u; i < state.attributes_->Size(); ++i)
+    {
+        unsigned numComponents = GetQuantizedComponents(state.attributes_->At(i));
+        if (numComponents && attributeBits.IsSet(i))
+        {
+            for (auto j = offset; j < offset + numComponents; ++j)
+            {
+                if (lhs[j] != rhs[j])
+                    return false;
+            }
+        }
+        offset += numComponents;
+    }
+
+    return true;
+}
+
+static void CopyQuantized(const NetworkState& state, const DirtyBits& attributeBits, const PODVector<int>& src,
+    PODVector<int>& dest)
+{
+    if (state.quantizedValues_.Empty())
+        return;
+
+    unsigned offset = 0;
+    for (auto i = 0u; i < state.attributes_->Size(); ++i)
+    {
+        unsigned numComponents = GetQuantizedComponents(state.attributes_->At(i));
+        if (numComponents && attributeBits.IsSet(i))
+        {
+            for (auto j = offset; j < offset + numComponents; ++j)
+                dest[j] = src[j];
+        }
+        offset += numComponents;
+    }
+}
+
+static void WriteBitBlock(Serializer& dest, const BitWriter& bits)
+{
+    dest.WriteVLE(bits.GetSize());
+    dest.Write(bits.GetData(), bits.GetSize());
+}
+
+static bool ReadBitBlock(Deserializer& source, PODVector<unsigned char>& dest)
+{
+    dest.Resize(source.ReadVLE());
+    return dest.Empty() || source.Read(&dest[0], dest.Size()) == dest.Size();
+}
+
+static void WriteDeltaData(Serializer& dest, const NetworkState& state, const DirtyBits& attributeBits,
+    const PODVector<int>& baseline)
+{
+    unsigned numAttributes = state.attributes_->Size();
+    BitWriter quantized;
+    bool hasQuantized = false;
+    unsigned offset = 0;
+
+    // First write the change bitfield, then attribute data for changed attributes. Quantized attributes follow
+    // bit-packed as differences to the values the client received last
+    dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
+
+    for (auto i = 0u; i < numAttributes; ++i)
+    {
+        unsigned numComponents = GetQuantizedComponents(state.attributes_->At(i));
+        if (attributeBits.IsSet(i))
+        {
+            if (numComponents)
+            {
+                hasQuantized = true;
+                for (auto j = offset; j < offset + numComponents; ++j)
+                    quantized.WriteVarInt(state.quantizedValues_[j] - baseline[j]);
+            }
+            else
+                dest.WriteVariantData(state.currentValues_[i]);
+        }
+        offset += numComponents;
+    }
+
+    if (hasQuantized)
+        WriteBitBlock(dest, quantized);
+}
+
+static void WriteLatestData(Serializer& dest, const NetworkState& state)
+{
+    unsigned numAttributes = state.attributes_->Size();
+    BitWriter quantized;
+    bool hasQuantized = false;
+    unsigned offset = 0;
+
+    // Latest data may arrive out of order, so quantized attributes are written in full
+    for (auto i = 0u; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = state.attributes_->At(i);
+        unsigned numComponents = GetQuantizedComponents(attr);
+        if (attr.mode_ & AM_LATESTDATA)
+        {
+            if (numComponents)
+            {
+                hasQuantized = true;
+                unsigned bits = GetQuantizedBits(attr);
+                for (auto j = offset; j < offset + numComponents; ++j)
+                    quantized.WriteBits((unsigned)state.quantizedValues_[j], bits);
+            }
+            else
+                dest.WriteVariantData(state.currentValues_[i]);
+        }
+        offset += numComponents;
+    }
+
+    if (hasQuantized)
+        WriteBitBlock(dest, quantized);
+}
+
+void Serializable::RemoveReplicationState(ReplicationState* state)
+{
+    if (networkState_)
+        networkState_->replicationStates_.Remove(state);
+}
+
 void Serializable::AllocateNetworkState()
 {
     if (networkState_)
@@ -733,10 +982,24 @@ void Serializable::AllocateNetworkState()
         // Copy the default attribute values to the previous state as a starting point
         for (auto i = 0u; i < numAttributes; ++i)
             networkState_->previousValues_[i] = networkAttributes->At(i).defaultValue_;
+
+        // Quantized values likewise start from the defaults, on both the server and the client
+        for (auto i = 0u; i < numAttributes; ++i)
+        {
+            const AttributeInfo& attr = networkAttributes->At(i);
+            unsigned numComponents = GetQuantizedComponents(attr);
+            if (numComponents)
+            {
+                unsigned offset = networkState_->quantizedDefaults_.Size();
+                networkState_->quantizedDefaults_.Resize(offset + numComponents);
+                QuantizeValue(attr, attr.defaultValue_, &networkState_->quantizedDefaults_[offset]);
+            }
+        }
+        networkState_->quantizedValues_ = networkState_->quantizedDefaults_;
     }
 }
 
-void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp)
+void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp, PODVector<int>& baseline)
 {
     if (!networkState_)
     {
@@ -748,29 +1011,35 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
     if (!attributes)
         return;
 
-    unsigned numAttributes = attributes->Size();
-    DirtyBits attributeBits;
-
-    // Compare against defaults
-    for (auto i = 0u; i < numAttributes; ++i)
+    // The initial state is serialized once and shared by all connections until the attributes change. Connection calls
+    // this under the scene's replication mutex, as the payload may be built from a worker thread
+    if (!networkState_->initialSnapshotValid_)
     {
-        const AttributeInfo& attr = attributes->At(i);
-        if (networkState_->currentValues_[i] != attr.defaultValue_)
-            attributeBits.Set(i);
+        unsigned numAttributes = attributes->Size();
+        DirtyBits attributeBits;
+
+        // Compare against defaults
+        for (auto i = 0u; i < numAttributes; ++i)
+        {
+            const AttributeInfo& attr = attributes->At(i);
+            if (networkState_->currentValues_[i] != attr.defaultValue_)
+                attributeBits.Set(i);
+        }
+
+        networkState_->initialSnapshot_.Clear();
+        WriteDeltaData(networkState_->initialSnapshot_, *networkState_, attributeBits, networkState_->quantizedDefaults_);
+        networkState_->initialSnapshotValid_ = true;
     }
 
-    // First write the change bitfield, then attribute data for non-default attributes
     dest.WriteUByte(timeStamp);
-    dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
+    dest.Write(networkState_->initialSnapshot_.GetData(), networkState_->initialSnapshot_.GetSize());
 
-    for (auto i = 0u; i < numAttributes; ++i)
-    {
-        if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
-    }
+    // The client now has the current quantized values, either received or left at their defaults
+    baseline = networkState_->quantizedValues_;
 }
 
-void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp)
+void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp,
+    PODVector<int>& baseline)
 {
     if (!networkState_)
     {
@@ -782,18 +1051,21 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
     if (!attributes)
         return;
 
-    unsigned numAttributes = attributes->Size();
+    if (baseline.Size() != networkState_->quantizedValues_.Size())
+        baseline = networkState_->quantizedDefaults_;
 
-    // First write the change bitfield, then attribute data for changed attributes
     // Note: the attribute bits should not contain LATESTDATA attributes
     dest.WriteUByte(timeStamp);
-    dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
 
-    for (auto i = 0u; i < numAttributes; ++i)
-    {
-        if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
-    }
+    // Reuse the shared payload if the connection needs exactly the attributes changed on the last update, and has
+    // received the quantized values it is relative to
+    if (networkState_->deltaSnapshotValid_ && attributeBits == networkState_->deltaSnapshotBits_ &&
+        MatchQuantized(*networkState_, attributeBits, baseline, networkState_->deltaSnapshotBaseline_))
+        dest.Write(networkState_->deltaSnapshot_.GetData(), networkState_->deltaSnapshot_.GetSize());
+    else
+        WriteDeltaData(dest, *networkState_, attributeBits, baseline);
+
+    CopyQuantized(*networkState_, attributeBits, networkState_->quantizedValues_, baseline);
 }
 
 void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp)
@@ -808,15 +1080,77 @@ void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeSta
     if (!attributes)
         return;
 
-    unsigned numAttributes = attributes->Size();
-
     dest.WriteUByte(timeStamp);
 
-    for (auto i = 0u; i < numAttributes; ++i)
+    if (networkState_->latestDataSnapshotValid_)
+        dest.Write(networkState_->latestDataSnapshot_.GetData(), networkState_->latestDataSnapshot_.GetSize());
+    else
+        WriteLatestData(dest, *networkState_);
+}
+
+void Serializable::UpdateNetworkSnapshot(const DirtyBits& changedAttributes)
+{
+    if (!networkState_ || !networkState_->attributes_)
+        return;
+
+    networkState_->deltaSnapshotValid_ = false;
+    networkState_->latestDataSnapshotValid_ = false;
+    networkState_->initialSnapshotValid_ = false;
+
+    const Vector<AttributeInfo>* attributes = networkState_->attributes_;
+
+    // Track the quantized values. The shared delta payload is relative to the values before this change
+    if (!networkState_->quantizedValues_.Empty())
+    {
+        networkState_->deltaSnapshotBaseline_ = networkState_->quantizedValues_;
+
+        unsigned offset = 0;
+        for (auto i = 0u; i < attributes->Size(); ++i)
+        {
+            const AttributeInfo& attr = attributes->At(i);
+            unsigned numComponents = GetQuantizedComponents(attr);
+            if (numComponents && changedAttributes.IsSet(i))
+                QuantizeValue(attr, networkState_->currentValues_[i], &networkState_->quantizedValues_[offset]);
+            offset += numComponents;
+        }
+    }
+
+    // Sharing pays off only when more than one connection is tracking the object
+    if (networkState_->replicationStates_.Size() < 2)
+        return;
+
+    DirtyBits deltaBits(changedAttributes);
+    bool hasLatestData = false;
+
+    for (auto i = 0u; i < attributes->Size(); ++i)
+    {
+        if (deltaBits.IsSet(i) && (attributes->At(i).mode_ & AM_LATESTDATA))
+        {
+            hasLatestData = true;
+            deltaBits.Clear(i);
+        }
+    }
+
+    if (hasLatestData)
     {
-        if (attributes->At(i).mode_ & AM_LATESTDATA)
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+        networkState_->latestDataSnapshot_.Clear();
+        WriteLatestData(networkState_->latestDataSnapshot_, *networkState_);
+        networkState_->latestDataSnapshotValid_ = true;
     }
+
+    if (deltaBits.Count())
+    {
+        networkState_->deltaSnapshotBits_ = deltaBits;
+        networkState_->deltaSnapshot_.Clear();
+        WriteDeltaData(networkState_->deltaSnapshot_, *networkState_, deltaBits, networkState_->deltaSnapshotBaseline_);
+        networkState_->deltaSnapshotValid_ = true;
+    }
+}
+
+void Serializable::ResetNetworkBaseline()
+{
+    if (networkState_)
+        networkState_->quantizedValues_ = networkState_->quantizedDefaults_;
 }
 
 bool Serializable::ReadDeltaUpdate(Deserializer& source)
@@ -828,6 +1162,7 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
     unsigned numAttributes = attributes->Size();
     DirtyBits attributeBits;
     bool changed = false;
+    bool hasQuantized = false;
 
     unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
     unsigned char timeStamp = source.ReadUByte();
@@ -838,23 +1173,37 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
         if (attributeBits.IsSet(i))
         {
             const AttributeInfo& attr = attributes->At(i);
-            if (!(interceptMask & (1ULL << i)))
-            {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
-                changed = true;
-            }
+            if (GetQuantizedComponents(attr))
+                hasQuantized = true;
             else
+                changed |= SetNetworkAttribute(attr, i, source.ReadVariant(attr.type_), timeStamp, interceptMask);
+        }
+    }
+
+    // Then apply the quantized differences to the last received values
+    if (hasQuantized)
+    {
+        PODVector<unsigned char> data;
+        if (!ReadBitBlock(source, data))
+            return changed;
+
+        AllocateNetworkState();
+        PODVector<int>& values = networkState_->quantizedValues_;
+        BitReader reader(data.Size() ? &data[0] : 0, data.Size());
+        unsigned offset = 0;
+
+        for (auto i = 0u; i < numAttributes; ++i)
+        {
+            const AttributeInfo& attr = attributes->At(i);
+            unsigned numComponents = GetQuantizedComponents(attr);
+            if (numComponents && attributeBits.IsSet(i) && offset + numComponents <= values.Size())
             {
-                using namespace InterceptNetworkUpdate;
-
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_SERIALIZABLE] = this;
-                eventData[P_TIMESTAMP] = (unsigned)timeStamp;
-                eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
-                eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
-                SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
+                for (auto j = offset; j < offset + numComponents; ++j)
+                    values[j] += reader.ReadVarInt();
+
+                changed |= SetNetworkAttribute(attr, i, DequantizeValue(attr, &values[offset]), timeStamp, interceptMask);
             }
+            offset += numComponents;
         }
     }
 
@@ -869,6 +1218,7 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
 
     unsigned numAttributes = attributes->Size();
     bool changed = false;
+    bool hasQuantized = false;
 
     unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
     unsigned char timeStamp = source.ReadUByte();
@@ -878,22 +1228,33 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
         const AttributeInfo& attr = attributes->At(i);
         if (attr.mode_ & AM_LATESTDATA)
         {
-            if (!(interceptMask & (1ULL << i)))
-            {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
-                changed = true;
-            }
+            if (GetQuantizedComponents(attr))
+                hasQuantized = true;
             else
+                changed |= SetNetworkAttribute(attr, i, source.ReadVariant(attr.type_), timeStamp, interceptMask);
+        }
+    }
+
+    if (hasQuantized)
+    {
+        PODVector<unsigned char> data;
+        if (!ReadBitBlock(source, data))
+            return changed;
+
+        BitReader reader(data.Size() ? &data[0] : 0, data.Size());
+
+        for (auto i = 0u; i < numAttributes; ++i)
+        {
+            const AttributeInfo& attr = attributes->At(i);
+            unsigned numComponents = GetQuantizedComponents(attr);
+            if (numComponents && (attr.mode_ & AM_LATESTDATA))
             {
-                using namespace InterceptNetworkUpdate;
-
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_SERIALIZABLE] = this;
-                eventData[P_TIMESTAMP] = (unsigned)timeStamp;
-                eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
-                eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
-                SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
+                int values[4];
+                unsigned bits = GetQuantizedBits(attr);
+                for (auto j = 0u; j < numComponents; ++j)
+                    values[j] = (int)reader.ReadBits(bits);
+
+                changed |= SetNetworkAttribute(attr, i, DequantizeValue(attr, values), timeStamp, interceptMask);
             }
         }
     }
@@ -901,6 +1262,29 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
     return changed;
 }
 
+bool Serializable::SetNetworkAttribute(const AttributeInfo& attr, unsigned index, const Variant& value,
+    unsigned char timeStamp, unsigned long long interceptMask)
+{
+    if (!(interceptMask & (1ULL << index)))
+    {
+        OnSetAttribute(attr, value);
+        return true;
+    }
+    else
+    {
+        using namespace InterceptNetworkUpdate;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_SERIALIZABLE] = this;
+        eventData[P_TIMESTAMP] = (unsigned)timeStamp;
+        eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, index);
+        eventData[P_NAME] = attr.name_;
+        eventData[P_VALUE] = value;
+        SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
+        return false;
+    }
+}
+
 Variant Serializable::GetAttribute(unsigned index) const
 {
     Variant ret;
@@ -95,12 +95,18 @@ public:
     void SetInterceptNetworkUpdate(const String &attributeName, bool enable);
     /// Allocate network attribute state.
     void AllocateNetworkState();
-    /// Write initial delta network update.
-    void WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp);
-    /// Write a delta network update according to dirty attribute bits.
-    void WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp);
+    /// Remove a replication state that is no longer tracking this object, while the object itself stays alive.
+    void RemoveReplicationState(ReplicationState* state);
+    /// Write initial delta network update. Set the connection's quantized baseline to the values the client will have.
+    void WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp, PODVector<int>& baseline);
+    /// Write a delta network update according to dirty attribute bits. Quantized attributes are written relative to the connection's baseline, which is then updated.
+    void WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp, PODVector<int>& baseline);
     /// Write a latest data network update.
     void WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp);
+    /// Serialize the delta update and latest data payloads shared by all connections after attributes have changed. Called from PrepareNetworkUpdate().
+    void UpdateNetworkSnapshot(const DirtyBits& changedAttributes);
+    /// Reset the quantized values received from the network to the defaults. Called by Connection before reading an initial delta update.
+    void ResetNetworkBaseline();
     /// Read and apply a network delta update. Return true if attributes were changed.
     bool ReadDeltaUpdate(Deserializer& source);
     /// Read and apply a network latest data update. Return true if attributes were changed.
@@ -137,6 +143,9 @@ private:
     void SetInstanceDefault(const String &name, const Variant &defaultValue);
     /// Get instance-level default value.
     Variant GetInstanceDefault(const String &name) const;
+    /// Apply an attribute value received from the network, or send it as an event if intercepted. Return true if applied.
+    bool SetNetworkAttribute(const AttributeInfo& attr, unsigned index, const Variant& value, unsigned char timeStamp,
+        unsigned long long interceptMask);
 
     /// Attribute default value at each instance level.
     UniquePtr<VariantMap> instanceDefaultValues_;
@@ -347,6 +356,8 @@ public:
 #define FLOCKSDK_COPY_BASE_ATTRIBUTES(sourceClassName) context->CopyBaseAttributes<sourceClassName, ClassName>()
 /// Remove attribute by name.
 #define FLOCKSDK_REMOVE_ATTRIBUTE(name) context->RemoveAttribute<ClassName>(name)
+/// Quantize an attribute to the given range and precision in network replication.
+#define FLOCKSDK_QUANTIZE_ATTRIBUTE(name, minValue, maxValue, precision) context->SetAttributeQuantization<ClassName>(name, minValue, maxValue, precision)
 /// Define an attribute that points to a memory offset in the object.
 #define FLOCKSDK_ATTRIBUTE(name, typeName, variable, defaultValue, mode) context->RegisterAttribute<ClassName>(FlockSDK::AttributeInfo(FlockSDK::GetVariantType<typeName >(), name, offsetof(ClassName, variable), defaultValue, mode))
 /// Define an attribute that points to a memory offset in the object, and uses zero-based enum values, which are mapped to names through an array of C string pointers.
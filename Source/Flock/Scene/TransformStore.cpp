@@ -0,0 +1,220 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/WorkQueue.h"
+#include "../Scene/Scene.h"
+#include "../Scene/TransformStore.h"
+
+#include <cstring>
+
+namespace FlockSDK
+{
+
+/// Minimum number of nodes to update per parallel range.
+static const unsigned UPDATE_TRANSFORMS_GRAIN_SIZE = 256;
+
+void UpdateTransformsWork(unsigned start, unsigned end, unsigned threadIndex, void* data)
+{
+    TransformStore* store = reinterpret_cast<TransformStore*>(data);
+
+    for (unsigned i = store->levelStart_ + start; i < store->levelStart_ + end; ++i)
+    {
+        if (!store->IsDirtyBit(i))
+            continue;
+
+        Node* node = store->nodes_[i];
+        unsigned parent = store->parents_[i];
+
+        store->localTransforms_[i] = Matrix3x4(node->position_, node->rotation_, node->scale_);
+        store->localRotations_[i] = node->rotation_;
+
+        // Parents are on the previous level, so they have already been updated. Assume the scene root has identity transform
+        if (parent == M_MAX_UNSIGNED)
+        {
+            store->worldTransforms_[i] = store->localTransforms_[i];
+            store->worldRotations_[i] = store->localRotations_[i];
+        }
+        else
+        {
+            store->worldTransforms_[i] = store->worldTransforms_[parent] * store->localTransforms_[i];
+            store->worldRotations_[i] = store->worldRotations_[parent] * store->localRotations_[i];
+        }
+
+        node->worldTransform_ = store->worldTransforms_[i];
+        node->worldRotation_ = store->worldRotations_[i];
+        node->dirty_ = false;
+    }
+}
+
+TransformStore::TransformStore(Scene* scene) :
+    scene_(scene),
+    levelStart_(0),
+    dirty_(false),
+    structureDirty_(true)
+{
+}
+
+TransformStore::~TransformStore()
+{
+    if (!structureDirty_)
+    {
+        for (PODVector<Node*>::ConstIterator i = nodes_.Begin(); i != nodes_.End(); ++i)
+            (*i)->transformIndex_ = M_MAX_UNSIGNED;
+    }
+}
+
+void TransformStore::Update()
+{
+    if (structureDirty_)
+        Rebuild();
+    else if (!delayedDirtyNodes_.Empty())
+    {
+        for (PODVector<Node*>::ConstIterator i = delayedDirtyNodes_.Begin(); i != delayedDirtyNodes_.End(); ++i)
+        {
+            unsigned index = (*i)->transformIndex_;
+            if (index < nodes_.Size())
+                SetDirtyBit(index);
+        }
+        delayedDirtyNodes_.Clear();
+        dirty_ = true;
+    }
+
+    if (!dirty_)
+        return;
+
+    WorkQueue* queue = scene_->GetSubsystem<WorkQueue>();
+
+    // Each level depends only on the previous one, so the nodes within a level can be processed in parallel
+    for (unsigned level = 0; level + 1 < levelOffsets_.Size(); ++level)
+    {
+        levelStart_ = levelOffsets_[level];
+        queue->ParallelFor(levelOffsets_[level + 1] - levelStart_, UpdateTransformsWork, this, UPDATE_TRANSFORMS_GRAIN_SIZE);
+    }
+
+    memset(&dirtyBits_[0], 0, dirtyBits_.Size() * sizeof(unsigned));
+    dirty_ = false;
+}
+
+void TransformStore::MarkDirty(Node* node)
+{
+    if (structureDirty_)
+        return;
+
+    // Worker threads may share a bitset word, so defer to the next update instead
+    if (scene_->IsThreadedUpdate())
+    {
+        MutexLock lock(delayedDirtyMutex_);
+        delayedDirtyNodes_.Push(node);
+        return;
+    }
+
+    unsigned index = node->transformIndex_;
+    if (index < nodes_.Size())
+    {
+        SetDirtyBit(index);
+        dirty_ = true;
+    }
+}
+
+void TransformStore::MarkStructureDirty()
+{
+    structureDirty_ = true;
+}
+
+void TransformStore::SetWorldTransform(unsigned index, const Matrix3x4& transform, const Quaternion& rotation)
+{
+    if (structureDirty_ || index >= nodes_.Size())
+        return;
+
+    worldTransforms_[index] = transform;
+    worldRotations_[index] = rotation;
+}
+
+void TransformStore::Rebuild()
+{
+    nodes_.Clear();
+    parents_.Clear();
+    levelOffsets_.Clear();
+    delayedDirtyNodes_.Clear();
+
+    // Breadth-first walk, so that each level is contiguous and follows its parent level
+    const Vector<SharedPtr<Node> >& rootChildren = scene_->GetChildren();
+    for (Vector<SharedPtr<Node> >::ConstIterator i = rootChildren.Begin(); i != rootChildren.End(); ++i)
+    {
+        nodes_.Push(*i);
+        parents_.Push(M_MAX_UNSIGNED);
+    }
+
+    unsigned levelStart = 0;
+    while (levelStart < nodes_.Size())
+    {
+        unsigned levelEnd = nodes_.Size();
+        levelOffsets_.Push(levelStart);
+
+        for (unsigned i = levelStart; i < levelEnd; ++i)
+        {
+            const Vector<SharedPtr<Node> >& children = nodes_[i]->GetChildren();
+            for (Vector<SharedPtr<Node> >::ConstIterator j = children.Begin(); j != children.End(); ++j)
+            {
+                nodes_.Push(*j);
+                parents_.Push(i);
+            }
+        }
+
+        levelStart = levelEnd;
+    }
+    levelOffsets_.Push(nodes_.Size());
+
+    unsigned numNodes = nodes_.Size();
+    localTransforms_.Resize(numNodes);
+    worldTransforms_.Resize(numNodes);
+    localRotations_.Resize(numNodes);
+    worldRotations_.Resize(numNodes);
+    dirtyBits_.Resize((numNodes + 31) >> 5);
+    if (dirtyBits_.Size())
+        memset(&dirtyBits_[0], 0, dirtyBits_.Size() * sizeof(unsigned));
+
+    // Take over the current state of the nodes. Clean nodes provide valid world transforms for their children
+    dirty_ = false;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* node = nodes_[i];
+        node->transformIndex_ = i;
+
+        if (node->dirty_)
+        {
+            SetDirtyBit(i);
+            dirty_ = true;
+        }
+        else
+        {
+            worldTransforms_[i] = node->worldTransform_;
+            worldRotations_[i] = node->worldRotation_;
+        }
+    }
+
+    structureDirty_ = false;
+}
+
+}
@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Core/Mutex.h"
+#include "../Math/Matrix3x4.h"
+
+namespace FlockSDK
+{
+
+class Node;
+class Scene;
+
+/// Scene-owned contiguous transform storage. Keeps the scene nodes ordered by hierarchy depth in SoA arrays, so that dirty world transforms can be recalculated in one linear, multithreaded pass per frame instead of on demand through the parent chain.
+class FLOCKSDK_API TransformStore
+{
+    friend void UpdateTransformsWork(unsigned start, unsigned end, unsigned threadIndex, void* data);
+
+public:
+    /// Construct.
+    TransformStore(Scene* scene);
+    /// Destruct. Detach all nodes.
+    ~TransformStore();
+
+    /// Recalculate the world transforms of all dirty nodes level by level, and write them back to the nodes. Rebuild the storage first if the hierarchy has changed. Called by the scene once per frame.
+    void Update();
+    /// Flag a node's world transform as dirty. Called by Node::MarkDirty(). Is thread-safe during a threaded scene update.
+    void MarkDirty(Node* node);
+    /// Flag the hierarchy as changed. The storage will be rebuilt on the next update.
+    void MarkStructureDirty();
+    /// Store the lazily recalculated world transform of a node. Called by Node::UpdateWorldTransform().
+    void SetWorldTransform(unsigned index, const Matrix3x4& transform, const Quaternion& rotation);
+
+    /// Return number of stored nodes.
+    unsigned GetNumNodes() const { return nodes_.Size(); }
+    /// Return number of hierarchy levels.
+    unsigned GetNumLevels() const { return levelOffsets_.Size() ? levelOffsets_.Size() - 1 : 0; }
+    /// Return whether the storage needs rebuilding.
+    bool IsStructureDirty() const { return structureDirty_; }
+
+private:
+    /// Rebuild the depth-ordered storage from the scene hierarchy.
+    void Rebuild();
+    /// Set the dirty bit of a storage index.
+    void SetDirtyBit(unsigned index) { dirtyBits_[index >> 5] |= 1u << (index & 31); }
+    /// Return whether the dirty bit of a storage index is set.
+    bool IsDirtyBit(unsigned index) const { return (dirtyBits_[index >> 5] & (1u << (index & 31))) != 0; }
+
+    /// Scene.
+    Scene* scene_;
+    /// Nodes in depth order.
+    PODVector<Node*> nodes_;
+    /// Parent storage indices. M_MAX_UNSIGNED for the children of the scene root.
+    PODVector<unsigned> parents_;
+    /// Local transforms.
+    PODVector<Matrix3x4> localTransforms_;
+    /// World transforms.
+    PODVector<Matrix3x4> worldTransforms_;
+    /// Local rotations.
+    PODVector<Quaternion> localRotations_;
+    /// World rotations.
+    PODVector<Quaternion> worldRotations_;
+    /// Dirty bitset, one bit per storage index.
+    PODVector<unsigned> dirtyBits_;
+    /// Start offsets of each hierarchy level, plus the end offset of the last level.
+    PODVector<unsigned> levelOffsets_;
+    /// Nodes marked dirty during a threaded update.
+    PODVector<Node*> delayedDirtyNodes_;
+    /// Mutex for the delayed dirty nodes.
+    Mutex delayedDirtyMutex_;
+    /// Start offset of the level being updated.
+    unsigned levelStart_;
+    /// Any dirty bits set flag.
+    bool dirty_;
+    /// Hierarchy changed flag.
+    bool structureDirty_;
+};
+
+}
@@ -0,0 +1,99 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Flock/IO/BitStream.h>
+#include <Flock/Math/MathDefs.h>
+
+#include "FlockTests.h"
+
+#include <random>
+
+using namespace FlockSDK;
+
+/// Values at the varint bit length boundaries and the ends of the integer range.
+static const int EDGE_VALUES[] = { 0, 1, -1, 2, -2, 63, -64, 64, -65, 32767, -32768, 65536, M_MAX_INT, M_MIN_INT,
+    M_MAX_INT - 1, M_MIN_INT + 1 };
+
+static void TestVarIntRoundTrip()
+{
+    std::mt19937 generator(5678);
+    PODVector<int> values;
+    PODVector<unsigned> rawBits;
+    BitWriter writer;
+
+    for (auto i = 0u; i < sizeof EDGE_VALUES / sizeof EDGE_VALUES[0]; ++i)
+        values.Push(EDGE_VALUES[i]);
+    for (auto i = 0u; i < 1000; ++i)
+    {
+        // Spread the random values over all bit lengths
+        int shift = std::uniform_int_distribution<int>(1, 31)(generator);
+        values.Push((int)(generator() >> shift));
+        if (generator() & 1)
+            values.Back() = -values.Back();
+    }
+
+    // Interleave the varints with raw bit fields so that they start at every bit alignment
+    for (auto i = 0u; i < values.Size(); ++i)
+    {
+        unsigned numBits = i % 33;
+        unsigned raw = numBits ? generator() & (0xffffffffu >> (32 - numBits)) : 0;
+        rawBits.Push(raw);
+        writer.WriteVarInt(values[i]);
+        writer.WriteBits(raw, numBits);
+    }
+
+    TEST_CHECK(writer.GetSize() == (writer.GetNumBits() + 7) / 8);
+
+    BitReader reader(writer.GetData(), writer.GetSize());
+    for (auto i = 0u; i < values.Size(); ++i)
+    {
+        TEST_CHECK(reader.ReadVarInt() == values[i]);
+        TEST_CHECK(reader.ReadBits(i % 33) == rawBits[i]);
+    }
+
+    // Only the padding of the last byte may remain, and it reads as zero
+    TEST_CHECK(reader.ReadBits(writer.GetSize() * 8 - writer.GetNumBits()) == 0);
+    TEST_CHECK(reader.IsEof());
+    TEST_CHECK(reader.ReadBits(32) == 0);
+}
+
+static void TestVarIntSize()
+{
+    BitWriter writer;
+    writer.WriteVarInt(0);
+    TEST_CHECK(writer.GetNumBits() == 1);
+
+    // Zigzag encoding keeps small values of both signs short: a flag bit, 5 length bits and the bits below the highest one
+    writer.Clear();
+    writer.WriteVarInt(-1);
+    TEST_CHECK(writer.GetNumBits() == 6);
+
+    writer.Clear();
+    writer.WriteVarInt(M_MIN_INT);
+    TEST_CHECK(writer.GetNumBits() == 37);
+}
+
+void RunBitStreamTests()
+{
+    TestVarIntRoundTrip();
+    TestVarIntSize();
+}
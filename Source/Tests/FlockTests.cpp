@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Usage: FlockTests
+// Runs the engine tests and returns a nonzero exit code if any check fails. Registered with CTest when FLOCK_TESTING is enabled.
+
+#include <Flock/Core/Platform.h>
+#include <Flock/Core/StringUtils.h>
+#include <Flock/Math/MathDefs.h>
+
+#include "FlockTests.h"
+
+using namespace FlockSDK;
+
+static unsigned numFailures_ = 0;
+
+int main(int argc, char** argv)
+{
+    RunMathTests();
+    RunBitStreamTests();
+
+    if (numFailures_)
+    {
+        PrintLine(String(numFailures_) + " check(s) failed", true);
+        return EXIT_FAILURE;
+    }
+
+    PrintLine("All tests passed");
+    return EXIT_SUCCESS;
+}
+
+void ReportFailure(const char* file, int line, const String& message)
+{
+    PrintLine(ToString("%s(%d): check failed: %s", file, line, message.CString()), true);
+    ++numFailures_;
+}
+
+bool CompareFloats(float lhs, float rhs, float tolerance)
+{
+    return Abs(lhs - rhs) <= tolerance * Max(Max(Abs(lhs), Abs(rhs)), 1.0f);
+}
+
+bool CompareFloats(const float* lhs, const float* rhs, unsigned count, float tolerance)
+{
+    for (auto i = 0u; i < count; ++i)
+    {
+        if (!CompareFloats(lhs[i], rhs[i], tolerance))
+            return false;
+    }
+
+    return true;
+}
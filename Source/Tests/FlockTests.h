@@ -0,0 +1,43 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Flock/Container/Str.h>
+
+/// Record a failed check and print it to the error output.
+void ReportFailure(const char* file, int line, const FlockSDK::String& message);
+/// Return whether two floats are equal within a tolerance relative to their magnitude, but at least within an absolute tolerance.
+bool CompareFloats(float lhs, float rhs, float tolerance);
+/// Return whether two float arrays are equal within a tolerance.
+bool CompareFloats(const float* lhs, const float* rhs, unsigned count, float tolerance);
+
+/// Run the SIMD math tests against scalar reference results.
+void RunMathTests();
+/// Run the bit stream round-trip tests.
+void RunBitStreamTests();
+
+/// Check that a condition holds.
+#define TEST_CHECK(condition) do { if (!(condition)) ReportFailure(__FILE__, __LINE__, #condition); } while (false)
+/// Check that two floats or float arrays of the given size are equal within a tolerance.
+#define TEST_CHECK_CLOSE(lhs, rhs, ...) do { if (!CompareFloats(lhs, rhs, __VA_ARGS__)) ReportFailure(__FILE__, __LINE__, \
+    #lhs " is not close to " #rhs); } while (false)
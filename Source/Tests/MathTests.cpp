@@ -0,0 +1,322 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Flock/Math/BoundingBox.h>
+#include <Flock/Math/Frustum.h>
+#include <Flock/Math/Matrix3x4.h>
+#include <Flock/Math/Matrix4.h>
+#include <Flock/Math/Quaternion.h>
+
+#include "FlockTests.h"
+
+#include <random>
+
+using namespace FlockSDK;
+
+/// Number of random inputs tested by each case.
+static const unsigned NUM_ITERATIONS = 1000;
+/// Tolerance for results that may be summed in a different order than the scalar reference.
+static const float SUM_TOLERANCE = 1e-5f;
+/// Tolerance for results going through square roots, divisions or trigonometry.
+static const float ROUNDING_TOLERANCE = 1e-4f;
+
+/// Random generator with a fixed seed so that failures are reproducible.
+static std::mt19937 generator_(1234);
+
+/// Return a random float between min and max.
+static float RandomFloat(float min, float max)
+{
+    return std::uniform_real_distribution<float>(min, max)(generator_);
+}
+
+/// Fill an array with random floats between -2 and 2.
+static void RandomFloats(float* dest, unsigned count)
+{
+    for (auto i = 0u; i < count; ++i)
+        dest[i] = RandomFloat(-2.0f, 2.0f);
+}
+
+static Vector3 RandomVector3()
+{
+    return Vector3(RandomFloat(-2.0f, 2.0f), RandomFloat(-2.0f, 2.0f), RandomFloat(-2.0f, 2.0f));
+}
+
+/// Return a random unit quaternion, normalized without the SIMD code path.
+static Quaternion RandomRotation()
+{
+    float data[4];
+    RandomFloats(data, 4);
+    float invLength = 1.0f / sqrtf(data[0] * data[0] + data[1] * data[1] + data[2] * data[2] + data[3] * data[3]);
+    return Quaternion(data[0] * invLength, data[1] * invLength, data[2] * invLength, data[3] * invLength);
+}
+
+/// Multiply row-major matrices of the given number of rows with 4 columns. A 3x4 matrix has an implicit last row of 0 0 0 1.
+static void ReferenceMultiply(const float* lhs, const float* rhs, float* dest, unsigned rows)
+{
+    for (auto r = 0u; r < rows; ++r)
+    {
+        for (auto c = 0u; c < 4; ++c)
+        {
+            float sum = rows == 3 && c == 3 ? lhs[r * 4 + 3] : 0.0f;
+            for (auto k = 0u; k < rows; ++k)
+                sum += lhs[r * 4 + k] * rhs[k * 4 + c];
+            dest[r * 4 + c] = sum;
+        }
+    }
+}
+
+/// Transform a 4-component vector by a row-major matrix of the given number of rows.
+static void ReferenceTransform(const float* matrix, const float* vec, float* dest, unsigned rows)
+{
+    for (auto r = 0u; r < rows; ++r)
+        dest[r] = matrix[r * 4] * vec[0] + matrix[r * 4 + 1] * vec[1] + matrix[r * 4 + 2] * vec[2] + matrix[r * 4 + 3] * vec[3];
+}
+
+/// Test a box against the frustum planes one at a time, the same way as the scalar code path.
+static Intersection ReferenceIsInside(const Frustum& frustum, const BoundingBox& box)
+{
+    Vector3 center = box.Center();
+    Vector3 edge = center - box.min_;
+    bool allInside = true;
+
+    for (auto i = 0u; i < NUM_FRUSTUM_PLANES; ++i)
+    {
+        const Plane& plane = frustum.planes_[i];
+        float dist = plane.normal_.DotProduct(center) + plane.d_;
+        float absDist = plane.absNormal_.DotProduct(edge);
+
+        if (dist < -absDist)
+            return OUTSIDE;
+        else if (dist < absDist)
+            allInside = false;
+    }
+
+    return allInside ? INSIDE : INTERSECTS;
+}
+
+static void TestMatrix3x4()
+{
+    for (auto i = 0u; i < NUM_ITERATIONS; ++i)
+    {
+        float lhsData[12], rhsData[12], vecData[4], expected[12];
+        RandomFloats(lhsData, 12);
+        RandomFloats(rhsData, 12);
+        RandomFloats(vecData, 3);
+        vecData[3] = 1.0f;
+        Matrix3x4 lhs(lhsData);
+        Matrix3x4 rhs(rhsData);
+
+        ReferenceMultiply(lhsData, rhsData, expected, 3);
+        TEST_CHECK_CLOSE((lhs * rhs).Data(), expected, 12, SUM_TOLERANCE);
+
+        ReferenceTransform(lhsData, vecData, expected, 3);
+        TEST_CHECK_CLOSE((lhs * Vector3(vecData)).Data(), expected, 3, SUM_TOLERANCE);
+
+        TEST_CHECK(Matrix3x4(lhs) == lhs);
+        TEST_CHECK(Matrix3x4(lhs.ToMatrix4()) == lhs);
+
+        Vector3 translation = RandomVector3();
+        Quaternion rotation = RandomRotation();
+        Vector3 scale = RandomVector3();
+        Matrix3 rotationMatrix = rotation.RotationMatrix();
+        for (auto r = 0u; r < 3; ++r)
+        {
+            for (auto c = 0u; c < 3; ++c)
+                expected[r * 4 + c] = rotationMatrix.Data()[r * 3 + c] * scale.Data()[c];
+            expected[r * 4 + 3] = translation.Data()[r];
+        }
+        TEST_CHECK_CLOSE(Matrix3x4(translation, rotation, scale).Data(), expected, 12, ROUNDING_TOLERANCE);
+    }
+}
+
+static void TestMatrix4()
+{
+    for (auto i = 0u; i < NUM_ITERATIONS; ++i)
+    {
+        float lhsData[16], rhsData[16], vecData[4], expected[16];
+        RandomFloats(lhsData, 16);
+        RandomFloats(rhsData, 16);
+        RandomFloats(vecData, 4);
+        Matrix4 lhs(lhsData);
+        Matrix4 rhs(rhsData);
+
+        ReferenceMultiply(lhsData, rhsData, expected, 4);
+        TEST_CHECK_CLOSE((lhs * rhs).Data(), expected, 16, SUM_TOLERANCE);
+
+        ReferenceTransform(lhsData, vecData, expected, 4);
+        TEST_CHECK_CLOSE((lhs * Vector4(vecData)).Data(), expected, 4, SUM_TOLERANCE);
+
+        Matrix4 transposed = lhs.Transpose();
+        for (auto r = 0u; r < 4; ++r)
+        {
+            for (auto c = 0u; c < 4; ++c)
+                TEST_CHECK(transposed.Data()[r * 4 + c] == lhsData[c * 4 + r]);
+        }
+
+        // Keep the projected W away from zero so that the division does not amplify the summation differences
+        lhsData[12] = lhsData[13] = lhsData[14] = 0.0f;
+        lhsData[15] = RandomFloat(1.0f, 2.0f);
+        vecData[3] = 1.0f;
+        ReferenceTransform(lhsData, vecData, expected, 4);
+        for (auto j = 0u; j < 3; ++j)
+            expected[j] /= expected[3];
+        TEST_CHECK_CLOSE((Matrix4(lhsData) * Vector3(vecData)).Data(), expected, 3, ROUNDING_TOLERANCE);
+    }
+}
+
+static void TestQuaternion()
+{
+    for (auto i = 0u; i < NUM_ITERATIONS; ++i)
+    {
+        Quaternion lhs = RandomRotation();
+        Quaternion rhs = RandomRotation();
+        const float* a = lhs.Data();
+        const float* b = rhs.Data();
+
+        float product[4] = {
+            a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3],
+            a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+            a[0] * b[2] + a[2] * b[0] + a[3] * b[1] - a[1] * b[3],
+            a[0] * b[3] + a[3] * b[0] + a[1] * b[2] - a[2] * b[1]
+        };
+        TEST_CHECK_CLOSE((lhs * rhs).Data(), product, 4, SUM_TOLERANCE);
+
+        float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        TEST_CHECK_CLOSE(lhs.DotProduct(rhs), dot, SUM_TOLERANCE);
+
+        Vector3 vec = RandomVector3();
+        TEST_CHECK_CLOSE((lhs * vec).Data(), (lhs.RotationMatrix() * vec).Data(), 3, ROUNDING_TOLERANCE);
+
+        float conjugate[4] = { a[0], -a[1], -a[2], -a[3] };
+        TEST_CHECK_CLOSE(lhs.Inverse().Data(), conjugate, 4, ROUNDING_TOLERANCE);
+
+        float scaledData[4];
+        float scale = RandomFloat(0.5f, 2.0f);
+        for (auto j = 0u; j < 4; ++j)
+            scaledData[j] = a[j] * scale;
+        Quaternion scaled(scaledData);
+        scaled.Normalize();
+        TEST_CHECK_CLOSE(scaled.Data(), a, 4, ROUNDING_TOLERANCE);
+
+        float t = RandomFloat(0.0f, 1.0f);
+        float sign = dot < 0.0f ? -1.0f : 1.0f;
+        float angle = acosf(Min(dot * sign, 1.0f));
+        float t1 = 1.0f - t;
+        float t2 = t;
+        if (sinf(angle) > 0.001f)
+        {
+            t1 = sinf((1.0f - t) * angle) / sinf(angle);
+            t2 = sinf(t * angle) / sinf(angle);
+        }
+        float slerp[4], nlerp[4];
+        for (auto j = 0u; j < 4; ++j)
+        {
+            slerp[j] = a[j] * t1 + b[j] * sign * t2;
+            nlerp[j] = a[j] + (b[j] * sign - a[j]) * t;
+        }
+        float invLength = 1.0f / sqrtf(nlerp[0] * nlerp[0] + nlerp[1] * nlerp[1] + nlerp[2] * nlerp[2] + nlerp[3] * nlerp[3]);
+        for (auto j = 0u; j < 4; ++j)
+            nlerp[j] *= invLength;
+        TEST_CHECK_CLOSE(lhs.Slerp(rhs, t).Data(), slerp, 4, ROUNDING_TOLERANCE);
+        TEST_CHECK_CLOSE(lhs.Nlerp(rhs, t, true).Data(), nlerp, 4, ROUNDING_TOLERANCE);
+    }
+}
+
+static void TestBoundingBox()
+{
+    for (auto i = 0u; i < NUM_ITERATIONS; ++i)
+    {
+        Vector3 min = RandomVector3();
+        Vector3 max = min + Vector3(RandomFloat(0.0f, 2.0f), RandomFloat(0.0f, 2.0f), RandomFloat(0.0f, 2.0f));
+        Vector3 point = RandomVector3();
+        BoundingBox box(min, max);
+
+        BoundingBox merged(box);
+        merged.Merge(point);
+        TEST_CHECK(merged.min_ == VectorMin(min, point) && merged.max_ == VectorMax(max, point));
+
+        float transformData[12];
+        RandomFloats(transformData, 12);
+        Matrix3x4 transform(transformData);
+        Vector3 expectedMin(M_INFINITY, M_INFINITY, M_INFINITY);
+        Vector3 expectedMax(-M_INFINITY, -M_INFINITY, -M_INFINITY);
+        for (auto j = 0u; j < 8; ++j)
+        {
+            float corner[4] = { j & 1 ? max.x_ : min.x_, j & 2 ? max.y_ : min.y_, j & 4 ? max.z_ : min.z_, 1.0f };
+            float transformed[3];
+            ReferenceTransform(transformData, corner, transformed, 3);
+            expectedMin = VectorMin(expectedMin, Vector3(transformed));
+            expectedMax = VectorMax(expectedMax, Vector3(transformed));
+        }
+        BoundingBox transformedBox = box.Transformed(transform);
+        TEST_CHECK_CLOSE(transformedBox.min_.Data(), expectedMin.Data(), 3, ROUNDING_TOLERANCE);
+        TEST_CHECK_CLOSE(transformedBox.max_.Data(), expectedMax.Data(), 3, ROUNDING_TOLERANCE);
+    }
+}
+
+static void TestFrustum()
+{
+    static const unsigned NUM_BOXES = 32;
+
+    for (auto i = 0u; i < NUM_ITERATIONS / 10; ++i)
+    {
+        Frustum frustum;
+        frustum.Define(RandomFloat(30.0f, 120.0f), RandomFloat(0.5f, 2.0f), 1.0f, 0.1f, RandomFloat(5.0f, 50.0f),
+            Matrix3x4(RandomVector3(), RandomRotation(), 1.0f));
+
+        float boxData[6][NUM_BOXES];
+        unsigned expectedMask = 0;
+        for (auto j = 0u; j < NUM_BOXES; ++j)
+        {
+            Vector3 center = RandomVector3() * 10.0f;
+            Vector3 halfSize(RandomFloat(0.0f, 3.0f), RandomFloat(0.0f, 3.0f), RandomFloat(0.0f, 3.0f));
+            BoundingBox box(center - halfSize, center + halfSize);
+            Intersection expected = ReferenceIsInside(frustum, box);
+
+            TEST_CHECK(frustum.IsInside(box) == expected);
+            TEST_CHECK(frustum.IsInsideFast(box) == (expected == OUTSIDE ? OUTSIDE : INSIDE));
+
+            // Take the center and half size back from the box so that they are rounded the same way as in the tests above
+            Vector3 boxCenter = box.Center();
+            Vector3 boxHalfSize = boxCenter - box.min_;
+            for (auto k = 0u; k < 3; ++k)
+            {
+                boxData[k][j] = boxCenter.Data()[k];
+                boxData[k + 3][j] = boxHalfSize.Data()[k];
+            }
+            if (expected != OUTSIDE)
+                expectedMask |= 1u << j;
+        }
+
+        TEST_CHECK(frustum.GetInsideMask(boxData[0], NUM_BOXES, NUM_BOXES) == expectedMask);
+        TEST_CHECK(frustum.GetInsideMask(boxData[0], NUM_BOXES, 5) == (expectedMask & 0x1fu));
+    }
+}
+
+void RunMathTests()
+{
+    TestMatrix3x4();
+    TestMatrix4();
+    TestQuaternion();
+    TestBoundingBox();
+    TestFrustum();
+}
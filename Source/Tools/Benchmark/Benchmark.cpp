@@ -0,0 +1,369 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Usage: Benchmark [-octree] [-sort] [-drawables N] [-frames N] [-queries N]
+// Runs all benchmarks unless some are selected.
+
+#include <Flock/Core/Context.h>
+#include <Flock/Core/Platform.h>
+#include <Flock/Core/StringUtils.h>
+#include <Flock/Core/Timer.h>
+#include <Flock/Engine/Engine.h>
+#include <Flock/Graphics/Batch.h>
+#include <Flock/Graphics/Drawable.h>
+#include <Flock/Graphics/Octree.h>
+#include <Flock/Graphics/OctreeQuery.h>
+#include <Flock/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <random>
+
+namespace SDK = FlockSDK;
+
+/// Octree looseness factors to compare.
+static const float OCTREE_LOOSENESS[] = { 1.25f, 1.5f, 2.0f, 3.0f, 4.0f };
+/// Half extent of the octree benchmark area.
+static const float OCTREE_AREA_SIZE = 500.0f;
+/// Simulated frame time step.
+static const float FRAME_TIME_STEP = 1.0f / 60.0f;
+/// Batch queue sizes to compare the sorts at. Smaller queues are not radix sorted by BatchQueue.
+static const unsigned SORT_QUEUE_SIZES[] = { 2048, 4096, 8192, 32768 };
+/// Number of batches sorted for each queue size, so that small queues are sorted often enough to be measurable.
+static const unsigned SORT_BATCHES_PER_SIZE = 4 * 1024 * 1024;
+/// Batch queue sort modes.
+static const char* SORT_MODE_NAMES[] = { "front to back", "back to front", "state first" };
+
+/// Drawable with a fixed local bounding box and no geometry.
+class BenchmarkDrawable : public SDK::Drawable {
+    FLOCKSDK_OBJECT(BenchmarkDrawable, SDK::Drawable);
+
+    public:
+        BenchmarkDrawable(SDK::Context *context) :
+            SDK::Drawable(context, SDK::DRAWABLE_GEOMETRY)
+        {
+        }
+
+        /// Set the local bounding box.
+        void SetBoundingBox(const SDK::BoundingBox &box)
+        {
+            boundingBox_ = box;
+            OnMarkedDirty(node_);
+        }
+
+    protected:
+        virtual void OnWorldBoundingBoxUpdate()
+        {
+            worldBoundingBox_ = boundingBox_.Transformed(node_->GetWorldTransform());
+        }
+};
+
+/// Format a string with the C library. ToString() does not support field widths and precision.
+static SDK::String Format(const char* formatString, ...)
+{
+    char buffer[512];
+    va_list args;
+    va_start(args, formatString);
+    vsnprintf(buffer, sizeof buffer, formatString, args);
+    va_end(args);
+    return SDK::String(buffer);
+}
+
+/// Random generator with a fixed seed, so that each run and each benchmark case sees the same data.
+static std::mt19937 generator_;
+
+/// Return a random float between min and max.
+static float RandomFloat(float min, float max)
+{
+    return std::uniform_real_distribution<float>(min, max)(generator_);
+}
+
+/// Return a random integer between min and max, inclusive.
+static unsigned RandomUInt(unsigned min, unsigned max)
+{
+    return std::uniform_int_distribution<unsigned>(min, max)(generator_);
+}
+
+/// Sort batches with the same orderings as the comparison sort that BatchQueue uses for small queues.
+static void ComparisonSort(SDK::PODVector<SDK::Batch*> &batches, bool stateFirst, bool backToFront)
+{
+    if (stateFirst)
+    {
+        SDK::Sort(batches.Begin(), batches.End(), [] (SDK::Batch* lhs, SDK::Batch* rhs) -> bool {
+            if (lhs->renderOrder_ != rhs->renderOrder_)
+                return lhs->renderOrder_ < rhs->renderOrder_;
+            else if (lhs->sortKey_ != rhs->sortKey_)
+                return lhs->sortKey_ < rhs->sortKey_;
+            else
+                return lhs->distance_ < rhs->distance_;
+        });
+    }
+    else if (backToFront)
+    {
+        SDK::Sort(batches.Begin(), batches.End(), [] (SDK::Batch* lhs, SDK::Batch* rhs) -> bool {
+            if (lhs->renderOrder_ != rhs->renderOrder_)
+                return lhs->renderOrder_ < rhs->renderOrder_;
+            else if (lhs->distance_ != rhs->distance_)
+                return lhs->distance_ > rhs->distance_;
+            else
+                return lhs->sortKey_ < rhs->sortKey_;
+        });
+    }
+    else
+    {
+        SDK::Sort(batches.Begin(), batches.End(), [] (SDK::Batch* lhs, SDK::Batch* rhs) -> bool {
+            if (lhs->renderOrder_ != rhs->renderOrder_)
+                return lhs->renderOrder_ < rhs->renderOrder_;
+            else if (lhs->distance_ != rhs->distance_)
+                return lhs->distance_ < rhs->distance_;
+            else
+                return lhs->sortKey_ < rhs->sortKey_;
+        });
+    }
+}
+
+Benchmark::Benchmark(SDK::Context* context) :
+    SDK::Application(context),
+    runOctree_(false),
+    runSort_(false),
+    numDrawables_(20000),
+    numFrames_(120),
+    numQueries_(4)
+{
+    context_->RegisterFactory<BenchmarkDrawable>();
+}
+
+void Benchmark::Setup()
+{
+    ParseSettings();
+}
+
+void Benchmark::Start()
+{
+    if (runOctree_)
+        RunOctreeBenchmark();
+    if (runSort_)
+        RunSortBenchmark();
+
+    engine_->Exit();
+}
+
+void Benchmark::ParseSettings()
+{
+    const auto &arguments = SDK::GetArguments();
+    bool runAll = true;
+
+    for (auto i = 0u; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].Length() < 2 || arguments[i][0] != '-')
+            continue;
+
+        auto argument = arguments[i].Substring(1).ToLower();
+        auto value = i + 1 < arguments.Size() ? arguments[i + 1] : SDK::String::EMPTY;
+
+        if (argument == "octree")
+        {
+            runOctree_ = true;
+            runAll = false;
+        }
+        else if (argument == "sort")
+        {
+            runSort_ = true;
+            runAll = false;
+        }
+        else if (value.Empty())
+            continue;
+        else if (argument == "drawables")
+            numDrawables_ = (unsigned)SDK::Max(SDK::ToInt(value), 1);
+        else if (argument == "frames")
+            numFrames_ = (unsigned)SDK::Max(SDK::ToInt(value), 1);
+        else if (argument == "queries")
+            numQueries_ = (unsigned)SDK::Max(SDK::ToInt(value), 1);
+    }
+
+    if (runAll)
+        runOctree_ = runSort_ = true;
+}
+
+void Benchmark::RunOctreeBenchmark()
+{
+    SDK::PrintLine(Format("Octree: %u moving drawables, %u frames, %u frustum queries per frame", numDrawables_,
+        numFrames_, numQueries_));
+
+    for (auto i = 0u; i < sizeof OCTREE_LOOSENESS / sizeof OCTREE_LOOSENESS[0]; ++i)
+    {
+        generator_.seed(1);
+
+        SDK::SharedPtr<SDK::Scene> scene(new SDK::Scene(context_));
+        auto *octree = scene->CreateComponent<SDK::Octree>();
+        octree->SetSize(SDK::BoundingBox(-OCTREE_AREA_SIZE, OCTREE_AREA_SIZE), 8);
+        octree->SetLooseness(OCTREE_LOOSENESS[i]);
+
+        SDK::PODVector<SDK::Node*> nodes;
+        SDK::PODVector<SDK::Vector3> velocities;
+        for (auto j = 0u; j < numDrawables_; ++j)
+        {
+            SDK::Node* node = scene->CreateChild();
+            node->SetPosition(SDK::Vector3(RandomFloat(-OCTREE_AREA_SIZE, OCTREE_AREA_SIZE), RandomFloat(-OCTREE_AREA_SIZE,
+                OCTREE_AREA_SIZE), RandomFloat(-OCTREE_AREA_SIZE, OCTREE_AREA_SIZE)));
+            float halfSize = RandomFloat(0.25f, 2.0f);
+            node->CreateComponent<BenchmarkDrawable>()->SetBoundingBox(SDK::BoundingBox(-halfSize, halfSize));
+            nodes.Push(node);
+            velocities.Push(SDK::Vector3(RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f)));
+        }
+
+        SDK::FrameInfo frame;
+        frame.frameNumber_ = 0;
+        frame.timeStep_ = FRAME_TIME_STEP;
+        frame.viewSize_ = SDK::IntVector2(1920, 1080);
+        frame.camera_ = 0;
+        // Insert the drawables before timing the per-frame updates
+        octree->Update(frame);
+
+        SDK::HiresTimer timer;
+        long long updateTime = 0;
+        long long queryTime = 0;
+        unsigned long long numResults = 0;
+        SDK::PODVector<SDK::Drawable*> result;
+
+        for (auto j = 0u; j < numFrames_; ++j)
+        {
+            for (auto k = 0u; k < nodes.Size(); ++k)
+            {
+                SDK::Vector3 position = nodes[k]->GetPosition() + velocities[k] * FRAME_TIME_STEP;
+                SDK::Vector3 &velocity = velocities[k];
+
+                // Bounce off the area edges
+                if (SDK::Abs(position.x_) > OCTREE_AREA_SIZE)
+                    velocity.x_ = -velocity.x_;
+                if (SDK::Abs(position.y_) > OCTREE_AREA_SIZE)
+                    velocity.y_ = -velocity.y_;
+                if (SDK::Abs(position.z_) > OCTREE_AREA_SIZE)
+                    velocity.z_ = -velocity.z_;
+
+                nodes[k]->SetPosition(position);
+            }
+
+            ++frame.frameNumber_;
+            timer.Reset();
+            octree->Update(frame);
+            updateTime += timer.GetUSec(false);
+
+            for (auto k = 0u; k < numQueries_; ++k)
+            {
+                SDK::Frustum frustum;
+                frustum.Define(60.0f, 16.0f / 9.0f, 1.0f, 0.1f, 300.0f, SDK::Matrix3x4(SDK::Vector3(RandomFloat(-OCTREE_AREA_SIZE,
+                    OCTREE_AREA_SIZE), 0.0f, RandomFloat(-OCTREE_AREA_SIZE, OCTREE_AREA_SIZE)), SDK::Quaternion(RandomFloat(-30.0f,
+                    30.0f), RandomFloat(0.0f, 360.0f), 0.0f), 1.0f));
+
+                result.Clear();
+                SDK::FrustumOctreeQuery query(result, frustum, SDK::DRAWABLE_GEOMETRY);
+                timer.Reset();
+                octree->GetDrawables(query);
+                queryTime += timer.GetUSec(false);
+                numResults += result.Size();
+            }
+        }
+
+        SDK::PrintLine(Format("  looseness %.2f: update %.3f ms/frame, query %.3f ms, %.1f drawables/query",
+            OCTREE_LOOSENESS[i], updateTime / 1000.0 / numFrames_, queryTime / 1000.0 / (numFrames_ * numQueries_),
+            (double)numResults / (numFrames_ * numQueries_)));
+    }
+}
+
+void Benchmark::RunSortBenchmark()
+{
+    SDK::PrintLine("Batch queue sort: radix sort against comparison sort");
+
+    for (auto i = 0u; i < sizeof SORT_QUEUE_SIZES / sizeof SORT_QUEUE_SIZES[0]; ++i)
+    {
+        generator_.seed(1);
+
+        // A typical queue has a few render orders and shares shaders, materials and geometries between many batches
+        unsigned numBatches = SORT_QUEUE_SIZES[i];
+        SDK::PODVector<SDK::Batch> batches(numBatches);
+        SDK::PODVector<SDK::Batch*> unsorted(numBatches);
+        for (auto j = 0u; j < numBatches; ++j)
+        {
+            SDK::Batch &batch = batches[j];
+            batch.sortKey_ = ((unsigned long long)RandomUInt(0, 63) << 32) | (RandomUInt(0, 255) << 16) | RandomUInt(0, 1023);
+            batch.distance_ = RandomFloat(0.0f, 1000.0f);
+            batch.renderOrder_ = (unsigned char)(RandomUInt(0, 9) ? SDK::DEFAULT_RENDER_ORDER : RandomUInt(0, 255));
+            unsorted[j] = &batch;
+        }
+
+        unsigned numIterations = SDK::Max(SORT_BATCHES_PER_SIZE / numBatches, 1u);
+        SDK::BatchQueue queue;
+        SDK::PODVector<SDK::Batch*> radixSorted;
+        SDK::PODVector<SDK::Batch*> comparisonSorted;
+        SDK::HiresTimer timer;
+
+        for (auto mode = 0u; mode < 3; ++mode)
+        {
+            bool stateFirst = mode == 2;
+            bool backToFront = mode == 1;
+
+            timer.Reset();
+            for (auto j = 0u; j < numIterations; ++j)
+            {
+                radixSorted = unsorted;
+                queue.SortBatches(radixSorted, stateFirst, backToFront);
+            }
+            long long radixTime = timer.GetUSec(true);
+
+            for (auto j = 0u; j < numIterations; ++j)
+            {
+                comparisonSorted = unsorted;
+                ComparisonSort(comparisonSorted, stateFirst, backToFront);
+            }
+            long long comparisonTime = timer.GetUSec(false);
+
+            // Batches with equal keys may come in either order, so compare the keys only
+            bool match = true;
+            for (auto j = 0u; j < numBatches && match; ++j)
+            {
+                const SDK::Batch* lhs = radixSorted[j];
+                const SDK::Batch* rhs = comparisonSorted[j];
+                match = lhs->renderOrder_ == rhs->renderOrder_ && lhs->distance_ == rhs->distance_ &&
+                    lhs->sortKey_ == rhs->sortKey_;
+            }
+
+            SDK::PrintLine(Format("  %5u batches, %s: radix %.4f ms, comparison %.4f ms (%.2fx)%s", numBatches,
+                SORT_MODE_NAMES[mode], radixTime / 1000.0 / numIterations, comparisonTime / 1000.0 / numIterations,
+                radixTime ? (double)comparisonTime / radixTime : 0.0, match ? "" : ", ORDER MISMATCH"));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // Always run headless, and keep the engine log from interleaving with the results
+    SDK::PODVector<char*> arguments(argv, (unsigned)argc);
+    arguments.Push(const_cast<char*>("-headless"));
+    arguments.Push(const_cast<char*>("-q"));
+    SDK::ParseArguments((int)arguments.Size(), arguments.Buffer());
+
+    auto *context = new SDK::Context();
+    return (SDK::SharedPtr<Benchmark>(new Benchmark(context)))->Run();
+}
@@ -0,0 +1,443 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE. 
+// 
+
+// Usage: NetworkLoadTest [-clients N] [-nodes N] [-spawnrate N] [-port N] [-duration sec] [-controlrate hz] [-updatefps hz]
+//                        [-latency ms] [-loss probability] [-area size] [-report sec] [-interest]
+
+#include <Flock/Core/CoreEvents.h>
+#include <Flock/Core/Platform.h>
+#include <Flock/Core/StringUtils.h>
+#include <Flock/Engine/Engine.h>
+#include <Flock/IO/Log.h>
+#include <Flock/IO/MemoryBuffer.h>
+#include <Flock/Network/Connection.h>
+#include <Flock/Network/NetworkEvents.h>
+#include <Flock/Network/NetworkInterest.h>
+#include <Flock/Network/Protocol.h>
+#include <Flock/Scene/Scene.h>
+
+#include <kNet/kNet.h>
+
+#include "NetworkLoadTest.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace SDK = FlockSDK;
+
+static const char *LOOPBACK_ADDRESS = "127.0.0.1";
+
+/// Format a string with the C library. ToString() does not support field widths and precision.
+static SDK::String Format(const char* formatString, ...)
+{
+    char buffer[512];
+    va_list args;
+    va_start(args, formatString);
+    vsnprintf(buffer, sizeof buffer, formatString, args);
+    va_end(args);
+    return SDK::String(buffer);
+}
+
+/// Return the given percentile (0-1) of already sorted values.
+static float GetPercentile(const SDK::PODVector<float> &values, float percentile)
+{
+    if (values.Empty())
+        return 0.0f;
+
+    return values[SDK::Min((unsigned)(percentile * values.Size()), values.Size() - 1)];
+}
+
+/// Format sorted values as percentiles.
+static SDK::String FormatPercentiles(const SDK::PODVector<float> &values)
+{
+    return Format("p50 %.2f p95 %.2f p99 %.2f max %.2f", GetPercentile(values, 0.50f),
+        GetPercentile(values, 0.95f), GetPercentile(values, 0.99f), GetPercentile(values, 1.0f));
+}
+
+NetworkLoadTest::NetworkLoadTest(SDK::Context* context) :
+    SDK::Application(context),
+    numClients_(200),
+    numNodes_(500),
+    spawnRate_(10),
+    port_(2345),
+    duration_(60.0f),
+    controlRate_(30.0f),
+    updateFps_(30),
+    latency_(0),
+    packetLoss_(0.0f),
+    areaSize_(500.0f),
+    reportInterval_(1.0f),
+    useInterest_(false),
+    numSpawned_(0),
+    numLost_(0),
+    controlAcc_(0.0f),
+    reportAcc_(0.0f),
+    elapsed_(0.0f)
+{
+}
+
+NetworkLoadTest::~NetworkLoadTest() = default;
+
+void NetworkLoadTest::Setup()
+{
+    ParseSettings();
+
+    // Run without the frame limiter so that the measured update time is not hidden by sleeping
+    engine_->SetMaxFps(0);
+}
+
+void NetworkLoadTest::Start()
+{
+    auto *network = GetSubsystem<SDK::Network>();
+    network->SetUpdateFps(updateFps_);
+    // The server side connections pick up the simulator settings when they are established
+    network->SetSimulatedLatency(latency_);
+    network->SetSimulatedPacketLoss(packetLoss_);
+
+    if (!network->StartServer(port_))
+    {
+        ErrorExit("Failed to start server on port " + SDK::String(port_));
+        return;
+    }
+
+    CreateServerScene();
+    clientNetwork_ = new kNet::Network();
+
+    SubscribeToEvent(SDK::E_BEGINFRAME, FLOCKSDK_HANDLER(NetworkLoadTest, HandleBeginFrame));
+    SubscribeToEvent(SDK::E_UPDATE, FLOCKSDK_HANDLER(NetworkLoadTest, HandleUpdate));
+    SubscribeToEvent(SDK::E_CLIENTCONNECTED, FLOCKSDK_HANDLER(NetworkLoadTest, HandleClientConnected));
+    SubscribeToEvent(SDK::E_NETWORKUPDATE, FLOCKSDK_HANDLER(NetworkLoadTest, HandleNetworkUpdate));
+    SubscribeToEvent(SDK::E_NETWORKUPDATESENT, FLOCKSDK_HANDLER(NetworkLoadTest, HandleNetworkUpdateSent));
+
+    SDK::PrintLine(Format("Network load test: %u clients, %u nodes, %d updates/s, %.1f controls/s, latency %d ms, "
+        "loss %.2f, interest %s, %.0f seconds", numClients_, numNodes_, updateFps_, controlRate_, latency_, packetLoss_,
+        useInterest_ ? "on" : "off", duration_));
+}
+
+void NetworkLoadTest::Stop()
+{
+    if (allUpdateTimes_.Size())
+        Report(true);
+
+    for (auto i = 0u; i < clients_.Size(); ++i)
+        clients_[i]->Disconnect();
+
+    clientLookup_.Clear();
+    clients_.Clear();
+    clientScenes_.Clear();
+    clientNetwork_.Reset();
+
+    GetSubsystem<SDK::Network>()->StopServer();
+}
+
+void NetworkLoadTest::HandleMessage(kNet::MessageConnection *source, kNet::packet_id_t packetId, kNet::message_id_t msgId,
+    const char *data, size_t numBytes)
+{
+    auto i = clientLookup_.Find(source);
+    if (i == clientLookup_.End())
+        return;
+
+    // Messages not handled by the connection itself are of no interest to the simulated clients
+    SDK::MemoryBuffer msg(data, (unsigned)numBytes);
+    i->second_->ProcessMessage((int)msgId, msg);
+}
+
+u32 NetworkLoadTest::ComputeContentID(kNet::message_id_t msgId, const char *data, size_t numBytes)
+{
+    return GetSubsystem<SDK::Network>()->ComputeContentID(msgId, data, numBytes);
+}
+
+void NetworkLoadTest::ParseSettings()
+{
+    const auto &arguments = SDK::GetArguments();
+
+    for (auto i = 0u; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].Length() < 2 || arguments[i][0] != '-')
+            continue;
+
+        auto argument = arguments[i].Substring(1).ToLower();
+        auto value = i + 1 < arguments.Size() ? arguments[i + 1] : SDK::String::EMPTY;
+
+        if (argument == "interest")
+            useInterest_ = true;
+        else if (value.Empty())
+            continue;
+        else if (argument == "clients")
+            numClients_ = (unsigned)SDK::Max(SDK::ToInt(value), 1);
+        else if (argument == "nodes")
+            numNodes_ = (unsigned)SDK::Max(SDK::ToInt(value), 0);
+        else if (argument == "spawnrate")
+            spawnRate_ = (unsigned)SDK::Max(SDK::ToInt(value), 1);
+        else if (argument == "port")
+            port_ = (unsigned short)SDK::ToInt(value);
+        else if (argument == "duration")
+            duration_ = SDK::Max(SDK::ToFloat(value), 1.0f);
+        else if (argument == "controlrate")
+            controlRate_ = SDK::Max(SDK::ToFloat(value), 1.0f);
+        else if (argument == "updatefps")
+            updateFps_ = SDK::Max(SDK::ToInt(value), 1);
+        else if (argument == "latency")
+            latency_ = SDK::Max(SDK::ToInt(value), 0);
+        else if (argument == "loss")
+            packetLoss_ = SDK::Clamp(SDK::ToFloat(value), 0.0f, 1.0f);
+        else if (argument == "area")
+            areaSize_ = SDK::Max(SDK::ToFloat(value), 1.0f);
+        else if (argument == "report")
+            reportInterval_ = SDK::Max(SDK::ToFloat(value), 0.1f);
+    }
+}
+
+void NetworkLoadTest::CreateServerScene()
+{
+    serverScene_ = new SDK::Scene(context_);
+
+    if (useInterest_)
+        serverScene_->CreateComponent<SDK::NetworkInterest>();
+
+    nodes_.Reserve(numNodes_);
+    nodeVelocities_.Reserve(numNodes_);
+
+    for (auto i = 0u; i < numNodes_; ++i)
+    {
+        SDK::Node* node = serverScene_->CreateChild("Node" + SDK::String(i));
+        node->SetPosition(SDK::Vector3(SDK::Random(-areaSize_, areaSize_), 0.0f, SDK::Random(-areaSize_, areaSize_)));
+        node->SetVar("Index", (int)i);
+        nodes_.Push(node);
+        nodeVelocities_.Push(SDK::Vector3(SDK::Random(-10.0f, 10.0f), 0.0f, SDK::Random(-10.0f, 10.0f)));
+    }
+}
+
+void NetworkLoadTest::SpawnClients()
+{
+    for (auto i = 0u; i < spawnRate_ && numSpawned_ < numClients_; ++i, ++numSpawned_)
+    {
+        kNet::SharedPtr<kNet::MessageConnection> messageConnection = clientNetwork_->Connect(LOOPBACK_ADDRESS, port_,
+            kNet::SocketOverUDP, this);
+        if (!messageConnection)
+        {
+            FLOCKSDK_LOGERROR("Failed to connect simulated client " + SDK::String(numSpawned_));
+            ++numLost_;
+            continue;
+        }
+
+        SDK::VariantMap identity;
+        identity["ClientIndex"] = (int)numSpawned_;
+
+        SDK::SharedPtr<SDK::Scene> scene(new SDK::Scene(context_));
+        SDK::SharedPtr<SDK::Connection> connection(new SDK::Connection(context_, false, messageConnection));
+        connection->SetScene(scene);
+        connection->SetIdentity(identity);
+        connection->SetConnectPending(true);
+        connection->ConfigureNetworkSimulator(latency_, packetLoss_);
+        connection->SetPosition(SDK::Vector3(SDK::Random(-areaSize_, areaSize_), 0.0f, SDK::Random(-areaSize_, areaSize_)));
+
+        clientLookup_[messageConnection.ptr()] = connection;
+        clients_.Push(connection);
+        clientScenes_.Push(scene);
+    }
+}
+
+void NetworkLoadTest::ProcessClients()
+{
+    for (auto i = 0u; i < clients_.Size();)
+    {
+        SDK::Connection* connection = clients_[i];
+        kNet::MessageConnection* messageConnection = connection->GetMessageConnection();
+
+        messageConnection->Process();
+        connection->ProcessPendingLatestData();
+
+        // Mirror the state transitions of Network::Update() for each simulated client
+        kNet::ConnectionState state = messageConnection->GetConnectionState();
+        if (connection->IsConnectPending() && state == kNet::ConnectionOK)
+        {
+            connection->SetConnectPending(false);
+
+            SDK::VectorBuffer msg;
+            msg.WriteVariantMap(connection->GetIdentity());
+            connection->SendMessage(SDK::MSG_IDENTITY, true, true, msg);
+        }
+        else if (state == kNet::ConnectionPeerClosed)
+            connection->Disconnect();
+        else if (state == kNet::ConnectionClosed)
+        {
+            FLOCKSDK_LOGWARNING("Simulated client " + connection->ToString() + " disconnected");
+            clientLookup_.Erase(messageConnection);
+            clients_.Erase(i);
+            clientScenes_.Erase(i);
+            ++numLost_;
+            continue;
+        }
+
+        ++i;
+    }
+}
+
+void NetworkLoadTest::SendClientControls()
+{
+    for (auto i = 0u; i < clients_.Size(); ++i)
+    {
+        SDK::Connection* connection = clients_[i];
+
+        SDK::Controls controls;
+        controls.buttons_ = (unsigned)SDK::Random(16);
+        controls.yaw_ = SDK::Random(360.0f);
+        controls.pitch_ = SDK::Random(-90.0f, 90.0f);
+        connection->SetControls(controls);
+
+        // Wander around so that interest management sees the observers move
+        SDK::Vector3 position = connection->GetPosition() + SDK::Vector3(SDK::Random(-1.0f, 1.0f), 0.0f,
+            SDK::Random(-1.0f, 1.0f));
+        connection->SetPosition(SDK::VectorMax(SDK::VectorMin(position, SDK::Vector3::ONE * areaSize_),
+            SDK::Vector3::ONE * -areaSize_));
+
+        connection->SendClientUpdate();
+    }
+}
+
+void NetworkLoadTest::MoveNodes(float timeStep)
+{
+    for (auto i = 0u; i < nodes_.Size(); ++i)
+    {
+        SDK::Vector3 position = nodes_[i]->GetPosition() + nodeVelocities_[i] * timeStep;
+        SDK::Vector3 &velocity = nodeVelocities_[i];
+
+        // Bounce off the area edges
+        if (SDK::Abs(position.x_) > areaSize_)
+            velocity.x_ = -velocity.x_;
+        if (SDK::Abs(position.z_) > areaSize_)
+            velocity.z_ = -velocity.z_;
+
+        nodes_[i]->SetPosition(position);
+        nodes_[i]->Yaw(velocity.x_ * timeStep);
+    }
+}
+
+void NetworkLoadTest::Report(bool summary)
+{
+    if (summary)
+    {
+        SDK::Sort(allUpdateTimes_.Begin(), allUpdateTimes_.End());
+        SDK::Sort(bytesOutSamples_.Begin(), bytesOutSamples_.End());
+        SDK::Sort(allRoundTripTimes_.Begin(), allRoundTripTimes_.End());
+
+        SDK::PrintLine("Summary after " + SDK::String(elapsed_) + " seconds, " + SDK::String(clients_.Size()) + "/" +
+            SDK::String(numClients_) + " clients connected, " + SDK::String(numLost_) + " lost");
+        SDK::PrintLine("  server update ms:  " + FormatPercentiles(allUpdateTimes_));
+        SDK::PrintLine("  server out KB/s:   " + Format("p50 %.1f max %.1f", GetPercentile(bytesOutSamples_, 0.5f) /
+            1024.0f, GetPercentile(bytesOutSamples_, 1.0f) / 1024.0f));
+        SDK::PrintLine("  client RTT ms:     " + FormatPercentiles(allRoundTripTimes_));
+        return;
+    }
+
+    const auto serverConnections = GetSubsystem<SDK::Network>()->GetClientConnections();
+
+    float bytesOut = 0.0f;
+    for (auto i = 0u; i < serverConnections.Size(); ++i)
+        bytesOut += serverConnections[i]->GetBytesOutPerSec();
+    bytesOutSamples_.Push(bytesOut);
+
+    SDK::PODVector<float> roundTripTimes;
+    roundTripTimes.Reserve(clients_.Size());
+    for (auto i = 0u; i < clients_.Size(); ++i)
+    {
+        if (clients_[i]->IsSceneLoaded())
+            roundTripTimes.Push(clients_[i]->GetRoundTripTime());
+    }
+    allRoundTripTimes_.Push(roundTripTimes);
+
+    SDK::Sort(updateTimes_.Begin(), updateTimes_.End());
+    SDK::Sort(roundTripTimes.Begin(), roundTripTimes.End());
+
+    SDK::PrintLine(Format("[%6.1fs] clients %u/%u | update ms %s | out %.1f KB/s (%.2f KB/s per client) | RTT ms %s",
+        elapsed_, serverConnections.Size(), numClients_, FormatPercentiles(updateTimes_).CString(), bytesOut / 1024.0f,
+        serverConnections.Size() ? bytesOut / 1024.0f / serverConnections.Size() : 0.0f,
+        FormatPercentiles(roundTripTimes).CString()));
+
+    updateTimes_.Clear();
+}
+
+void NetworkLoadTest::HandleBeginFrame(SDK::StringHash eventType, SDK::VariantMap &eventData)
+{
+    SpawnClients();
+    ProcessClients();
+}
+
+void NetworkLoadTest::HandleUpdate(SDK::StringHash eventType, SDK::VariantMap &eventData)
+{
+    using namespace SDK::Update;
+
+    float timeStep = eventData[P_TIMESTEP].GetFloat();
+    elapsed_ += timeStep;
+
+    MoveNodes(timeStep);
+
+    controlAcc_ += timeStep;
+    if (controlAcc_ >= 1.0f / controlRate_)
+    {
+        controlAcc_ = fmodf(controlAcc_, 1.0f / controlRate_);
+        SendClientControls();
+    }
+
+    reportAcc_ += timeStep;
+    if (reportAcc_ >= reportInterval_)
+    {
+        reportAcc_ = fmodf(reportAcc_, reportInterval_);
+        Report(false);
+    }
+
+    if (elapsed_ >= duration_)
+        engine_->Exit();
+}
+
+void NetworkLoadTest::HandleClientConnected(SDK::StringHash eventType, SDK::VariantMap &eventData)
+{
+    using namespace SDK::ClientConnected;
+
+    auto *connection = static_cast<SDK::Connection*>(eventData[P_CONNECTION].GetPtr());
+    connection->SetScene(serverScene_);
+}
+
+void NetworkLoadTest::HandleNetworkUpdate(SDK::StringHash eventType, SDK::VariantMap &eventData)
+{
+    updateTimer_.Reset();
+}
+
+void NetworkLoadTest::HandleNetworkUpdateSent(SDK::StringHash eventType, SDK::VariantMap &eventData)
+{
+    // Only the server part of the network update is timed, as the simulated clients are processed outside the Network subsystem
+    float updateTime = updateTimer_.GetUSec(false) / 1000.0f;
+    updateTimes_.Push(updateTime);
+    allUpdateTimes_.Push(updateTime);
+}
+
+int main(int argc, char **argv)
+{
+    // Always run headless, regardless of the given arguments
+    SDK::PODVector<char*> arguments(argv, (unsigned)argc);
+    arguments.Push(const_cast<char*>("-headless"));
+    SDK::ParseArguments((int)arguments.Size(), arguments.Buffer());
+
+    auto *context = new SDK::Context();
+    return (SDK::SharedPtr<NetworkLoadTest>(new NetworkLoadTest(context)))->Run();
+}
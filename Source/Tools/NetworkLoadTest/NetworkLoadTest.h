@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2008-2017 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE. 
+// 
+
+#pragma once 
+
+#include <Flock/Container/HashMap.h>
+#include <Flock/Core/Timer.h>
+#include <Flock/Engine/Application.h>
+#include <Flock/Network/Network.h>
+
+#include <kNet/IMessageHandler.h>
+
+namespace FlockSDK
+{
+    class Node;
+    class Scene;
+}
+
+namespace kNet
+{
+    class Network;
+}
+
+/// Headless network load test: runs a server and a configurable number of simulated clients in one process over loopback.
+class NetworkLoadTest : public FlockSDK::Application, public kNet::IMessageHandler {
+    FLOCKSDK_OBJECT(NetworkLoadTest, FlockSDK::Application);
+
+    public:
+        NetworkLoadTest(FlockSDK::Context *context);
+        ~NetworkLoadTest();
+
+        virtual void Setup();
+        virtual void Start();
+        virtual void Stop();
+
+        /// Route a message received by a simulated client to its connection.
+        virtual void HandleMessage(kNet::MessageConnection *source, kNet::packet_id_t packetId, kNet::message_id_t msgId,
+            const char *data, size_t numBytes);
+        /// Compute message content ID's the same way as the network subsystem.
+        virtual u32 ComputeContentID(kNet::message_id_t msgId, const char *data, size_t numBytes);
+
+    private:
+        void ParseSettings();
+        void CreateServerScene();
+        void SpawnClients();
+        void ProcessClients();
+        void SendClientControls();
+        void MoveNodes(float timeStep);
+        void Report(bool summary);
+
+        void HandleBeginFrame(FlockSDK::StringHash eventType, FlockSDK::VariantMap &eventData);
+        void HandleUpdate(FlockSDK::StringHash eventType, FlockSDK::VariantMap &eventData);
+        void HandleClientConnected(FlockSDK::StringHash eventType, FlockSDK::VariantMap &eventData);
+        void HandleNetworkUpdate(FlockSDK::StringHash eventType, FlockSDK::VariantMap &eventData);
+        void HandleNetworkUpdateSent(FlockSDK::StringHash eventType, FlockSDK::VariantMap &eventData);
+
+        /// Number of simulated clients.
+        unsigned numClients_;
+        /// Number of moving replicated nodes in the server scene.
+        unsigned numNodes_;
+        /// Number of clients to connect per frame while spawning.
+        unsigned spawnRate_;
+        /// Server port.
+        unsigned short port_;
+        /// Test duration in seconds.
+        float duration_;
+        /// Client controls send rate per second.
+        float controlRate_;
+        /// Network update rate.
+        int updateFps_;
+        /// Simulated latency in milliseconds.
+        int latency_;
+        /// Simulated packet loss probability.
+        float packetLoss_;
+        /// Half extent of the area where nodes and clients move.
+        float areaSize_;
+        /// Report interval in seconds.
+        float reportInterval_;
+        /// Use a NetworkInterest component in the server scene.
+        bool useInterest_;
+
+        /// Server scene.
+        FlockSDK::SharedPtr<FlockSDK::Scene> serverScene_;
+        /// Moving nodes in the server scene.
+        FlockSDK::PODVector<FlockSDK::Node*> nodes_;
+        /// Velocities of the moving nodes.
+        FlockSDK::PODVector<FlockSDK::Vector3> nodeVelocities_;
+
+        /// kNet instance shared by the simulated clients.
+        FlockSDK::UniquePtr<kNet::Network> clientNetwork_;
+        /// Simulated client connections.
+        FlockSDK::Vector<FlockSDK::SharedPtr<FlockSDK::Connection> > clients_;
+        /// Scenes of the simulated clients.
+        FlockSDK::Vector<FlockSDK::SharedPtr<FlockSDK::Scene> > clientScenes_;
+        /// Simulated client connections by kNet connection.
+        FlockSDK::HashMap<kNet::MessageConnection*, FlockSDK::Connection*> clientLookup_;
+        /// Number of clients spawned so far.
+        unsigned numSpawned_;
+        /// Number of clients that failed to connect or were disconnected.
+        unsigned numLost_;
+
+        /// Server network update timer.
+        FlockSDK::HiresTimer updateTimer_;
+        /// Server network update times in milliseconds during the current report interval.
+        FlockSDK::PODVector<float> updateTimes_;
+        /// All server network update times in milliseconds.
+        FlockSDK::PODVector<float> allUpdateTimes_;
+        /// Server bytes out per second samples taken at each report.
+        FlockSDK::PODVector<float> bytesOutSamples_;
+        /// Client round trip time samples in milliseconds taken at each report.
+        FlockSDK::PODVector<float> allRoundTripTimes_;
+        /// Controls send accumulator.
+        float controlAcc_;
+        /// Report accumulator.
+        float reportAcc_;
+        /// Elapsed test time.
+        float elapsed_;
+};
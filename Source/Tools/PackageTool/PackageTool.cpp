@@ -22,7 +22,11 @@
 
 #include <Flock/Core/Context.h>
 #include <Flock/Container/ArrayPtr.h>
+#include <Flock/Container/Sort.h>
+#include <Flock/Core/Mutex.h>
 #include <Flock/Core/Platform.h>
+#include <Flock/Core/StringUtils.h>
+#include <Flock/Core/Thread.h>
 #include <Flock/IO/File.h>
 #include <Flock/IO/FileSystem.h>
 #include <Flock/IO/PackageFile.h>
@@ -39,6 +43,13 @@
 using namespace FlockSDK;
 
 static const unsigned COMPRESSED_BLOCK_SIZE = 32768;
+static const unsigned MIN_COMPRESSED_BLOCK_SIZE = 1024;
+/// Block sizes and packed sizes are both stored as 16-bit values.
+static const unsigned MAX_PACKED_BLOCK_SIZE = 65535;
+/// Amount of source data read into memory at once before compressing it in parallel.
+static const unsigned BATCH_DATA_SIZE = 64 * 1024 * 1024;
+static const unsigned DEFAULT_ALIGNMENT = 16;
+static const unsigned MAX_ALIGNMENT = 65536;
 
 struct FileEntry
 {
@@ -46,6 +57,27 @@ struct FileEntry
     unsigned offset_;
     unsigned size_;
     unsigned checksum_;
+    /// Index of an earlier entry with identical contents, or M_MAX_UNSIGNED if none.
+    unsigned duplicateOf_;
+    /// Store blocks without compressing them.
+    bool storeOnly_;
+};
+
+/// One block of a file to be compressed by the worker threads.
+struct BlockJob
+{
+    const unsigned char* src_;
+    unsigned char* dest_;
+    unsigned unpackedSize_;
+    unsigned packedSize_;
+    bool storeOnly_;
+};
+
+/// Worker thread compressing blocks of the current batch.
+class CompressWorker : public Thread, public RefCounted
+{
+public:
+    virtual void ThreadFunction();
 };
 
 SharedPtr<Context> context_(new Context());
@@ -55,7 +87,16 @@ Vector<FileEntry> entries_;
 unsigned checksum_ = 0;
 bool compress_ = false;
 bool quiet_ = false;
+bool deduplicate_ = false;
+int compressionLevel_ = 0;
+unsigned numThreads_ = 0;
 unsigned blockSize_ = COMPRESSED_BLOCK_SIZE;
+unsigned version_ = 2;
+unsigned alignment_ = DEFAULT_ALIGNMENT;
+Vector<String> storeExtensions_;
+PODVector<BlockJob> jobs_;
+unsigned nextJob_ = 0;
+Mutex jobMutex_;
 
 String ignoreExtensions_[] = {
     ".bak",
@@ -68,6 +109,14 @@ void Run(const Vector<String> &arguments);
 void ProcessFile(const String &fileName, const String &rootDir);
 void WritePackageFile(const String &fileName, const String &rootDir);
 void WriteHeader(File& dest);
+void WriteDirectory(File& dest);
+bool CompareDirectoryEntries(const PackageDirectoryEntry& lhs, const PackageDirectoryEntry& rhs);
+bool CompareEntryOffsets(const HashMap<String, PackageEntry>::KeyValue* lhs, const HashMap<String, PackageEntry>::KeyValue* rhs);
+unsigned GetPackedSize(File& package, const PackageEntry& entry, unsigned endOffset);
+void ReadFile(const String &fileName, SharedArrayPtr<unsigned char>& buffer, unsigned size);
+bool IsSameContents(const String &fileName, const unsigned char* data, unsigned size);
+void CompressBlocks();
+unsigned StoreBlock(const unsigned char* src, unsigned char* dest, unsigned size);
 
 int main(int argc, char** argv)
 {
@@ -90,8 +139,14 @@ void Run(const Vector<String> &arguments)
             "Usage: PackageTool <directory to process> <package name> [basepath] [options]\n"
             "\n"
             "Options:\n"
-            "-c      Enable package file LZ4 compression\n"
-            "-q      Enable quiet mode\n"
+            "-c[level]      Enable package file LZ4 compression, optionally with LZ4HC level 1-12\n"
+            "-b <bytes>     Set compressed block size, default 32768\n"
+            "-s <extension> Store files with the extension without compressing them, can be repeated\n"
+            "-d             Store files with identical contents only once\n"
+            "-t <count>     Set number of compression threads, default is number of CPU threads\n"
+            "-v <version>   Set package format version 1 or 2, default 2\n"
+            "-a <bytes>     Set file data alignment of version 2 packages, power of two, default 16\n"
+            "-q             Enable quiet mode\n"
             "\n"
             "Basepath is an optional prefix that will be added to the file entries.\n\n"
             "Alternative output usage: PackageTool <output option> <package name>\n"
@@ -114,10 +169,41 @@ void Run(const Vector<String> &arguments)
             {
                 if (arguments[i].Length() > 1)
                 {
-                    switch (arguments[i][1])
+                    char option = arguments[i][1];
+                    if ((option == 'b' || option == 's' || option == 't' || option == 'v' || option == 'a') &&
+                        i + 1 >= arguments.Size())
+                        ErrorExit("Missing value for option " + arguments[i]);
+
+                    switch (option)
                     {
                     case 'c':
                         compress_ = true;
+                        if (arguments[i].Length() > 2)
+                            compressionLevel_ = Clamp(ToInt(arguments[i].Substring(2)), 1, LZ4HC_CLEVEL_MAX);
+                        break;
+                    case 'b':
+                        blockSize_ = ToUInt(arguments[++i]);
+                        if (blockSize_ < MIN_COMPRESSED_BLOCK_SIZE || (unsigned)LZ4_compressBound(blockSize_) > MAX_PACKED_BLOCK_SIZE)
+                            ErrorExit("Invalid block size " + arguments[i]);
+                        break;
+                    case 's':
+                        storeExtensions_.Push(arguments[++i].ToLower());
+                        break;
+                    case 'd':
+                        deduplicate_ = true;
+                        break;
+                    case 't':
+                        numThreads_ = Max(ToUInt(arguments[++i]), 1U);
+                        break;
+                    case 'v':
+                        version_ = ToUInt(arguments[++i]);
+                        if (version_ < 1 || version_ > 2)
+                            ErrorExit("Unsupported package version " + arguments[i]);
+                        break;
+                    case 'a':
+                        alignment_ = ToUInt(arguments[++i]);
+                        if (!IsPowerOfTwo(alignment_) || alignment_ > MAX_ALIGNMENT)
+                            ErrorExit("Invalid alignment " + arguments[i]);
                         break;
                     case 'q':
                         quiet_ = true;
@@ -155,6 +241,9 @@ void Run(const Vector<String> &arguments)
             }
         }
 
+        // Directory scan order depends on the filesystem, so sort for reproducible output
+        Sort(fileNames.Begin(), fileNames.End());
+
         for (auto i = 0u; i < fileNames.Size(); ++i)
             ProcessFile(fileNames[i], dirName);
 
@@ -172,6 +261,7 @@ void Run(const Vector<String> &arguments)
             PrintLine("Package size: " + String(packageFile->GetTotalSize()));
             PrintLine("Checksum: " + String(packageFile->GetChecksum()));
             PrintLine("Compressed: " + String(packageFile->IsCompressed() ? "yes" : "no"));
+            PrintLine("Version: " + String(packageFile->GetVersion()));
             break;
         case 'L':
             if (!packageFile->IsCompressed())
@@ -181,18 +271,54 @@ void Run(const Vector<String> &arguments)
         case 'l':
             {
                 const HashMap<String, PackageEntry>& entries = packageFile->GetEntries();
-                for (HashMap<String, PackageEntry>::ConstIterator i = entries.Begin(); i != entries.End();)
+                if (!outputCompressionRatio)
                 {
-                    HashMap<String, PackageEntry>::ConstIterator current = i++;
-                    String fileEntry(current->first_);
-                    if (outputCompressionRatio)
+                    for (HashMap<String, PackageEntry>::ConstIterator i = entries.Begin(); i != entries.End(); ++i)
+                        PrintLine(i->first_);
+                    break;
+                }
+
+                // Entries are not listed in file order, so sort them by offset. Deduplicated entries share an offset
+                PODVector<const HashMap<String, PackageEntry>::KeyValue*> sortedEntries;
+                for (HashMap<String, PackageEntry>::ConstIterator i = entries.Begin(); i != entries.End(); ++i)
+                    sortedEntries.Push(&(*i));
+                Sort(sortedEntries.Begin(), sortedEntries.End(), CompareEntryOffsets);
+
+                File package(context_, packageName);
+                if (!package.IsOpen())
+                    ErrorExit("Could not open package file " + packageName);
+
+                unsigned dataEnd = packageFile->GetTotalSize() - sizeof(unsigned);
+                for (auto i = 0u; i < sortedEntries.Size(); ++i)
+                {
+                    const PackageEntry& entry = sortedEntries[i]->second_;
+                    String fileEntry(sortedEntries[i]->first_);
+                    if (i && entry.offset_ == sortedEntries[i - 1]->second_.offset_)
                     {
-                        unsigned compressedSize =
-                            (i == entries.End() ? packageFile->GetTotalSize() - sizeof(unsigned) : i->second_.offset_) -
-                            current->second_.offset_;
-                        fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", current->second_.size_, compressedSize,
-                            compressedSize ? 1.f * current->second_.size_ / compressedSize : 0.f);
+                        // Report the first entry of the group, which owns the data, as the original
+                        unsigned original = i - 1;
+                        while (original && sortedEntries[original - 1]->second_.offset_ == entry.offset_)
+                            --original;
+                        fileEntry.AppendWithFormat("\tin: %u\tduplicate of %s", entry.size_,
+                            sortedEntries[original]->first_.CString());
+                        PrintLine(fileEntry);
+                        continue;
                     }
+
+                    // Bound the block walk by the next entry's data, as v2 packages pad between entries
+                    unsigned endOffset = dataEnd;
+                    for (auto j = i + 1; j < sortedEntries.Size(); ++j)
+                    {
+                        if (sortedEntries[j]->second_.offset_ != entry.offset_)
+                        {
+                            endOffset = sortedEntries[j]->second_.offset_;
+                            break;
+                        }
+                    }
+
+                    unsigned compressedSize = GetPackedSize(package, entry, endOffset);
+                    fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", entry.size_, compressedSize,
+                        compressedSize ? 1.f * entry.size_ / compressedSize : 0.f);
                     PrintLine(fileEntry);
                 }
             }
@@ -217,6 +343,8 @@ void ProcessFile(const String &fileName, const String &rootDir)
     newEntry.offset_ = 0; // Offset not yet known
     newEntry.size_ = file.GetSize();
     newEntry.checksum_ = 0; // Will be calculated later
+    newEntry.duplicateOf_ = M_MAX_UNSIGNED;
+    newEntry.storeOnly_ = storeExtensions_.Contains(GetExtension(fileName));
     entries_.Push(newEntry);
 }
 
@@ -231,81 +359,152 @@ void WritePackageFile(const String &fileName, const String &rootDir)
 
     // Write ID, number of files & placeholder for checksum
     WriteHeader(dest);
+    // Write entries (correct offsets are still unknown, will be filled in later)
+    WriteDirectory(dest);
 
-    for (auto i = 0u; i < entries_.Size(); ++i)
-    {
-        // Write entry (correct offset is still unknown, will be filled in later)
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
-    }
-
+    unsigned numThreads = numThreads_ ? numThreads_ : Max(GetNumCPUThreads(), 1U);
     unsigned totalDataSize = 0;
-    unsigned lastOffset;
+    // Maps size and checksum of each unique file to its entry index
+    HashMap<unsigned long long, unsigned> contentEntries;
 
-    // Write file data, calculate checksums & correct offsets
-    for (auto i = 0u; i < entries_.Size(); ++i)
+    // Files are read and checksummed in order, a batch at a time. The blocks of a batch are then compressed in
+    // parallel and written in order, so the output does not depend on the number of threads
+    for (unsigned batchStart = 0; batchStart < entries_.Size();)
     {
-        lastOffset = entries_[i].offset_ = dest.GetSize();
-        String fileFullPath = rootDir + "/" + entries_[i].name_;
+        Vector<SharedArrayPtr<unsigned char> > buffers;
+        unsigned batchEnd = batchStart;
+        unsigned batchDataSize = 0;
+
+        while (batchEnd < entries_.Size() && (batchEnd == batchStart || batchDataSize + entries_[batchEnd].size_ <= BATCH_DATA_SIZE))
+        {
+            FileEntry& entry = entries_[batchEnd++];
+            String fileFullPath = rootDir + "/" + entry.name_;
 
-        File srcFile(context_, fileFullPath);
-        if (!srcFile.IsOpen())
-            ErrorExit("Could not open file " + fileFullPath);
+            SharedArrayPtr<unsigned char> buffer;
+            ReadFile(fileFullPath, buffer, entry.size_);
+            totalDataSize += entry.size_;
 
-        unsigned dataSize = entries_[i].size_;
-        totalDataSize += dataSize;
-        SharedArrayPtr<unsigned char> buffer(new unsigned char[dataSize]);
+            for (auto j = 0u; j < entry.size_; ++j)
+            {
+                checksum_ = SDBMHash(checksum_, buffer[j]);
+                entry.checksum_ = SDBMHash(entry.checksum_, buffer[j]);
+            }
 
-        if (srcFile.Read(&buffer[0], dataSize) != dataSize)
-            ErrorExit("Could not read file " + fileFullPath);
-        srcFile.Close();
+            if (deduplicate_)
+            {
+                unsigned long long contentKey = ((unsigned long long)entry.size_ << 32) | entry.checksum_;
+                HashMap<unsigned long long, unsigned>::ConstIterator k = contentEntries.Find(contentKey);
+                if (k == contentEntries.End())
+                    contentEntries[contentKey] = batchEnd - 1;
+                else if (IsSameContents(rootDir + "/" + entries_[k->second_].name_, buffer.Get(), entry.size_))
+                {
+                    entry.duplicateOf_ = k->second_;
+                    buffer.Reset();
+                }
+            }
 
-        for (auto j = 0u; j < dataSize; ++j)
-        {
-            checksum_ = SDBMHash(checksum_, buffer[j]);
-            entries_[i].checksum_ = SDBMHash(entries_[i].checksum_, buffer[j]);
+            if (buffer)
+                batchDataSize += entry.size_;
+            buffers.Push(buffer);
         }
 
-        if (!compress_)
-        {
-            if (!quiet_)
-                PrintLine(entries_[i].name_ + " size " + String(dataSize));
-            dest.Write(&buffer[0], entries_[i].size_);
-        }
-        else
+        // Split the batch into blocks, with output space for the worst case compressed size of each
+        Vector<SharedArrayPtr<unsigned char> > packedBuffers(buffers.Size());
+        jobs_.Clear();
+        nextJob_ = 0;
+
+        if (compress_)
         {
-            SharedArrayPtr<unsigned char> compressBuffer(new unsigned char[LZ4_compressBound(blockSize_)]);
+            for (unsigned i = batchStart; i < batchEnd; ++i)
+            {
+                const FileEntry& entry = entries_[i];
+                const unsigned char* src = buffers[i - batchStart].Get();
+                if (!src)
+                    continue;
 
-            unsigned pos = 0;
+                unsigned numBlocks = (entry.size_ + blockSize_ - 1) / blockSize_;
+                unsigned char* dest = new unsigned char[numBlocks * LZ4_compressBound(blockSize_)];
+                packedBuffers[i - batchStart] = dest;
+
+                for (unsigned pos = 0; pos < entry.size_; pos += blockSize_)
+                {
+                    BlockJob job;
+                    job.src_ = src + pos;
+                    job.dest_ = dest;
+                    job.unpackedSize_ = Min(blockSize_, entry.size_ - pos);
+                    job.packedSize_ = 0;
+                    job.storeOnly_ = entry.storeOnly_;
+                    jobs_.Push(job);
+                    dest += LZ4_compressBound(blockSize_);
+                }
+            }
 
-            while (pos < dataSize)
+            Vector<SharedPtr<CompressWorker> > workers;
+            for (unsigned i = 1; i < Min(numThreads, jobs_.Size()); ++i)
             {
-                unsigned unpackedSize = blockSize_;
-                if (pos + unpackedSize > dataSize)
-                    unpackedSize = dataSize - pos;
+                SharedPtr<CompressWorker> worker(new CompressWorker());
+                worker->Run();
+                workers.Push(worker);
+            }
+
+            CompressBlocks();
 
-                unsigned packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)compressBuffer.Get(), unpackedSize, LZ4_compressBound(unpackedSize), 0);
-                if (!packedSize)
-                    ErrorExit("LZ4 compression failed for file " + entries_[i].name_ + " at offset " + String(pos));
+            for (unsigned i = 0; i < workers.Size(); ++i)
+                workers[i]->Stop();
+        }
 
-                dest.WriteUShort((unsigned short)unpackedSize);
-                dest.WriteUShort((unsigned short)packedSize);
-                dest.Write(compressBuffer.Get(), packedSize);
+        // Write file data & correct offsets
+        unsigned jobIndex = 0;
+        for (unsigned i = batchStart; i < batchEnd; ++i)
+        {
+            FileEntry& entry = entries_[i];
+            const unsigned char* src = buffers[i - batchStart].Get();
 
-                pos += unpackedSize;
+            if (!src)
+            {
+                entry.offset_ = entries_[entry.duplicateOf_].offset_;
+                if (!quiet_)
+                    PrintLine(entry.name_ + " duplicate of " + entries_[entry.duplicateOf_].name_);
+                continue;
             }
 
-            if (!quiet_)
+            // Pad file data of version 2 packages so that it can be used in place from a memory mapping
+            if (version_ >= 2 && dest.GetSize() % alignment_)
             {
-                unsigned totalPackedBytes = dest.GetSize() - lastOffset;
-                String fileEntry(entries_[i].name_);
-                fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", dataSize, totalPackedBytes,
-                    totalPackedBytes ? 1.f * dataSize / totalPackedBytes : 0.f);
-                PrintLine(fileEntry);
+                static const unsigned char padding[MAX_ALIGNMENT] = {};
+                dest.Write(padding, alignment_ - dest.GetSize() % alignment_);
+            }
+
+            unsigned lastOffset = entry.offset_ = dest.GetSize();
+
+            if (!compress_)
+            {
+                if (!quiet_)
+                    PrintLine(entry.name_ + " size " + String(entry.size_));
+                dest.Write(src, entry.size_);
+            }
+            else
+            {
+                for (unsigned pos = 0; pos < entry.size_; pos += blockSize_)
+                {
+                    const BlockJob& job = jobs_[jobIndex++];
+                    dest.WriteUShort((unsigned short)job.unpackedSize_);
+                    dest.WriteUShort((unsigned short)job.packedSize_);
+                    dest.Write(job.dest_, job.packedSize_);
+                }
+
+                if (!quiet_)
+                {
+                    unsigned totalPackedBytes = dest.GetSize() - lastOffset;
+                    String fileEntry(entry.name_);
+                    fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", entry.size_, totalPackedBytes,
+                        totalPackedBytes ? 1.f * entry.size_ / totalPackedBytes : 0.f);
+                    PrintLine(fileEntry);
+                }
             }
         }
+
+        batchStart = batchEnd;
     }
 
     // Write package size to the end of file to allow finding it linked to an executable file
@@ -315,14 +514,7 @@ void WritePackageFile(const String &fileName, const String &rootDir)
     // Write header again with correct offsets & checksums
     dest.Seek(0);
     WriteHeader(dest);
-
-    for (auto i = 0u; i < entries_.Size(); ++i)
-    {
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
-    }
+    WriteDirectory(dest);
 
     if (!quiet_)
     {
@@ -336,10 +528,147 @@ void WritePackageFile(const String &fileName, const String &rootDir)
 
 void WriteHeader(File& dest)
 {
-    if (!compress_)
+    if (version_ >= 2)
+        dest.WriteFileID(compress_ ? "ULZ2" : "UPK2");
+    else if (!compress_)
         dest.WriteFileID("UPAK");
     else
         dest.WriteFileID("ULZ4");
     dest.WriteUInt(entries_.Size());
     dest.WriteUInt(checksum_);
 }
+
+void WriteDirectory(File& dest)
+{
+    if (version_ < 2)
+    {
+        for (auto i = 0u; i < entries_.Size(); ++i)
+        {
+            dest.WriteString(basePath_ + entries_[i].name_);
+            dest.WriteUInt(entries_[i].offset_);
+            dest.WriteUInt(entries_[i].size_);
+            dest.WriteUInt(entries_[i].checksum_);
+        }
+        return;
+    }
+
+    // Version 2 stores a name table followed by directory records sorted by name hash
+    PODVector<PackageDirectoryEntry> directory(entries_.Size());
+    PODVector<char> names;
+    for (auto i = 0u; i < entries_.Size(); ++i)
+    {
+        String entryName = basePath_ + entries_[i].name_;
+        PackageDirectoryEntry& dirEntry = directory[i];
+        dirEntry.nameHash_ = StringHash(entryName).Value();
+        dirEntry.nameOffset_ = names.Size();
+        dirEntry.entry_.offset_ = entries_[i].offset_;
+        dirEntry.entry_.size_ = entries_[i].size_;
+        dirEntry.entry_.checksum_ = entries_[i].checksum_;
+        names.Insert(names.End(), entryName.CString(), entryName.CString() + entryName.Length() + 1);
+    }
+
+    Sort(directory.Begin(), directory.End(), CompareDirectoryEntries);
+
+    dest.WriteUInt(names.Size());
+    if (directory.Size())
+        dest.Write(&directory[0], directory.Size() * sizeof(PackageDirectoryEntry));
+    if (names.Size())
+        dest.Write(&names[0], names.Size());
+}
+
+bool CompareDirectoryEntries(const PackageDirectoryEntry& lhs, const PackageDirectoryEntry& rhs)
+{
+    // Names are unique, so break hash ties by name offset for a deterministic order
+    if (lhs.nameHash_ != rhs.nameHash_)
+        return lhs.nameHash_ < rhs.nameHash_;
+    return lhs.nameOffset_ < rhs.nameOffset_;
+}
+
+bool CompareEntryOffsets(const HashMap<String, PackageEntry>::KeyValue* lhs, const HashMap<String, PackageEntry>::KeyValue* rhs)
+{
+    // Break offset ties by name, so that the same entry of a duplicate group is always reported as the original
+    if (lhs->second_.offset_ != rhs->second_.offset_)
+        return lhs->second_.offset_ < rhs->second_.offset_;
+    return lhs->first_ < rhs->first_;
+}
+
+unsigned GetPackedSize(File& package, const PackageEntry& entry, unsigned endOffset)
+{
+    // Sum the block headers and packed data of the entry, which leaves out any alignment padding after it
+    unsigned pos = entry.offset_;
+    unsigned unpackedSize = 0;
+    package.Seek(pos);
+    while (unpackedSize < entry.size_ && pos + 2 * sizeof(unsigned short) <= endOffset)
+    {
+        unpackedSize += package.ReadUShort();
+        pos += 2 * sizeof(unsigned short) + package.ReadUShort();
+        package.Seek(pos);
+    }
+
+    return Min(pos, endOffset) - entry.offset_;
+}
+
+void ReadFile(const String &fileName, SharedArrayPtr<unsigned char>& buffer, unsigned size)
+{
+    File srcFile(context_, fileName);
+    if (!srcFile.IsOpen())
+        ErrorExit("Could not open file " + fileName);
+
+    buffer = new unsigned char[size];
+    if (srcFile.Read(&buffer[0], size) != size)
+        ErrorExit("Could not read file " + fileName);
+}
+
+bool IsSameContents(const String &fileName, const unsigned char* data, unsigned size)
+{
+    SharedArrayPtr<unsigned char> buffer;
+    ReadFile(fileName, buffer, size);
+    return !memcmp(buffer.Get(), data, size);
+}
+
+void CompressBlocks()
+{
+    for (;;)
+    {
+        jobMutex_.Acquire();
+        unsigned index = nextJob_++;
+        jobMutex_.Release();
+        if (index >= jobs_.Size())
+            break;
+
+        BlockJob& job = jobs_[index];
+        if (job.storeOnly_)
+            job.packedSize_ = StoreBlock(job.src_, job.dest_, job.unpackedSize_);
+        else
+        {
+            job.packedSize_ = (unsigned)LZ4_compress_HC((const char*)job.src_, (char*)job.dest_, job.unpackedSize_,
+                LZ4_compressBound(job.unpackedSize_), compressionLevel_);
+            if (!job.packedSize_)
+                ErrorExit("LZ4 compression failed");
+        }
+    }
+}
+
+unsigned StoreBlock(const unsigned char* src, unsigned char* dest, unsigned size)
+{
+    // Encode the block as a single LZ4 sequence of literals, so it still decompresses with the regular decoder
+    unsigned char* start = dest;
+    if (size < 15)
+        *dest++ = (unsigned char)(size << 4);
+    else
+    {
+        *dest++ = 15 << 4;
+        unsigned length = size - 15;
+        for (; length >= 255; length -= 255)
+            *dest++ = 255;
+        *dest++ = (unsigned char)length;
+    }
+
+    memcpy(dest, src, size);
+    return (unsigned)(dest - start) + size;
+}
+
+void CompressWorker::ThreadFunction()
+{
+    CompressBlocks();
+}
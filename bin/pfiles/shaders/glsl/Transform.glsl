@@ -24,6 +24,32 @@ attribute vec4 iCubeTexCoord1;
 attribute float iObjectIndex;
 
 #ifdef SKINNED
+#ifdef SKINPALETTE
+uniform sampler2D sSkinPalette;
+
+// Fetch one row of a skinning matrix from the palette texture, where each matrix takes 3 consecutive texels
+vec4 GetSkinPaletteRow(int index)
+{
+    int width = textureSize(sSkinPalette, 0).x;
+    return texelFetch(sSkinPalette, ivec2(index % width, index / width), 0);
+}
+
+mat4 GetSkinMatrix(vec4 blendWeights, vec4 blendIndices)
+{
+    // The palette offset is in the first element of the instance transform or the per-object uniform
+    #ifdef INSTANCED
+        int offset = int(iTexCoord4.x);
+    #else
+        int offset = int(cSkinPaletteOffset);
+    #endif
+    ivec4 idx = (ivec4(blendIndices) + offset) * 3;
+    const vec4 lastColumn = vec4(0.0, 0.0, 0.0, 1.0);
+    return mat4(GetSkinPaletteRow(idx.x), GetSkinPaletteRow(idx.x + 1), GetSkinPaletteRow(idx.x + 2), lastColumn) * blendWeights.x +
+        mat4(GetSkinPaletteRow(idx.y), GetSkinPaletteRow(idx.y + 1), GetSkinPaletteRow(idx.y + 2), lastColumn) * blendWeights.y +
+        mat4(GetSkinPaletteRow(idx.z), GetSkinPaletteRow(idx.z + 1), GetSkinPaletteRow(idx.z + 2), lastColumn) * blendWeights.z +
+        mat4(GetSkinPaletteRow(idx.w), GetSkinPaletteRow(idx.w + 1), GetSkinPaletteRow(idx.w + 2), lastColumn) * blendWeights.w;
+}
+#else
 mat4 GetSkinMatrix(vec4 blendWeights, vec4 blendIndices)
 {
     ivec4 idx = ivec4(blendIndices) * 3;
@@ -34,6 +60,7 @@ mat4 GetSkinMatrix(vec4 blendWeights, vec4 blendIndices)
         mat4(cSkinMatrices[idx.w], cSkinMatrices[idx.w + 1], cSkinMatrices[idx.w + 2], lastColumn) * blendWeights.w;
 }
 #endif
+#endif
 
 #ifdef INSTANCED
 mat4 GetInstanceMatrix()
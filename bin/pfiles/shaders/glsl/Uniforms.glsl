@@ -31,7 +31,11 @@ uniform vec4 cVOffset;
 uniform mat4 cZone;
 uniform mat4 cLightMatrices[4]; 
 #ifdef SKINNED
-    uniform vec4 cSkinMatrices[MAXBONES*3];
+    #ifdef SKINPALETTE
+        uniform float cSkinPaletteOffset;
+    #else
+        uniform vec4 cSkinMatrices[MAXBONES*3];
+    #endif
 #endif
 #ifdef NUMVERTEXLIGHTS
     uniform vec4 cVertexLights[4*3];
@@ -136,7 +140,11 @@ uniform ObjectVS
     mat3 cBillboardRot;
 #endif
 #ifdef SKINNED
-    uniform vec4 cSkinMatrices[MAXBONES*3];
+    #ifdef SKINPALETTE
+        float cSkinPaletteOffset;
+    #else
+        uniform vec4 cSkinMatrices[MAXBONES*3];
+    #endif
 #endif
 };
 